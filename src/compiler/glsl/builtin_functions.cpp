@@ -39,7 +39,8 @@
  *
  *    The builtin_builder::create_builtins() function contains lists of all
  *    built-in function signatures, where they're available, what types they
- *    take, and so on.
+ *    take, and so on.  Only the signatures of functions a shader actually
+ *    looks up get built, see builtin_builder::ensure_function().
  *
  * 4. Implementations of built-in function signatures
  *
@@ -87,6 +88,7 @@
 #include <math.h>
 #include "builtin_functions.h"
 #include "util/hash_table.h"
+#include "util/set.h"
 
 #ifndef M_PIf
 #define M_PIf   ((float) M_PI)
@@ -1015,23 +1017,42 @@ public:
    void release();
    ir_function_signature *find(_mesa_glsl_parse_state *state,
                                const char *name, exec_list *actual_parameters);
+   void ensure_function(const char *name);
 
    /**
     * A shader to hold all the built-in signatures; created by this module.
     *
-    * This includes signatures for every built-in, regardless of version or
-    * enabled extensions.  The availability predicate associated with each
-    * signature allows matching_signature() to filter out the irrelevant ones.
+    * Once a built-in has been looked up, this includes all of its
+    * signatures, regardless of version or enabled extensions.  The
+    * availability predicate associated with each signature allows
+    * matching_signature() to filter out the irrelevant ones.
     */
    gl_shader *shader;
 
 private:
    void *mem_ctx;
 
+   /**
+    * Names create_builtins() has already been run for, whether or not a
+    * built-in with that name exists.
+    */
+   struct set *created_names;
+
+   /**
+    * The function create_builtins() is currently building, or NULL to build
+    * everything (as is done for the intrinsics).
+    */
+   const char *requested_name;
+
    void create_shader();
    void create_intrinsics();
    void create_builtins();
 
+   bool is_requested(const char *name) const
+   {
+      return requested_name == NULL || strcmp(name, requested_name) == 0;
+   }
+
    /**
     * IR builder helpers:
     *
@@ -1418,7 +1439,7 @@ enum image_function_flags {
  *  @{
  */
 builtin_builder::builtin_builder()
-   : shader(NULL)
+   : shader(NULL), created_names(NULL), requested_name(NULL)
 {
    mem_ctx = NULL;
 }
@@ -1449,6 +1470,8 @@ builtin_builder::find(_mesa_glsl_parse_state *state,
     */
    state->uses_builtin_functions = true;
 
+   ensure_function(name);
+
    ir_function *f = shader->symbols->get_function(name);
    if (f == NULL)
       return NULL;
@@ -1471,9 +1494,35 @@ builtin_builder::initialize()
    glsl_type_singleton_init_or_ref();
 
    mem_ctx = ralloc_context(NULL);
+   created_names = _mesa_set_create(mem_ctx, _mesa_hash_string,
+                                    _mesa_key_string_equal);
    create_shader();
+
+   /* Built-ins call into the intrinsics by name, so create all of those
+    * up front.  They're only prototypes, which is cheap.
+    */
    create_intrinsics();
+}
+
+/**
+ * Build all signatures of the built-in function \p name, if they haven't
+ * been built yet.
+ *
+ * Constructing the IR of every built-in up front is expensive, and most
+ * shaders only use a handful of them, so this is done lazily the first time
+ * a function is looked up by name.
+ */
+void
+builtin_builder::ensure_function(const char *name)
+{
+   if (_mesa_set_search(created_names, name))
+      return;
+
+   _mesa_set_add(created_names, ralloc_strdup(mem_ctx, name));
+
+   requested_name = name;
    create_builtins();
+   requested_name = NULL;
 }
 
 void
@@ -1481,6 +1530,7 @@ builtin_builder::release()
 {
    ralloc_free(mem_ctx);
    mem_ctx = NULL;
+   created_names = NULL;
 
    ralloc_free(shader);
    shader = NULL;
@@ -1759,6 +1809,16 @@ builtin_builder::create_intrinsics()
 void
 builtin_builder::create_builtins()
 {
+/* Only build the function ensure_function() asked for.  This has to be a
+ * macro rather than a check in add_function() since evaluating the
+ * signature arguments is where all of the work is done.
+ */
+#define add_function(NAME, ...)                 \
+   do {                                         \
+      if (is_requested(NAME))                   \
+         add_function(NAME, __VA_ARGS__);       \
+   } while (0)
+
 #define F(NAME)                                 \
    add_function(#NAME,                          \
                 _##NAME(&glsl_type_builtin_float), \
@@ -5768,6 +5828,7 @@ builtin_builder::create_builtins()
 #undef FIUDHF_VEC
 #undef FIUBDHF_VEC
 #undef FIU2_MIXED
+#undef add_function
 }
 
 void
@@ -5804,6 +5865,9 @@ builtin_builder::add_image_function(const char *name,
                                     unsigned flags,
                                     enum ir_intrinsic_id intrinsic_id)
 {
+   if (!is_requested(name))
+      return;
+
    static const glsl_type *const types[] = {
       &glsl_type_builtin_image1D,
       &glsl_type_builtin_image2D,
@@ -8995,6 +9059,7 @@ _mesa_glsl_has_builtin_function(_mesa_glsl_parse_state *state, const char *name)
    ir_function *f;
    bool ret = false;
    simple_mtx_lock(&builtins_lock);
+   builtins.ensure_function(name);
    f = builtins.shader->symbols->get_function(name);
    if (f != NULL) {
       foreach_in_list(ir_function_signature, sig, &f->signatures) {
@@ -9009,10 +9074,16 @@ _mesa_glsl_has_builtin_function(_mesa_glsl_parse_state *state, const char *name)
    return ret;
 }
 
-gl_shader *
-_mesa_glsl_get_builtin_function_shader()
+ir_function *
+_mesa_glsl_get_builtin_function(const char *name)
 {
-   return builtins.shader;
+   ir_function *f;
+   simple_mtx_lock(&builtins_lock);
+   builtins.ensure_function(name);
+   f = builtins.shader->symbols->get_function(name);
+   simple_mtx_unlock(&builtins_lock);
+
+   return f;
 }
 
 
@@ -33,7 +33,9 @@
 #include "util/u_atomic.h" /* for p_atomic_cmpxchg */
 #include "util/ralloc.h"
 #include "util/disk_cache.h"
+#include "util/hash_table.h"
 #include "util/mesa-sha1.h"
+#include "util/simple_mtx.h"
 #include "ast.h"
 #include "glsl_parser_extras.h"
 #include "glsl_parser.h"
@@ -2179,6 +2181,113 @@ add_builtin_defines(struct _mesa_glsl_parse_state *state,
    }
 }
 
+/**
+ * In-memory cache of preprocessor results.
+ *
+ * Applications commonly build many shaders from the same set of sources
+ * (e.g. identical shared headers concatenated with per-material defines),
+ * and drivers recompile the same sources on every run of a cold shader
+ * cache.  The preprocessor output only depends on the source, the stage and
+ * constant context state, so identical sources are only preprocessed once
+ * per process.
+ *
+ * Sources using ARB_shading_language_include are not cached, since their
+ * output also depends on the include tree, which may change at any time.
+ */
+struct glcpp_cache_entry {
+   uint8_t key[SHA1_DIGEST_LENGTH];
+   const char *output;
+   const char *info_log;
+   int error;
+};
+
+/* Once the cached strings exceed this size, the cache is flushed. */
+#define GLCPP_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
+static simple_mtx_t glcpp_cache_lock = SIMPLE_MTX_INITIALIZER;
+static struct hash_table *glcpp_cache;
+static size_t glcpp_cache_size;
+
+static uint32_t
+glcpp_cache_key_hash(const void *key)
+{
+   /* The key is already a SHA-1. */
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+glcpp_cache_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, SHA1_DIGEST_LENGTH) == 0;
+}
+
+static int
+preprocess_with_cache(struct gl_context *ctx,
+                      struct _mesa_glsl_parse_state *state,
+                      const char **source)
+{
+   uint8_t key[SHA1_DIGEST_LENGTH];
+   struct mesa_sha1 sha1_ctx;
+
+   _mesa_sha1_init(&sha1_ctx);
+   _mesa_sha1_update(&sha1_ctx, &ctx->API, sizeof(ctx->API));
+   _mesa_sha1_update(&sha1_ctx, &ctx->Extensions, sizeof(ctx->Extensions));
+   _mesa_sha1_update(&sha1_ctx, &ctx->Const, sizeof(ctx->Const));
+   _mesa_sha1_update(&sha1_ctx, &state->stage, sizeof(state->stage));
+   _mesa_sha1_update(&sha1_ctx, *source, strlen(*source));
+   _mesa_sha1_final(&sha1_ctx, key);
+
+   simple_mtx_lock(&glcpp_cache_lock);
+   struct hash_entry *he =
+      glcpp_cache ? _mesa_hash_table_search(glcpp_cache, key) : NULL;
+   if (he) {
+      const struct glcpp_cache_entry *entry =
+         (const struct glcpp_cache_entry *) he->data;
+
+      *source = ralloc_strdup(state, entry->output);
+      ralloc_strcat(&state->info_log, entry->info_log);
+      int error = entry->error;
+      simple_mtx_unlock(&glcpp_cache_lock);
+      return error;
+   }
+   simple_mtx_unlock(&glcpp_cache_lock);
+
+   size_t log_start = strlen(state->info_log);
+   int error = glcpp_preprocess(state, source, &state->info_log,
+                                add_builtin_defines, state, ctx);
+
+   simple_mtx_lock(&glcpp_cache_lock);
+   size_t size = strlen(*source) + strlen(state->info_log + log_start);
+   if (glcpp_cache && glcpp_cache_size + size > GLCPP_CACHE_MAX_SIZE) {
+      ralloc_free(glcpp_cache);
+      glcpp_cache = NULL;
+      glcpp_cache_size = 0;
+   }
+
+   if (glcpp_cache == NULL) {
+      glcpp_cache = _mesa_hash_table_create(NULL, glcpp_cache_key_hash,
+                                            glcpp_cache_key_equal);
+   }
+
+   /* Another thread may have preprocessed the same source meanwhile. */
+   if (!_mesa_hash_table_search(glcpp_cache, key)) {
+      struct glcpp_cache_entry *entry =
+         ralloc(glcpp_cache, struct glcpp_cache_entry);
+      memcpy(entry->key, key, sizeof(key));
+      entry->output = ralloc_strdup(entry, *source);
+      entry->info_log = ralloc_strdup(entry, state->info_log + log_start);
+      entry->error = error;
+
+      _mesa_hash_table_insert(glcpp_cache, entry->key, entry);
+      glcpp_cache_size += size;
+   }
+   simple_mtx_unlock(&glcpp_cache_lock);
+
+   return error;
+}
+
 /* Implements parsing checks that we can't do during parsing */
 static void
 do_late_parsing_checks(struct _mesa_glsl_parse_state *state)
@@ -2264,7 +2373,8 @@ static bool
 can_skip_compile(struct gl_context *ctx, struct gl_shader *shader,
                  const char *source,
                  const uint8_t source_sha1[SHA1_DIGEST_LENGTH],
-                 bool force_recompile, bool source_has_shader_include)
+                 bool force_recompile, bool source_has_shader_include,
+                 GLbitfield flags)
 {
    if (!force_recompile) {
       if (ctx->Cache) {
@@ -2273,7 +2383,7 @@ can_skip_compile(struct gl_context *ctx, struct gl_shader *shader,
                                 shader->disk_cache_sha1);
          if (disk_cache_has_key(ctx->Cache, shader->disk_cache_sha1)) {
             /* We've seen this shader before and know it compiles */
-            if (ctx->_Shader->Flags & GLSL_CACHE_INFO) {
+            if (flags & GLSL_CACHE_INFO) {
                _mesa_sha1_format(buf, shader->disk_cache_sha1);
                fprintf(stderr, "deferring compile of shader: %s\n", buf);
             }
@@ -2309,20 +2419,29 @@ can_skip_compile(struct gl_context *ctx, struct gl_shader *shader,
    return false;
 }
 
-void
-_mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
-                          bool dump_ast, bool dump_hir, bool force_recompile)
+/**
+ * Return the source a compile of \p shader starts from.
+ */
+static const char *
+compile_source(struct gl_shader *shader, bool force_recompile,
+               const uint8_t **source_sha1)
 {
-   const char *source;
-   const uint8_t *source_sha1;
-
    if (force_recompile && shader->FallbackSource) {
-      source = shader->FallbackSource;
-      source_sha1 = shader->fallback_source_sha1;
+      *source_sha1 = shader->fallback_source_sha1;
+      return shader->FallbackSource;
    } else {
-      source = shader->Source;
-      source_sha1 = shader->source_sha1;
+      *source_sha1 = shader->source_sha1;
+      return shader->Source;
    }
+}
+
+struct _mesa_glsl_parse_state *
+_mesa_glsl_preprocess_shader(struct gl_context *ctx, struct gl_shader *shader,
+                             bool force_recompile, GLbitfield flags,
+                             const char **preprocessed)
+{
+   const uint8_t *source_sha1;
+   const char *source = compile_source(shader, force_recompile, &source_sha1);
 
    /* Note this will be true for shaders the have #include inside comments
     * however that should be rare enough not to worry about.
@@ -2337,8 +2456,8 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
     */
    if (!source_has_shader_include &&
        can_skip_compile(ctx, shader, source, source_sha1, force_recompile,
-                        false))
-      return;
+                        false, flags))
+      return NULL;
 
     struct _mesa_glsl_parse_state *state =
       new(shader) _mesa_glsl_parse_state(ctx, shader->Stage, shader);
@@ -2347,7 +2466,9 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       (void) p_atomic_cmpxchg(&ir_variable::temporaries_allocate_names,
                               false, true);
 
-   if (!source_has_shader_include || !force_recompile) {
+   if (!source_has_shader_include) {
+      state->error = preprocess_with_cache(ctx, state, &source);
+   } else if (!force_recompile) {
       state->error = glcpp_preprocess(state, &source, &state->info_log,
                                       add_builtin_defines, state, ctx);
    }
@@ -2358,8 +2479,40 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
     */
    if (source_has_shader_include &&
        can_skip_compile(ctx, shader, source, source_sha1, force_recompile,
-                        true))
-      return;
+                        true, flags)) {
+      delete state->symbols;
+      ralloc_free(state);
+      return NULL;
+   }
+
+   if (!force_recompile) {
+      free((void *)shader->FallbackSource);
+
+      /* Copy pre-processed shader include to fallback source otherwise we
+       * have no guarantee the shader include source tree has not changed.
+       */
+      if (source_has_shader_include) {
+         shader->FallbackSource = strdup(source);
+         memcpy(shader->fallback_source_sha1, source_sha1, SHA1_DIGEST_LENGTH);
+      } else {
+         shader->FallbackSource = NULL;
+      }
+   }
+
+   *preprocessed = source;
+   return state;
+}
+
+void
+_mesa_glsl_compile_preprocessed_shader(struct gl_context *ctx,
+                                       struct gl_shader *shader,
+                                       struct _mesa_glsl_parse_state *state,
+                                       const char *source,
+                                       bool dump_ast, bool dump_hir,
+                                       bool force_recompile, GLbitfield flags)
+{
+   const uint8_t *source_sha1;
+   compile_source(shader, force_recompile, &source_sha1);
 
    if (!state->error) {
      _mesa_glsl_lexer_ctor(state, source);
@@ -2415,20 +2568,6 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
                                          state->symbols, shader);
    }
 
-   if (!force_recompile) {
-      free((void *)shader->FallbackSource);
-
-      /* Copy pre-processed shader include to fallback source otherwise we
-       * have no guarantee the shader include source tree has not changed.
-       */
-      if (source_has_shader_include) {
-         shader->FallbackSource = strdup(source);
-         memcpy(shader->fallback_source_sha1, source_sha1, SHA1_DIGEST_LENGTH);
-      } else {
-         shader->FallbackSource = NULL;
-      }
-   }
-
    delete state->symbols;
    ralloc_free(state);
 
@@ -2438,13 +2577,30 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    if (ctx->Cache && shader->CompileStatus == COMPILE_SUCCESS) {
       char sha1_buf[41];
       disk_cache_put_key(ctx->Cache, shader->disk_cache_sha1);
-      if (ctx->_Shader->Flags & GLSL_CACHE_INFO) {
+      if (flags & GLSL_CACHE_INFO) {
          _mesa_sha1_format(sha1_buf, shader->disk_cache_sha1);
          fprintf(stderr, "marking shader: %s\n", sha1_buf);
       }
    }
 }
 
+void
+_mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
+                          bool dump_ast, bool dump_hir, bool force_recompile)
+{
+   const GLbitfield flags = ctx->_Shader->Flags;
+   const char *source;
+   struct _mesa_glsl_parse_state *state =
+      _mesa_glsl_preprocess_shader(ctx, shader, force_recompile, flags,
+                                   &source);
+
+   if (state) {
+      _mesa_glsl_compile_preprocessed_shader(ctx, shader, state, source,
+                                             dump_ast, dump_hir,
+                                             force_recompile, flags);
+   }
+}
+
 } /* extern "C" */
 /**
  * Do the set of common optimizations passes
@@ -25,6 +25,9 @@
 #ifndef GLSL_PROGRAM_H
 #define GLSL_PROGRAM_H
 
+#include <stdbool.h>
+#include "util/glheader.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -32,11 +35,35 @@ extern "C" {
 struct gl_context;
 struct gl_shader;
 struct gl_shader_program;
+struct _mesa_glsl_parse_state;
 
 extern void
 _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
 			  bool dump_ast, bool dump_hir, bool force_recompile);
 
+/**
+ * The two halves of _mesa_glsl_compile_shader().
+ *
+ * Preprocessing resolves #include against the shared include tree and
+ * search paths, so it has to happen on the thread that called
+ * glCompileShader.  It returns NULL if the compile can be skipped, otherwise
+ * the parse state and preprocessed source to hand to
+ * _mesa_glsl_compile_preprocessed_shader(), which only reads constant
+ * context state.  \p flags are the GLSL_* debug flags to use.
+ */
+extern struct _mesa_glsl_parse_state *
+_mesa_glsl_preprocess_shader(struct gl_context *ctx, struct gl_shader *shader,
+                             bool force_recompile, GLbitfield flags,
+                             const char **preprocessed);
+
+extern void
+_mesa_glsl_compile_preprocessed_shader(struct gl_context *ctx,
+                                       struct gl_shader *shader,
+                                       struct _mesa_glsl_parse_state *state,
+                                       const char *source,
+                                       bool dump_ast, bool dump_hir,
+                                       bool force_recompile, GLbitfield flags);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -31,12 +31,83 @@
 #include <math.h>
 #include "util/half_float.h"
 #include "util/macros.h"
+#include "util/u_dynarray.h"
 #include "util/u_math.h"
 #include "util/u_qsort.h"
+#include "util/u_queue.h"
 #include "nir_builder.h"
 #include "nir_control_flow_private.h"
 #include "nir_worklist.h"
 
+/* Per-job state of nir_shader_parallel_foreach_impl().
+ *
+ * Function impls of a shader share its gc_ctx and its ralloc context, so
+ * while a job runs, anything it would allocate from those goes to private
+ * contexts of the job instead, which are merged back into the shader once
+ * all jobs are done.  Freeing instructions which are still owned by the
+ * shader's gc_ctx is deferred until then as well.
+ */
+struct parallel_impl_job {
+   struct util_queue_fence fence;
+   nir_function_impl *impl;
+   nir_impl_callback cb;
+   void *data;
+
+   nir_shader *shader;
+   void *impl_parent;
+   void *mem_ctx;
+   gc_ctx *gctx;
+   struct util_dynarray deferred_frees;
+};
+
+static thread_local struct parallel_impl_job *current_job;
+
+static inline void *
+shader_mem_ctx(nir_shader *shader)
+{
+   if (unlikely(current_job) && current_job->shader == shader)
+      return current_job->mem_ctx;
+   return shader;
+}
+
+static inline gc_ctx *
+shader_gctx(nir_shader *shader)
+{
+   if (unlikely(current_job) && current_job->shader == shader)
+      return current_job->gctx;
+   return shader->gctx;
+}
+
+/* The gc_ctx to allocate more sources of an existing instruction from. */
+static inline gc_ctx *
+instr_gctx(const void *instr)
+{
+   gc_ctx *ctx = gc_get_context((void *)instr);
+   if (unlikely(current_job) && ctx == current_job->shader->gctx)
+      return current_job->gctx;
+   return ctx;
+}
+
+nir_shader *
+nir_cf_node_shader(const void *node)
+{
+   void *parent = ralloc_parent(node);
+   if (unlikely(current_job) && parent == current_job->mem_ctx)
+      return current_job->shader;
+   return parent;
+}
+
+void
+nir_gc_free(void *ptr)
+{
+   if (unlikely(current_job) &&
+       gc_get_context(ptr) == current_job->shader->gctx) {
+      util_dynarray_append(&current_job->deferred_frees, void *, ptr);
+      return;
+   }
+   gc_free(ptr);
+}
+
 #ifndef NDEBUG
 uint32_t nir_debug = 0;
 bool nir_debug_print_shader[MESA_SHADER_KERNEL + 1] = { 0 };
@@ -286,7 +357,7 @@ nir_variable *
 nir_local_variable_create(nir_function_impl *impl,
                           const struct glsl_type *type, const char *name)
 {
-   nir_variable *var = rzalloc(impl->function->shader, nir_variable);
+   nir_variable *var = rzalloc(shader_mem_ctx(impl->function->shader), nir_variable);
    var->name = ralloc_strdup(var, name);
    var->type = type;
    var->data.mode = nir_var_function_temp;
@@ -579,10 +650,145 @@ nir_function_impl_create(nir_function *function)
    return impl;
 }
 
+static void
+steal_cf_list(void *mem_ctx, struct exec_list *cf_list)
+{
+   foreach_list_typed(nir_cf_node, node, node, cf_list) {
+      ralloc_steal(mem_ctx, node);
+
+      switch (node->type) {
+      case nir_cf_node_if: {
+         nir_if *nif = nir_cf_node_as_if(node);
+         steal_cf_list(mem_ctx, &nif->then_list);
+         steal_cf_list(mem_ctx, &nif->else_list);
+         break;
+      }
+      case nir_cf_node_loop: {
+         nir_loop *loop = nir_cf_node_as_loop(node);
+         steal_cf_list(mem_ctx, &loop->body);
+         steal_cf_list(mem_ctx, &loop->continue_list);
+         break;
+      }
+      default:
+         break;
+      }
+   }
+}
+
+/* Moves everything of the impl which is parented to the shader over to the
+ * job's context, so that neither the job nor passes calling ralloc_parent()
+ * on the impl or its control flow ever touch the shader's ralloc context.
+ */
+static void
+parallel_impl_job_init(struct parallel_impl_job *j, nir_function_impl *impl)
+{
+   j->mem_ctx = ralloc_context(NULL);
+   j->gctx = gc_context(NULL);
+   util_dynarray_init(&j->deferred_frees, NULL);
+
+   j->impl_parent = ralloc_parent(impl);
+   ralloc_steal(j->mem_ctx, impl);
+   steal_cf_list(j->mem_ctx, &impl->body);
+   ralloc_steal(j->mem_ctx, impl->end_block);
+   nir_foreach_function_temp_variable(var, impl)
+      ralloc_steal(j->mem_ctx, var);
+}
+
+static void
+parallel_impl_job_finish(struct parallel_impl_job *j)
+{
+   nir_shader *shader = j->shader;
+
+   gc_adopt(shader->gctx, j->gctx);
+   ralloc_free(j->gctx);
+
+   ralloc_steal(j->impl_parent, j->impl);
+   ralloc_adopt(shader, j->mem_ctx);
+   ralloc_free(j->mem_ctx);
+
+   util_dynarray_foreach(&j->deferred_frees, void *, ptr)
+      gc_free(*ptr);
+   util_dynarray_fini(&j->deferred_frees);
+}
+
+static void
+parallel_impl_execute(void *job, UNUSED void *gdata, UNUSED int thread_index)
+{
+   struct parallel_impl_job *j = job;
+
+   current_job = j;
+   j->cb(j->impl, j->data);
+   current_job = NULL;
+}
+
+/**
+ * Runs \p cb on every function impl of \p shader, with impls distributed
+ * over the threads of \p queue.  Returns once all of them are done.
+ *
+ * The callback may freely create, modify and remove instructions and
+ * control flow within the impl it is given as well as add local variables
+ * to it and require metadata on it.  While it runs, all of that is
+ * allocated from contexts private to the job, which are merged into the
+ * shader afterwards, so no locking is involved.
+ *
+ * The callback must not touch other impls or shader-level state such as
+ * nir_shader::variables or nir_shader::info, nor allocate with the shader
+ * as ralloc parent by other means than the nir_*_create() helpers.
+ * Shader-wide passes (e.g. nir_sweep or anything calling
+ * nir_shader_get_entrypoint) are not allowed either.
+ *
+ * If \p queue is NULL or the shader has only one impl, the callback is
+ * simply run serially on the calling thread.
+ */
+void
+nir_shader_parallel_foreach_impl(nir_shader *shader, struct util_queue *queue,
+                                 nir_impl_callback cb, void *data)
+{
+   unsigned num_impls = 0;
+   nir_foreach_function_impl(impl, shader)
+      num_impls++;
+
+   if (queue == NULL || num_impls <= 1) {
+      nir_foreach_function_impl(impl, shader)
+         cb(impl, data);
+      return;
+   }
+
+   struct parallel_impl_job *jobs =
+      calloc(num_impls, sizeof(struct parallel_impl_job));
+
+   /* Detach all impls from the shader before the first job starts. */
+   unsigned i = 0;
+   nir_foreach_function_impl(impl, shader) {
+      struct parallel_impl_job *j = &jobs[i++];
+      j->impl = impl;
+      j->cb = cb;
+      j->data = data;
+      j->shader = shader;
+      parallel_impl_job_init(j, impl);
+      util_queue_fence_init(&j->fence);
+   }
+
+   for (i = 0; i < num_impls; i++) {
+      util_queue_add_job(queue, &jobs[i], &jobs[i].fence,
+                         parallel_impl_execute, NULL, 0);
+   }
+
+   for (i = 0; i < num_impls; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+
+   for (i = 0; i < num_impls; i++)
+      parallel_impl_job_finish(&jobs[i]);
+
+   free(jobs);
+}
+
 nir_block *
 nir_block_create(nir_shader *shader)
 {
-   nir_block *block = rzalloc(shader, nir_block);
+   nir_block *block = rzalloc(shader_mem_ctx(shader), nir_block);
 
    cf_init(&block->cf_node, nir_cf_node_block);
 
@@ -613,7 +819,7 @@ src_init(nir_src *src)
 nir_if *
 nir_if_create(nir_shader *shader)
 {
-   nir_if *if_stmt = ralloc(shader, nir_if);
+   nir_if *if_stmt = ralloc(shader_mem_ctx(shader), nir_if);
 
    if_stmt->control = nir_selection_control_none;
 
@@ -636,7 +842,7 @@ nir_if_create(nir_shader *shader)
 nir_loop *
 nir_loop_create(nir_shader *shader)
 {
-   nir_loop *loop = rzalloc(shader, nir_loop);
+   nir_loop *loop = rzalloc(shader_mem_ctx(shader), nir_loop);
 
    cf_init(&loop->cf_node, nir_cf_node_loop);
    /* Assume that loops are divergent until proven otherwise */
@@ -675,7 +881,7 @@ nir_alu_instr *
 nir_alu_instr_create(nir_shader *shader, nir_op op)
 {
    unsigned num_srcs = nir_op_infos[op].num_inputs;
-   nir_alu_instr *instr = gc_zalloc_zla(shader->gctx, nir_alu_instr, nir_alu_src, num_srcs);
+   nir_alu_instr *instr = gc_zalloc_zla(shader_gctx(shader), nir_alu_instr, nir_alu_src, num_srcs);
 
    instr_init(&instr->instr, nir_instr_type_alu);
    instr->op = op;
@@ -688,7 +894,7 @@ nir_alu_instr_create(nir_shader *shader, nir_op op)
 nir_deref_instr *
 nir_deref_instr_create(nir_shader *shader, nir_deref_type deref_type)
 {
-   nir_deref_instr *instr = gc_zalloc(shader->gctx, nir_deref_instr, 1);
+   nir_deref_instr *instr = gc_zalloc(shader_gctx(shader), nir_deref_instr, 1);
 
    instr_init(&instr->instr, nir_instr_type_deref);
 
@@ -706,7 +912,7 @@ nir_deref_instr_create(nir_shader *shader, nir_deref_type deref_type)
 nir_jump_instr *
 nir_jump_instr_create(nir_shader *shader, nir_jump_type type)
 {
-   nir_jump_instr *instr = gc_alloc(shader->gctx, nir_jump_instr, 1);
+   nir_jump_instr *instr = gc_alloc(shader_gctx(shader), nir_jump_instr, 1);
    instr_init(&instr->instr, nir_instr_type_jump);
    src_init(&instr->condition);
    instr->type = type;
@@ -721,7 +927,7 @@ nir_load_const_instr_create(nir_shader *shader, unsigned num_components,
                             unsigned bit_size)
 {
    nir_load_const_instr *instr =
-      gc_zalloc_zla(shader->gctx, nir_load_const_instr, nir_const_value, num_components);
+      gc_zalloc_zla(shader_gctx(shader), nir_load_const_instr, nir_const_value, num_components);
    instr_init(&instr->instr, nir_instr_type_load_const);
 
    nir_def_init(&instr->instr, &instr->def, num_components, bit_size);
@@ -734,7 +940,7 @@ nir_intrinsic_instr_create(nir_shader *shader, nir_intrinsic_op op)
 {
    unsigned num_srcs = nir_intrinsic_infos[op].num_srcs;
    nir_intrinsic_instr *instr =
-      gc_zalloc_zla(shader->gctx, nir_intrinsic_instr, nir_src, num_srcs);
+      gc_zalloc_zla(shader_gctx(shader), nir_intrinsic_instr, nir_src, num_srcs);
 
    instr_init(&instr->instr, nir_instr_type_intrinsic);
    instr->intrinsic = op;
@@ -750,7 +956,7 @@ nir_call_instr_create(nir_shader *shader, nir_function *callee)
 {
    const unsigned num_params = callee->num_params;
    nir_call_instr *instr =
-      gc_zalloc_zla(shader->gctx, nir_call_instr, nir_src, num_params);
+      gc_zalloc_zla(shader_gctx(shader), nir_call_instr, nir_src, num_params);
 
    instr_init(&instr->instr, nir_instr_type_call);
    instr->callee = callee;
@@ -771,11 +977,11 @@ static int8_t default_tg4_offsets[4][2] = {
 nir_tex_instr *
 nir_tex_instr_create(nir_shader *shader, unsigned num_srcs)
 {
-   nir_tex_instr *instr = gc_zalloc(shader->gctx, nir_tex_instr, 1);
+   nir_tex_instr *instr = gc_zalloc(shader_gctx(shader), nir_tex_instr, 1);
    instr_init(&instr->instr, nir_instr_type_tex);
 
    instr->num_srcs = num_srcs;
-   instr->src = gc_alloc(shader->gctx, nir_tex_src, num_srcs);
+   instr->src = gc_alloc(shader_gctx(shader), nir_tex_src, num_srcs);
    for (unsigned i = 0; i < num_srcs; i++)
       src_init(&instr->src[i].src);
 
@@ -791,7 +997,7 @@ nir_tex_instr_add_src(nir_tex_instr *tex,
                       nir_tex_src_type src_type,
                       nir_def *src)
 {
-   nir_tex_src *new_srcs = gc_zalloc(gc_get_context(tex), nir_tex_src, tex->num_srcs + 1);
+   nir_tex_src *new_srcs = gc_zalloc(instr_gctx(tex), nir_tex_src, tex->num_srcs + 1);
 
    for (unsigned i = 0; i < tex->num_srcs; i++) {
       new_srcs[i].src_type = tex->src[i].src_type;
@@ -799,7 +1005,7 @@ nir_tex_instr_add_src(nir_tex_instr *tex,
                          &tex->src[i].src);
    }
 
-   gc_free(tex->src);
+   nir_gc_free(tex->src);
    tex->src = new_srcs;
 
    tex->src[tex->num_srcs].src_type = src_type;
@@ -835,7 +1041,7 @@ nir_tex_instr_has_explicit_tg4_offsets(nir_tex_instr *tex)
 nir_phi_instr *
 nir_phi_instr_create(nir_shader *shader)
 {
-   nir_phi_instr *instr = gc_alloc(shader->gctx, nir_phi_instr, 1);
+   nir_phi_instr *instr = gc_alloc(shader_gctx(shader), nir_phi_instr, 1);
    instr_init(&instr->instr, nir_instr_type_phi);
 
    exec_list_make_empty(&instr->srcs);
@@ -856,7 +1062,7 @@ nir_phi_instr_add_src(nir_phi_instr *instr, nir_block *pred, nir_def *src)
 {
    nir_phi_src *phi_src;
 
-   phi_src = gc_zalloc(gc_get_context(instr), nir_phi_src, 1);
+   phi_src = gc_zalloc(instr_gctx(instr), nir_phi_src, 1);
    phi_src->pred = pred;
    phi_src->src = nir_src_for_ssa(src);
    nir_src_set_parent_instr(&phi_src->src, &instr->instr);
@@ -868,7 +1074,7 @@ nir_phi_instr_add_src(nir_phi_instr *instr, nir_block *pred, nir_def *src)
 nir_parallel_copy_instr *
 nir_parallel_copy_instr_create(nir_shader *shader)
 {
-   nir_parallel_copy_instr *instr = gc_alloc(shader->gctx, nir_parallel_copy_instr, 1);
+   nir_parallel_copy_instr *instr = gc_alloc(shader_gctx(shader), nir_parallel_copy_instr, 1);
    instr_init(&instr->instr, nir_instr_type_parallel_copy);
 
    exec_list_make_empty(&instr->entries);
@@ -881,7 +1087,7 @@ nir_undef_instr_create(nir_shader *shader,
                        unsigned num_components,
                        unsigned bit_size)
 {
-   nir_undef_instr *instr = gc_alloc(shader->gctx, nir_undef_instr, 1);
+   nir_undef_instr *instr = gc_alloc(shader_gctx(shader), nir_undef_instr, 1);
    instr_init(&instr->instr, nir_instr_type_undef);
 
    nir_def_init(&instr->instr, &instr->def, num_components, bit_size);
@@ -1172,13 +1378,13 @@ nir_instr_free(nir_instr *instr)
 {
    switch (instr->type) {
    case nir_instr_type_tex:
-      gc_free(nir_instr_as_tex(instr)->src);
+      nir_gc_free(nir_instr_as_tex(instr)->src);
       break;
 
    case nir_instr_type_phi: {
       nir_phi_instr *phi = nir_instr_as_phi(instr);
       nir_foreach_phi_src_safe(phi_src, phi)
-         gc_free(phi_src);
+         nir_gc_free(phi_src);
       break;
    }
 
@@ -1186,7 +1392,7 @@ nir_instr_free(nir_instr *instr)
       break;
    }
 
-   gc_free(instr);
+   nir_gc_free(instr);
 }
 
 void
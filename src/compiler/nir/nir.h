@@ -4296,6 +4296,14 @@ nir_function_impl *nir_function_impl_create(nir_function *func);
 /** creates a function_impl that isn't tied to any particular function */
 nir_function_impl *nir_function_impl_create_bare(nir_shader *shader);
 
+struct util_queue;
+typedef void (*nir_impl_callback)(nir_function_impl *impl, void *data);
+
+/** runs an impl-local callback on every impl, in parallel on the queue */
+void nir_shader_parallel_foreach_impl(nir_shader *shader,
+                                      struct util_queue *queue,
+                                      nir_impl_callback cb, void *data);
+
 nir_block *nir_block_create(nir_shader *shader);
 nir_if *nir_if_create(nir_shader *shader);
 nir_loop *nir_loop_create(nir_shader *shader);
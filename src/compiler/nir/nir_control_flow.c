@@ -184,7 +184,7 @@ replace_successor(nir_block *block, nir_block *old_succ, nir_block *new_succ)
 static nir_block *
 split_block_beginning(nir_block *block)
 {
-   nir_block *new_block = nir_block_create(ralloc_parent(block));
+   nir_block *new_block = nir_block_create(nir_cf_node_shader(block));
    new_block->cf_node.parent = block->cf_node.parent;
    exec_node_insert_node_before(&block->cf_node.node, &new_block->cf_node.node);
 
@@ -316,7 +316,7 @@ block_add_normal_succs(nir_block *block)
 static nir_block *
 split_block_end(nir_block *block)
 {
-   nir_block *new_block = nir_block_create(ralloc_parent(block));
+   nir_block *new_block = nir_block_create(nir_cf_node_shader(block));
    new_block->cf_node.parent = block->cf_node.parent;
    exec_node_insert_after(&block->cf_node.node, &new_block->cf_node.node);
 
@@ -431,7 +431,7 @@ nir_loop_add_continue_construct(nir_loop *loop)
 {
    assert(!nir_loop_has_continue_construct(loop));
 
-   nir_block *cont = nir_block_create(ralloc_parent(loop));
+   nir_block *cont = nir_block_create(nir_cf_node_shader(loop));
    exec_list_push_tail(&loop->continue_list, &cont->cf_node.node);
    cont->cf_node.parent = &loop->cf_node;
 
@@ -472,7 +472,7 @@ remove_phi_src(nir_block *block, nir_block *pred)
          if (src->pred == pred) {
             list_del(&src->src.use_link);
             exec_node_remove(&src->node);
-            gc_free(src);
+            nir_gc_free(src);
          }
       }
    }
@@ -37,4 +37,12 @@
 void nir_handle_add_jump(nir_block *block);
 void nir_handle_remove_jump(nir_block *block, nir_jump_type type);
 
+/* gc_free() which is safe to use from nir_shader_parallel_foreach_impl(). */
+void nir_gc_free(void *ptr);
+
+/* The shader owning a block, if or loop, which is not necessarily its ralloc
+ * parent while nir_shader_parallel_foreach_impl() runs.
+ */
+nir_shader *nir_cf_node_shader(const void *node);
+
 #endif /* NIR_CONTROL_FLOW_PRIVATE_H */
@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "nir_test.h"
+#include "nir_serialize.h"
+#include "util/blob.h"
+#include "util/u_queue.h"
+
+namespace {
+
+class nir_parallel_impl_test : public nir_test {
+protected:
+   nir_parallel_impl_test()
+      : nir_test::nir_test("nir_parallel_impl_test")
+   {
+   }
+
+   void build_function(unsigned idx);
+};
+
+/* Builds a function which loops over a local variable:
+ *
+ *    v = float(local_invocation_index)
+ *    loop {
+ *       if (idx + 100 < v)
+ *          break;
+ *       v = fabs(v) + fabs(v * -0.5) + (idx + 1)
+ *    }
+ */
+void
+nir_parallel_impl_test::build_function(unsigned idx)
+{
+   char name[32];
+   snprintf(name, sizeof(name), "func%u", idx);
+
+   nir_function *func = nir_function_create(b->shader, name);
+   nir_function_impl *impl = nir_function_impl_create(func);
+   nir_builder fb = nir_builder_at(nir_after_impl(impl));
+
+   nir_variable *v = nir_local_variable_create(impl, glsl_float_type(), "v");
+   nir_store_var(&fb, v, nir_u2f32(&fb, nir_load_local_invocation_index(&fb)), 1);
+
+   nir_push_loop(&fb);
+   {
+      nir_def *val = nir_load_var(&fb, v);
+      nir_push_if(&fb, nir_flt_imm(&fb, val, idx + 100.0f));
+      nir_push_else(&fb, NULL);
+      nir_jump(&fb, nir_jump_break);
+      nir_pop_if(&fb, NULL);
+
+      nir_def *sum = nir_fadd(&fb, nir_fabs(&fb, val),
+                              nir_fabs(&fb, nir_fmul_imm(&fb, val, -0.5)));
+      nir_store_var(&fb, v, nir_fadd_imm(&fb, sum, idx + 1.0f), 1);
+   }
+   nir_pop_loop(&fb, NULL);
+}
+
+/* Replaces fabs(x) with (x < 0 ? -x : x) written as an if with a phi, which
+ * creates blocks, ifs and phis and frees instructions.
+ */
+static nir_def *
+lower_fabs(nir_builder *b, nir_instr *instr, UNUSED void *data)
+{
+   nir_def *x = nir_ssa_for_alu_src(b, nir_instr_as_alu(instr), 0);
+
+   nir_push_if(b, nir_flt_imm(b, x, 0.0));
+   nir_def *neg = nir_fneg(b, x);
+   nir_push_else(b, NULL);
+   nir_def *pos = nir_mov(b, x);
+   nir_pop_if(b, NULL);
+
+   return nir_if_phi(b, neg, pos);
+}
+
+static bool
+is_fabs(const nir_instr *instr, UNUSED const void *data)
+{
+   return instr->type == nir_instr_type_alu &&
+          nir_instr_as_alu(instr)->op == nir_op_fabs;
+}
+
+static void
+run_impl_passes(nir_function_impl *impl, UNUSED void *data)
+{
+   nir_function_impl_lower_instructions(impl, is_fabs, lower_fabs, NULL);
+   nir_copy_prop_impl(impl);
+   nir_local_variable_create(impl, glsl_int_type(), "added");
+   nir_metadata_require(impl, nir_metadata_dominance);
+}
+
+static void
+serialize(nir_shader *shader, struct blob *blob)
+{
+   blob_init(blob);
+   nir_serialize(blob, shader, false);
+   ASSERT_FALSE(blob->out_of_memory);
+}
+
+} // namespace
+
+TEST_F(nir_parallel_impl_test, matches_serial)
+{
+   const unsigned num_funcs = 32;
+   for (unsigned i = 0; i < num_funcs; i++)
+      build_function(i);
+   nir_validate_shader(b->shader, "after building");
+
+   nir_shader *serial = nir_shader_clone(NULL, b->shader);
+   nir_foreach_function_impl(impl, serial)
+      run_impl_passes(impl, NULL);
+
+   struct util_queue queue;
+   ASSERT_TRUE(util_queue_init(&queue, "nir_test", num_funcs, 4, 0, NULL));
+   nir_shader_parallel_foreach_impl(b->shader, &queue, run_impl_passes, NULL);
+   util_queue_destroy(&queue);
+
+   nir_validate_shader(b->shader, "after parallel passes");
+
+   /* Everything the jobs allocated must be owned by the shader again. */
+   nir_foreach_function_impl(impl, b->shader) {
+      EXPECT_EQ(ralloc_parent(impl), b->shader);
+      nir_foreach_block(block, impl) {
+         EXPECT_EQ(ralloc_parent(block), b->shader);
+         nir_foreach_instr(instr, block)
+            EXPECT_EQ(gc_get_context(instr), b->shader->gctx);
+      }
+   }
+
+   nir_sweep(b->shader);
+   nir_validate_shader(b->shader, "after sweep");
+
+   struct blob expected, actual;
+   serialize(serial, &expected);
+   serialize(b->shader, &actual);
+
+   ASSERT_EQ(expected.size, actual.size);
+   EXPECT_EQ(memcmp(expected.data, actual.data, actual.size), 0);
+
+   blob_finish(&expected);
+   blob_finish(&actual);
+   ralloc_free(serial);
+}
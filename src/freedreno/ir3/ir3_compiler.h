@@ -80,6 +80,11 @@ struct ir3_compiler {
    uint8_t gen;
    uint32_t shader_count;
 
+   /* Bumped by ir3_shader_replace_variant(), so that users caching state
+    * built from fast variants know to rebuild it.
+    */
+   uint32_t variants_replaced;
+
    struct disk_cache *disk_cache;
 
    struct nir_shader_compiler_options nir_options;
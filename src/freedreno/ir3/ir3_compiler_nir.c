@@ -5061,7 +5061,7 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
       progress |= IR3_PASS(ir, ir3_cse);
       progress |= IR3_PASS(ir, ir3_dce, so);
       progress |= IR3_PASS(ir, ir3_opt_predicates, so);
-   } while (progress);
+   } while (progress && !so->fast_compile);
 
    /* at this point, for binning pass, throw away unneeded outputs:
     * Note that for a6xx and later, we do this after ir3_cp to ensure
@@ -5144,7 +5144,8 @@ ir3_compile_shader_nir(struct ir3_compiler *compiler,
       goto out;
    }
 
-   IR3_PASS(ir, ir3_postsched, so);
+   if (!so->fast_compile)
+      IR3_PASS(ir, ir3_postsched, so);
 
    IR3_PASS(ir, ir3_legalize_relative);
    IR3_PASS(ir, ir3_lower_subgroups);
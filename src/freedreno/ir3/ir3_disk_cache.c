@@ -258,6 +258,12 @@ ir3_disk_cache_store(struct ir3_shader *shader,
    if (!shader->compiler->disk_cache)
       return;
 
+   /* The cache key doesn't include fast_compile, and a fast variant would
+    * take the place of the fully optimized one.
+    */
+   if (v->fast_compile)
+      return;
+
    cache_key cache_key;
 
    compute_variant_key(shader, v, cache_key);
@@ -322,7 +322,7 @@ needs_binning_variant(struct ir3_shader_variant *v)
 
 static struct ir3_shader_variant *
 create_variant(struct ir3_shader *shader, const struct ir3_shader_key *key,
-               bool write_disasm, void *mem_ctx)
+               bool write_disasm, bool fast_compile, void *mem_ctx)
 {
    struct ir3_shader_variant *v = alloc_variant(shader, key, NULL, mem_ctx);
 
@@ -330,16 +330,23 @@ create_variant(struct ir3_shader *shader, const struct ir3_shader_key *key,
       goto fail;
 
    v->disasm_info.write_disasm = write_disasm;
+   v->fast_compile = fast_compile;
 
    if (needs_binning_variant(v)) {
       v->binning = alloc_variant(shader, key, v, mem_ctx);
       if (!v->binning)
          goto fail;
       v->binning->disasm_info.write_disasm = write_disasm;
+      v->binning->fast_compile = fast_compile;
    }
 
-   if (ir3_disk_cache_retrieve(shader, v))
+   if (ir3_disk_cache_retrieve(shader, v)) {
+      /* Only fully optimized variants are stored in the disk cache. */
+      v->fast_compile = false;
+      if (v->binning)
+         v->binning->fast_compile = false;
       return v;
+   }
 
    if (!shader->nir_finalized) {
       ir3_nir_post_finalize(shader);
@@ -376,7 +383,22 @@ ir3_shader_create_variant(struct ir3_shader *shader,
                           const struct ir3_shader_key *key,
                           bool keep_ir)
 {
-   return create_variant(shader, key, keep_ir, NULL);
+   return create_variant(shader, key, keep_ir, false, NULL);
+}
+
+/**
+ * Like ir3_shader_create_variant(), but compiles the variant with
+ * ir3_shader_variant::fast_compile set unless a fully optimized one is
+ * found in the disk cache.  Fast variants are never stored in the disk
+ * cache, it is up to the caller to replace them with a fully optimized
+ * variant.
+ */
+struct ir3_shader_variant *
+ir3_shader_create_fast_variant(struct ir3_shader *shader,
+                               const struct ir3_shader_key *key,
+                               bool keep_ir)
+{
+   return create_variant(shader, key, keep_ir, true, NULL);
 }
 
 static inline struct ir3_shader_variant *
@@ -391,19 +413,17 @@ shader_variant(struct ir3_shader *shader, const struct ir3_shader_key *key)
    return NULL;
 }
 
-struct ir3_shader_variant *
-ir3_shader_get_variant(struct ir3_shader *shader,
-                       const struct ir3_shader_key *key, bool binning_pass,
-                       bool write_disasm, bool *created)
+static struct ir3_shader_variant *
+get_variant(struct ir3_shader *shader, const struct ir3_shader_key *key,
+            bool binning_pass, bool write_disasm, bool fast_compile,
+            bool *created)
 {
-   MESA_TRACE_FUNC();
-
    mtx_lock(&shader->variants_lock);
    struct ir3_shader_variant *v = shader_variant(shader, key);
 
    if (!v) {
       /* compile new variant if it doesn't exist already: */
-      v = create_variant(shader, key, write_disasm, shader);
+      v = create_variant(shader, key, write_disasm, fast_compile, shader);
       if (v) {
          v->next = shader->variants;
          shader->variants = v;
@@ -421,6 +441,54 @@ ir3_shader_get_variant(struct ir3_shader *shader,
    return v;
 }
 
+struct ir3_shader_variant *
+ir3_shader_get_variant(struct ir3_shader *shader,
+                       const struct ir3_shader_key *key, bool binning_pass,
+                       bool write_disasm, bool *created)
+{
+   MESA_TRACE_FUNC();
+
+   return get_variant(shader, key, binning_pass, write_disasm, false, created);
+}
+
+/**
+ * Like ir3_shader_get_variant(), but a variant that has to be compiled is
+ * compiled with ir3_shader_variant::fast_compile set, unless it is found in
+ * the disk cache.  Fast variants are kept until the caller replaces them
+ * with ir3_shader_replace_variant().
+ */
+struct ir3_shader_variant *
+ir3_shader_get_fast_variant(struct ir3_shader *shader,
+                            const struct ir3_shader_key *key,
+                            bool binning_pass, bool write_disasm,
+                            bool *created)
+{
+   MESA_TRACE_FUNC();
+
+   return get_variant(shader, key, binning_pass, write_disasm, true, created);
+}
+
+/**
+ * Add \p v, created with ir3_shader_create_variant() for the key of a fast
+ * variant of \p shader, so that lookups of that key return it from now on.
+ *
+ * The fast variant stays in the list, since users may still reference it,
+ * and is freed together with the shader.
+ */
+void
+ir3_shader_replace_variant(struct ir3_shader *shader,
+                           struct ir3_shader_variant *v)
+{
+   mtx_lock(&shader->variants_lock);
+   assert(shader_variant(shader, &v->key)->fast_compile);
+   ralloc_steal(shader, v);
+   v->next = shader->variants;
+   shader->variants = v;
+   mtx_unlock(&shader->variants_lock);
+
+   p_atomic_inc(&shader->compiler->variants_replaced);
+}
+
 struct ir3_shader *
 ir3_shader_passthrough_tcs(struct ir3_shader *vs, unsigned patch_vertices)
 {
@@ -555,6 +555,15 @@ struct ir3_shader_variant {
    struct ir3_shader_variant *nonbinning;
    //	};
 
+   /* Compile with a cheaper pipeline, trading code quality for compile
+    * time: the ir3 level cp/cse/dce loop only runs once and the post-RA
+    * scheduler is skipped.  Meant for variants that are needed right away
+    * and get replaced by a fully optimized compile later, so these are
+    * not stored in the disk cache.  See ir3_shader_get_fast_variant() and
+    * ir3_shader_replace_variant().
+    */
+   bool fast_compile;
+
    struct ir3 *ir; /* freed after assembling machine instructions */
 
    /* shader variants form a linked list: */
@@ -993,9 +1002,19 @@ ir3_shader_create_variant(struct ir3_shader *shader,
                           const struct ir3_shader_key *key,
                           bool keep_ir);
 struct ir3_shader_variant *
+ir3_shader_create_fast_variant(struct ir3_shader *shader,
+                               const struct ir3_shader_key *key,
+                               bool keep_ir);
+struct ir3_shader_variant *
 ir3_shader_get_variant(struct ir3_shader *shader,
                        const struct ir3_shader_key *key, bool binning_pass,
                        bool keep_ir, bool *created);
+struct ir3_shader_variant *
+ir3_shader_get_fast_variant(struct ir3_shader *shader,
+                            const struct ir3_shader_key *key,
+                            bool binning_pass, bool keep_ir, bool *created);
+void ir3_shader_replace_variant(struct ir3_shader *shader,
+                                struct ir3_shader_variant *v);
 
 struct ir3_shader *
 ir3_shader_from_nir(struct ir3_compiler *compiler, nir_shader *nir,
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "compiler/nir/nir_builder.h"
+#include "util/disk_cache.h"
+
+#include "ir3_compiler.h"
+#include "ir3_nir.h"
+#include "ir3_shader.h"
+
+/*
+ * Tests for ir3_shader_create_fast_variant(): fast variants compile to
+ * working code, are not stored in the disk cache, and are replaced by a
+ * fully optimized variant from the disk cache when there is one.  Also
+ * checks that ir3_shader_replace_variant() takes over the lookups of a
+ * fast variant's key.
+ */
+
+static struct ir3_shader *
+create_shader(struct ir3_compiler *c)
+{
+   nir_builder b = nir_builder_init_simple_shader(
+      MESA_SHADER_COMPUTE, ir3_get_compiler_options(c), "fast_compile");
+   b.shader->info.workgroup_size[0] = 64;
+   b.shader->info.workgroup_size[1] = 1;
+   b.shader->info.workgroup_size[2] = 1;
+   b.shader->info.num_ssbos = 1;
+
+   nir_def *idx = nir_channel(&b, nir_load_local_invocation_id(&b), 0);
+   nir_def *offset = nir_imul_imm(&b, idx, 4);
+   nir_def *val = nir_load_ssbo(&b, 1, 32, nir_imm_int(&b, 0), offset,
+                                .align_mul = 4);
+
+   /* Give the optimization loop something to do. */
+   for (unsigned i = 0; i < 8; i++) {
+      val = nir_iadd(&b, nir_imul(&b, val, val), nir_iadd_imm(&b, idx, i));
+      val = nir_ixor(&b, val, nir_ishr_imm(&b, val, 3));
+   }
+
+   nir_store_ssbo(&b, val, nir_imm_int(&b, 0), offset, .write_mask = 0x1,
+                  .align_mul = 4);
+
+   ir3_finalize_nir(c, b.shader);
+
+   return ir3_shader_from_nir(c, b.shader,
+                              &(struct ir3_shader_options){
+                                 .api_wavesize = IR3_SINGLE_OR_DOUBLE,
+                                 .real_wavesize = IR3_SINGLE_OR_DOUBLE,
+                              },
+                              NULL);
+}
+
+static int
+remove_entry(const char *path, const struct stat *sb, int type,
+             struct FTW *ftw)
+{
+   return remove(path);
+}
+
+static bool
+check(bool cond, const char *what)
+{
+   printf("%s: %s\n", cond ? "PASS" : "FAIL", what);
+   return cond;
+}
+
+int
+main(int argc, char **argv)
+{
+   struct fd_dev_id dev_id = {
+      .gpu_id = 630,
+   };
+   struct ir3_shader_key key = {};
+   bool pass = true;
+
+   /* Use a private cache, so that nothing from earlier runs is found. */
+   char cache_dir[] = "/tmp/ir3_fast_compile_XXXXXX";
+   if (!mkdtemp(cache_dir)) {
+      perror("mkdtemp");
+      return 1;
+   }
+   setenv("MESA_SHADER_CACHE_DIR", cache_dir, 1);
+   setenv("MESA_SHADER_CACHE_DISABLE", "false", 1);
+
+   struct ir3_compiler *c =
+      ir3_compiler_create(NULL, &dev_id, fd_dev_info_raw(&dev_id),
+                          &(struct ir3_compiler_options){});
+
+   struct ir3_shader *shader = create_shader(c);
+
+   struct ir3_shader_variant *fast =
+      ir3_shader_create_fast_variant(shader, &key, false);
+   pass &= check(fast && fast->fast_compile && fast->info.instrs_count > 0,
+                 "fast variant compiles");
+
+   struct ir3_shader *replaced = create_shader(c);
+   bool created = false;
+   struct ir3_shader_variant *listed =
+      ir3_shader_get_fast_variant(replaced, &key, false, false, &created);
+   pass &= check(listed && listed->fast_compile && created,
+                 "fast variant is added to the shader");
+
+   uint32_t variants_replaced = c->variants_replaced;
+   struct ir3_shader_variant *replacement =
+      ir3_shader_create_variant(replaced, &key, false);
+   ir3_shader_replace_variant(replaced, replacement);
+
+   created = false;
+   struct ir3_shader_variant *found =
+      ir3_shader_get_fast_variant(replaced, &key, false, false, &created);
+   pass &= check(found == replacement && !found->fast_compile && !created &&
+                 c->variants_replaced == variants_replaced + 1,
+                 "replaced fast variant");
+   ir3_shader_destroy(replaced);
+
+   struct ir3_shader_variant *full =
+      ir3_shader_create_variant(shader, &key, false);
+   pass &= check(full && !full->fast_compile && full->info.instrs_count > 0,
+                 "full variant compiles");
+
+   if (c->disk_cache) {
+      disk_cache_wait_for_idle(c->disk_cache);
+
+      /* The full variant is in the disk cache now, and a fresh shader with
+       * the same NIR finds it instead of compiling a fast variant.
+       */
+      struct ir3_shader *cached = create_shader(c);
+      struct ir3_shader_variant *retrieved =
+         ir3_shader_create_fast_variant(cached, &key, false);
+      pass &= check(retrieved && !retrieved->fast_compile &&
+                    retrieved->info.sizedwords == full->info.sizedwords,
+                    "fast variant request finds the cached full variant");
+      ralloc_free(retrieved);
+      ir3_shader_destroy(cached);
+   } else {
+      printf("SKIP: disk cache\n");
+   }
+
+   ralloc_free(fast);
+   ralloc_free(full);
+   ir3_shader_destroy(shader);
+   ir3_compiler_destroy(c);
+
+   /* A fast variant compiled first must not be found by a later compiler
+    * with the same cache.
+    */
+   char fast_cache_dir[] = "/tmp/ir3_fast_compile_XXXXXX";
+   if (!mkdtemp(fast_cache_dir)) {
+      perror("mkdtemp");
+      return 1;
+   }
+   setenv("MESA_SHADER_CACHE_DIR", fast_cache_dir, 1);
+
+   c = ir3_compiler_create(NULL, &dev_id, fd_dev_info_raw(&dev_id),
+                           &(struct ir3_compiler_options){});
+   if (c->disk_cache) {
+      shader = create_shader(c);
+      fast = ir3_shader_create_fast_variant(shader, &key, false);
+      disk_cache_wait_for_idle(c->disk_cache);
+      ralloc_free(fast);
+      ir3_shader_destroy(shader);
+
+      shader = create_shader(c);
+      fast = ir3_shader_create_fast_variant(shader, &key, false);
+      pass &= check(fast && fast->fast_compile,
+                    "fast variants are not stored in the disk cache");
+      ralloc_free(fast);
+      ir3_shader_destroy(shader);
+   }
+   ir3_compiler_destroy(c);
+
+   nftw(cache_dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+   nftw(fast_cache_dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+
+   return pass ? 0 : 1;
+}
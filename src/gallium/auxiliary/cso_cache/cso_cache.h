@@ -202,7 +202,7 @@ cso_find_state_template(struct cso_cache *sc, unsigned hash_key,
       void *iter_data = cso_hash_iter_data(iter);
       if (!memcmp(iter_data, key, key_size))
          return iter;
-      iter = cso_hash_iter_next(iter);
+      iter = cso_hash_find_next(iter);
    }
    return iter;
 }
@@ -109,6 +109,14 @@ struct cso_context_priv {
    void *tesseval_shader, *tesseval_shader_saved;
    void *compute_shader, *compute_shader_saved;
    void *velements, *velements_saved;
+
+   /** The cache entries last bound by cso_set_blend() etc.  They are still
+    * bound if their data matches the current handle above, which lets
+    * redundant binds skip hashing and the cache lookup.
+    */
+   struct cso_blend *blend_cso;
+   struct cso_depth_stencil_alpha *depth_stencil_cso;
+   struct cso_rasterizer *rasterizer_cso;
    struct pipe_query *render_condition, *render_condition_saved;
    enum pipe_render_cond_flag render_condition_mode, render_condition_mode_saved;
    bool render_condition_cond, render_condition_cond_saved;
@@ -157,6 +165,13 @@ delete_cso(struct cso_context_priv *ctx,
       assert(0);
    }
 
+   if (state == ctx->blend_cso)
+      ctx->blend_cso = NULL;
+   else if (state == ctx->depth_stencil_cso)
+      ctx->depth_stencil_cso = NULL;
+   else if (state == ctx->rasterizer_cso)
+      ctx->rasterizer_cso = NULL;
+
    cso_delete_state(ctx->base.pipe, state, type);
    return true;
 }
@@ -521,7 +536,13 @@ cso_set_blend(struct cso_context *cso,
    struct cso_context_priv *ctx = (struct cso_context_priv *)cso;
    unsigned key_size, hash_key;
    struct cso_hash_iter iter;
-   void *handle;
+   struct cso_blend *blend;
+
+   if (ctx->blend_cso && ctx->blend_cso->data == ctx->blend &&
+       !memcmp(templ, &ctx->blend_cso->state,
+               templ->independent_blend_enable ? CSO_BLEND_KEY_SIZE_ALL_RT :
+                                                 CSO_BLEND_KEY_SIZE_RT0))
+      return PIPE_OK;
 
    if (templ->independent_blend_enable) {
       /* This is duplicated with the else block below because we want key_size
@@ -554,14 +575,15 @@ cso_set_blend(struct cso_context *cso,
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
 
-      handle = cso->data;
+      blend = cso;
    } else {
-      handle = ((struct cso_blend *)cso_hash_iter_data(iter))->data;
+      blend = cso_hash_iter_data(iter);
    }
 
-   if (ctx->blend != handle) {
-      ctx->blend = handle;
-      ctx->base.pipe->bind_blend_state(ctx->base.pipe, handle);
+   ctx->blend_cso = blend;
+   if (ctx->blend != blend->data) {
+      ctx->blend = blend->data;
+      ctx->base.pipe->bind_blend_state(ctx->base.pipe, blend->data);
    }
    return PIPE_OK;
 }
@@ -592,12 +614,18 @@ cso_set_depth_stencil_alpha(struct cso_context *cso,
 {
    struct cso_context_priv *ctx = (struct cso_context_priv *)cso;
    const unsigned key_size = sizeof(struct pipe_depth_stencil_alpha_state);
+
+   if (ctx->depth_stencil_cso &&
+       ctx->depth_stencil_cso->data == ctx->depth_stencil &&
+       !memcmp(templ, &ctx->depth_stencil_cso->state, key_size))
+      return PIPE_OK;
+
    const unsigned hash_key = cso_construct_key(templ, key_size);
    struct cso_hash_iter iter = cso_find_state_template(&ctx->cache,
                                                        hash_key,
                                                        CSO_DEPTH_STENCIL_ALPHA,
                                                        templ, key_size);
-   void *handle;
+   struct cso_depth_stencil_alpha *dsa;
 
    if (cso_hash_iter_is_null(iter)) {
       struct cso_depth_stencil_alpha *cso =
@@ -616,15 +644,16 @@ cso_set_depth_stencil_alpha(struct cso_context *cso,
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
 
-      handle = cso->data;
+      dsa = cso;
    } else {
-      handle = ((struct cso_depth_stencil_alpha *)
-                cso_hash_iter_data(iter))->data;
+      dsa = cso_hash_iter_data(iter);
    }
 
-   if (ctx->depth_stencil != handle) {
-      ctx->depth_stencil = handle;
-      ctx->base.pipe->bind_depth_stencil_alpha_state(ctx->base.pipe, handle);
+   ctx->depth_stencil_cso = dsa;
+   if (ctx->depth_stencil != dsa->data) {
+      ctx->depth_stencil = dsa->data;
+      ctx->base.pipe->bind_depth_stencil_alpha_state(ctx->base.pipe,
+                                                     dsa->data);
    }
    return PIPE_OK;
 }
@@ -656,18 +685,23 @@ cso_set_rasterizer(struct cso_context *cso,
 {
    struct cso_context_priv *ctx = (struct cso_context_priv *)cso;
    const unsigned key_size = sizeof(struct pipe_rasterizer_state);
-   const unsigned hash_key = cso_construct_key(templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(&ctx->cache,
-                                                       hash_key,
-                                                       CSO_RASTERIZER,
-                                                       templ, key_size);
-   void *handle = NULL;
 
    /* We can't have both point_quad_rasterization (sprites) and point_smooth
     * (round AA points) enabled at the same time.
     */
    assert(!(templ->point_quad_rasterization && templ->point_smooth));
 
+   if (ctx->rasterizer_cso && ctx->rasterizer_cso->data == ctx->rasterizer &&
+       !memcmp(templ, &ctx->rasterizer_cso->state, key_size))
+      return PIPE_OK;
+
+   const unsigned hash_key = cso_construct_key(templ, key_size);
+   struct cso_hash_iter iter = cso_find_state_template(&ctx->cache,
+                                                       hash_key,
+                                                       CSO_RASTERIZER,
+                                                       templ, key_size);
+   struct cso_rasterizer *rast;
+
    if (cso_hash_iter_is_null(iter)) {
       struct cso_rasterizer *cso = MALLOC(sizeof(struct cso_rasterizer));
       if (!cso)
@@ -682,17 +716,18 @@ cso_set_rasterizer(struct cso_context *cso,
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
 
-      handle = cso->data;
+      rast = cso;
    } else {
-      handle = ((struct cso_rasterizer *)cso_hash_iter_data(iter))->data;
+      rast = cso_hash_iter_data(iter);
    }
 
-   if (ctx->rasterizer != handle) {
-      ctx->rasterizer = handle;
+   ctx->rasterizer_cso = rast;
+   if (ctx->rasterizer != rast->data) {
+      ctx->rasterizer = rast->data;
       ctx->flatshade_first = templ->flatshade_first;
       if (ctx->vbuf)
          u_vbuf_set_flatshade_first(ctx->vbuf, ctx->flatshade_first);
-      ctx->base.pipe->bind_rasterizer_state(ctx->base.pipe, handle);
+      ctx->base.pipe->bind_rasterizer_state(ctx->base.pipe, rast->data);
    }
    return PIPE_OK;
 }
@@ -1390,7 +1425,14 @@ cso_set_sampler(struct cso_context_priv *ctx, enum pipe_shader_type shader_stage
                 unsigned idx, const struct pipe_sampler_state *templ,
                 size_t size)
 {
-   struct cso_sampler *cso = set_sampler(ctx, shader_stage, idx, templ, size);
+   struct cso_sampler *cso = ctx->samplers[shader_stage].cso_samplers[idx];
+
+   /* Bound samplers are never evicted from the cache, see sanitize_hash(),
+    * so the one in this slot can be compared against directly.
+    */
+   if (!cso || memcmp(templ, &cso->state, size))
+      cso = set_sampler(ctx, shader_stage, idx, templ, size);
+
    ctx->samplers[shader_stage].cso_samplers[idx] = cso;
    ctx->samplers[shader_stage].samplers[idx] = cso->data;
    return true;
@@ -32,165 +32,79 @@
 
 #include "util/u_debug.h"
 #include "util/u_memory.h"
-#include "util/bitscan.h"
 
 #include "cso_hash.h"
 
-#ifndef MAX
-#define MAX(a, b) ((a > b) ? (a) : (b))
-#endif
+static const unsigned MinNumBits = 4;
 
-static const int MinNumBits = 4;
 
-static const unsigned char prime_deltas[] = {
-   0,  0,  1,  3,  1,  5,  3,  3,  1,  9,  7,  5,  3,  9, 25,  3,
-   1, 21,  3, 21,  7, 15,  9,  5,  3, 29, 15,  0,  0,  0,  0,  0
-};
-
-
-static int
-primeForNumBits(int numBits)
-{
-   return (1 << numBits) + prime_deltas[numBits];
-}
-
-
-/*
- * Returns the smallest integer n such that
- * primeForNumBits(n) >= hint.
+/**
+ * Resize the table to 2^num_bits entries, dropping the tombstones.
  */
-static int
-countBits(int hint)
+static bool
+cso_hash_rehash(struct cso_hash *hash, unsigned num_bits)
 {
-   int numBits = util_bitcount(hint);
+   struct cso_node *old_table = hash->table;
+   const unsigned old_size = hash->table ? 1u << hash->num_bits : 0;
+   struct cso_node *table = CALLOC(1u << num_bits, sizeof(struct cso_node));
 
-   if (numBits >= (int)sizeof(prime_deltas)) {
-      numBits = sizeof(prime_deltas) - 1;
-   } else if (primeForNumBits(numBits) < hint) {
-      ++numBits;
-   }
-   return numBits;
-}
+   if (!table)
+      return false;
 
+   hash->table = table;
+   hash->num_bits = num_bits;
+   hash->used = hash->size;
 
-static struct cso_node *
-cso_hash_create_node(struct cso_hash *hash,
-                     unsigned akey, void *avalue,
-                     struct cso_node **anextNode)
-{
-   struct cso_node *node = MALLOC(sizeof(struct cso_node));
-
-   if (!node)
-      return NULL;
-
-   node->key = akey;
-   node->value = avalue;
-
-   node->next = *anextNode;
-   *anextNode = node;
-   ++hash->size;
-   return node;
-}
+   const unsigned mask = (1u << num_bits) - 1;
+   for (unsigned i = 0; i < old_size; i++) {
+      if (old_table[i].state != CSO_NODE_USED)
+         continue;
 
-
-static void
-cso_data_rehash(struct cso_hash *hash, int hint)
-{
-   if (hint < 0) {
-      hint = countBits(-hint);
-      if (hint < MinNumBits)
-         hint = MinNumBits;
-      hash->userNumBits = (short)hint;
-      while (primeForNumBits(hint) < (hash->size >> 1))
-         ++hint;
-   } else if (hint < MinNumBits) {
-      hint = MinNumBits;
+      unsigned j = cso_hash_slot(hash, old_table[i].key);
+      while (table[j].state != CSO_NODE_EMPTY)
+         j = (j + 1) & mask;
+      table[j] = old_table[i];
    }
 
-   if (hash->numBits != hint) {
-      struct cso_node *e = (struct cso_node *)hash;
-      struct cso_node **oldBuckets = hash->buckets;
-      const int oldNumBuckets = hash->numBuckets;
-
-      hash->numBits = (short)hint;
-      hash->numBuckets = primeForNumBits(hint);
-      hash->buckets = MALLOC(sizeof(struct cso_node*) * hash->numBuckets);
-      for (int i = 0; i < hash->numBuckets; ++i)
-         hash->buckets[i] = e;
-
-      for (int i = 0; i < oldNumBuckets; ++i) {
-         struct cso_node *firstNode = oldBuckets[i];
-         while (firstNode != e) {
-            unsigned h = firstNode->key;
-            struct cso_node *lastNode = firstNode;
-            struct cso_node *afterLastNode;
-            struct cso_node **beforeFirstNode;
-
-            while (lastNode->next != e && lastNode->next->key == h)
-               lastNode = lastNode->next;
-
-            afterLastNode = lastNode->next;
-            beforeFirstNode = &hash->buckets[h % hash->numBuckets];
-            while (*beforeFirstNode != e)
-               beforeFirstNode = &(*beforeFirstNode)->next;
-            lastNode->next = *beforeFirstNode;
-            *beforeFirstNode = firstNode;
-            firstNode = afterLastNode;
-         }
-      }
-      FREE(oldBuckets);
-   }
-}
-
-
-static void
-cso_data_might_grow(struct cso_hash *hash)
-{
-   if (hash->size >= hash->numBuckets)
-      cso_data_rehash(hash, hash->numBits + 1);
+   FREE(old_table);
+   return true;
 }
 
 
-static void
-cso_data_has_shrunk(struct cso_hash *hash)
-{
-   if (hash->size <= (hash->numBuckets >> 3) &&
-       hash->numBits > hash->userNumBits) {
-      int max = MAX(hash->numBits-2, hash->userNumBits);
-      cso_data_rehash(hash,  max);
-   }
-}
-
-
-static struct cso_node *
-cso_data_first_node(struct cso_hash *hash)
+struct cso_hash_iter
+cso_hash_insert(struct cso_hash *hash, unsigned key, void *data)
 {
-   struct cso_node *e = (struct cso_node *)hash;
-   struct cso_node **bucket = hash->buckets;
-   int n = hash->numBuckets;
-
-   while (n--) {
-      if (*bucket != e)
-         return *bucket;
-      ++bucket;
+   struct cso_hash_iter iter = {hash, NULL};
+
+   /* Keep the load including tombstones under 3/4 so probes stay short and
+    * always hit an empty slot.  If it's mostly tombstones, a rehash at the
+    * same size is enough.
+    */
+   if (!hash->table) {
+      if (!cso_hash_rehash(hash, MinNumBits))
+         return iter;
+   } else if ((hash->used + 1) * 4 > (3u << hash->num_bits)) {
+      const unsigned num_bits = (hash->size + 1) * 2 > (1u << hash->num_bits) ?
+                                hash->num_bits + 1 : hash->num_bits;
+      if (!cso_hash_rehash(hash, num_bits))
+         return iter;
    }
-   return e;
-}
 
+   const unsigned mask = (1u << hash->num_bits) - 1;
+   unsigned i = cso_hash_slot(hash, key);
+   while (hash->table[i].state == CSO_NODE_USED)
+      i = (i + 1) & mask;
 
-struct cso_hash_iter
-cso_hash_insert(struct cso_hash *hash, unsigned key, void *data)
-{
-   cso_data_might_grow(hash);
+   struct cso_node *node = &hash->table[i];
+   if (node->state == CSO_NODE_EMPTY)
+      hash->used++;
+   hash->size++;
 
-   struct cso_node **nextNode = cso_hash_find_node(hash, key);
-   struct cso_node *node = cso_hash_create_node(hash, key, data, nextNode);
-   if (!node) {
-      struct cso_hash_iter null_iter = {hash, NULL};
-      return null_iter;
-   }
+   node->key = key;
+   node->value = data;
+   node->state = CSO_NODE_USED;
 
-   struct cso_hash_iter iter = {hash, node};
+   iter.node = node;
    return iter;
 }
 
@@ -198,96 +112,78 @@ cso_hash_insert(struct cso_hash *hash, unsigned key, void *data)
 void
 cso_hash_init(struct cso_hash *hash)
 {
-   hash->fakeNext = NULL;
-   hash->buckets = NULL;
+   hash->table = NULL;
    hash->size = 0;
-   hash->userNumBits = (short)MinNumBits;
-   hash->numBits = 0;
-   hash->numBuckets = 0;
-   hash->end = (struct cso_node*)hash;
+   hash->used = 0;
+   hash->num_bits = 0;
 }
 
 
 void
 cso_hash_deinit(struct cso_hash *hash)
 {
-   struct cso_node *e_for_x = hash->end;
-   struct cso_node **bucket = hash->buckets;
-   int n = hash->numBuckets;
-
-   while (n--) {
-      struct cso_node *cur = *bucket++;
-      while (cur != e_for_x) {
-         struct cso_node *next = cur->next;
-         FREE(cur);
-         cur = next;
-      }
-   }
-   FREE(hash->buckets);
+   FREE(hash->table);
+   hash->table = NULL;
 }
 
 
 unsigned
 cso_hash_iter_key(struct cso_hash_iter iter)
 {
-   if (!iter.node || iter.hash->end == iter.node)
+   if (!iter.node)
       return 0;
    return iter.node->key;
 }
 
 
-struct cso_node *
-cso_hash_data_next(struct cso_node *node)
+static struct cso_hash_iter
+cso_hash_next_used(struct cso_hash *hash, unsigned start)
 {
-   union {
-      struct cso_node *next;
-      struct cso_node *e;
-      struct cso_hash *d;
-   } a;
-
-   a.next = node->next;
-   if (!a.next) {
-      debug_printf("iterating beyond the last element\n");
-      return NULL;
+   const unsigned table_size = hash->table ? 1u << hash->num_bits : 0;
+   struct cso_hash_iter iter = {hash, NULL};
+
+   for (unsigned i = start; i < table_size; i++) {
+      if (hash->table[i].state == CSO_NODE_USED) {
+         iter.node = &hash->table[i];
+         break;
+      }
    }
-   if (a.next->next)
-      return a.next;
-
-   int start = (node->key % a.d->numBuckets) + 1;
-   struct cso_node **bucket = a.d->buckets + start;
-   int n = a.d->numBuckets - start;
-   while (n--) {
-      if (*bucket != a.e)
-         return *bucket;
-      ++bucket;
+   return iter;
+}
+
+
+struct cso_hash_iter
+cso_hash_iter_next(struct cso_hash_iter iter)
+{
+   if (!iter.node) {
+      debug_printf("iterating beyond the last element\n");
+      return iter;
    }
-   return a.e;
+
+   return cso_hash_next_used(iter.hash, iter.node - iter.hash->table + 1);
 }
 
 
 void *
 cso_hash_take(struct cso_hash *hash, unsigned akey)
 {
-   struct cso_node **node = cso_hash_find_node(hash, akey);
-
-   if (*node != hash->end) {
-      void *t = (*node)->value;
-      struct cso_node *next = (*node)->next;
-      FREE(*node);
-      *node = next;
-      --hash->size;
-      cso_data_has_shrunk(hash);
-      return t;
-   }
-   return NULL;
+   struct cso_hash_iter iter = cso_hash_find(hash, akey);
+
+   if (!iter.node)
+      return NULL;
+
+   void *t = iter.node->value;
+   iter.node->value = NULL;
+   iter.node->state = CSO_NODE_DELETED;
+   --hash->size;
+   return t;
 }
 
 
 struct cso_hash_iter
 cso_hash_first_node(struct cso_hash *hash)
 {
-   struct cso_hash_iter iter = {hash, cso_data_first_node(hash)};
-   return iter;
+   return cso_hash_next_used(hash, 0);
 }
 
 
@@ -301,27 +197,21 @@ cso_hash_size(const struct cso_hash *hash)
 struct cso_hash_iter
 cso_hash_erase(struct cso_hash *hash, struct cso_hash_iter iter)
 {
-   struct cso_hash_iter ret = iter;
    struct cso_node *node = iter.node;
-   struct cso_node **node_ptr;
 
-   if (node == hash->end)
+   if (!node)
       return iter;
 
-   ret = cso_hash_iter_next(ret);
-   node_ptr = &hash->buckets[node->key % hash->numBuckets];
-   while (*node_ptr != node)
-      node_ptr = &(*node_ptr)->next;
-   *node_ptr = node->next;
-   FREE(node);
+   node->value = NULL;
+   node->state = CSO_NODE_DELETED;
    --hash->size;
-   return ret;
+
+   return cso_hash_next_used(hash, node - hash->table + 1);
 }
 
 
 bool
 cso_hash_contains(struct cso_hash *hash, unsigned key)
 {
-   struct cso_node **node = cso_hash_find_node(hash, key);
-   return *node != hash->end;
+   return !cso_hash_iter_is_null(cso_hash_find(hash, key));
 }
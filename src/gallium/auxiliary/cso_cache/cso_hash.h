@@ -29,14 +29,16 @@
  * @file
  * Hash table implementation.
  *
- * This file provides a hash implementation that is capable of dealing
- * with collisions. It stores colliding entries in linked list. All
- * functions operating on the hash return an iterator. The iterator
- * itself points to the collision list. If there wasn't any collision
- * the list will have just one entry, otherwise client code should
- * iterate over the entries to find the exact entry among ones that
- * had the same key (e.g. memcmp could be used on the data to check
- * that)
+ * This is an open-addressed table with linear probing, keyed on a
+ * precomputed 32-bit hash.  Several entries may share a key; all of them
+ * lie on the probe sequence of that key, so client code looks up the
+ * first one with cso_hash_find() and walks the others with
+ * cso_hash_find_next() to find the exact entry (e.g. with memcmp on the
+ * data).
+ *
+ * Removed entries are left as tombstones until the next rehash, so
+ * erasing while iterating with cso_hash_iter_next() never moves entries
+ * that have not been visited yet.
  *
  * @author Zack Rusin <zackr@vmware.com>
  */
@@ -51,10 +53,16 @@ extern "C" {
 #endif
 
 
+enum cso_node_state {
+   CSO_NODE_EMPTY = 0,
+   CSO_NODE_USED,
+   CSO_NODE_DELETED,
+};
+
 struct cso_node {
-   struct cso_node *next;
    void *value;
    unsigned key;
+   uint8_t state;
 };
 
 struct cso_hash_iter {
@@ -63,13 +71,12 @@ struct cso_hash_iter {
 };
 
 struct cso_hash {
-   struct cso_node *fakeNext;
-   struct cso_node **buckets;
-   struct cso_node *end;
+   struct cso_node *table;
+   /** Number of live entries. */
    int size;
-   short userNumBits;
-   short numBits;
-   int numBuckets;
+   /** Number of live entries plus tombstones. */
+   unsigned used;
+   unsigned num_bits;
 };
 
 
@@ -84,9 +91,8 @@ cso_hash_size(const struct cso_hash *hash);
 
 
 /**
- * Adds a data with the given key to the hash. If entry with the given
- * key is already in the hash, this current entry is instered before it
- * in the collision list.
+ * Adds a data with the given key to the hash. Entries already in the hash
+ * with the same key are kept.
  * Function returns iterator pointing to the inserted item in the hash.
  */
 struct cso_hash_iter
@@ -120,9 +126,9 @@ cso_hash_iter_key(struct cso_hash_iter iter);
 
 
 /**
- * Convenience routine to iterate over the collision list while doing a memory
- * comparison to see which entry in the list is a direct copy of our template
- * and returns that entry.
+ * Convenience routine to walk the entries with the given key while doing a
+ * memory comparison to see which one is a direct copy of our template and
+ * returns that entry.
  */
 void *
 cso_hash_find_data_from_template(struct cso_hash *hash,
@@ -130,62 +136,92 @@ cso_hash_find_data_from_template(struct cso_hash *hash,
                                  void *templ,
                                  int size);
 
-struct cso_node *
-cso_hash_data_next(struct cso_node *node);
-
 
 static inline bool
 cso_hash_iter_is_null(struct cso_hash_iter iter)
 {
-   return !iter.node || iter.node == iter.hash->end;
+   return !iter.node;
 }
 
 
 static inline void *
 cso_hash_iter_data(struct cso_hash_iter iter)
 {
-   if (!iter.node || iter.hash->end == iter.node)
+   if (!iter.node)
       return NULL;
    return iter.node->value;
 }
 
 
-static inline struct cso_node **
-cso_hash_find_node(struct cso_hash *hash, unsigned akey)
+/**
+ * Home slot of \p key.  cso_construct_key() is a plain XOR of the state, so
+ * multiply it to spread its entropy into the top bits used as the index.
+ */
+static inline unsigned
+cso_hash_slot(const struct cso_hash *hash, unsigned key)
+{
+   return (key * 0x9e3779b1u) >> (32 - hash->num_bits);
+}
+
+
+/**
+ * Return an iterator pointing to the first entry with the given key from
+ * \p start on in its probe sequence.
+ */
+static inline struct cso_hash_iter
+cso_hash_probe(struct cso_hash *hash, unsigned start, unsigned key)
 {
-   struct cso_node **node;
-
-   if (hash->numBuckets) {
-      node = &hash->buckets[akey % hash->numBuckets];
-      assert(*node == hash->end || (*node)->next);
-      while (*node != hash->end && (*node)->key != akey)
-         node = &(*node)->next;
-   } else {
-      node = &hash->end;
+   const unsigned mask = (1u << hash->num_bits) - 1;
+   struct cso_hash_iter iter = {hash, NULL};
+
+   for (unsigned i = start & mask;; i = (i + 1) & mask) {
+      struct cso_node *node = &hash->table[i];
+
+      if (node->state == CSO_NODE_EMPTY)
+         return iter;
+
+      if (node->state == CSO_NODE_USED && node->key == key) {
+         iter.node = node;
+         return iter;
+      }
    }
-   return node;
 }
 
 
 /**
- * Return an iterator pointing to the first entry in the collision list.
+ * Return an iterator pointing to the first entry with the given key.
  */
 static inline struct cso_hash_iter
 cso_hash_find(struct cso_hash *hash, unsigned key)
 {
-   struct cso_node **nextNode = cso_hash_find_node(hash, key);
-   struct cso_hash_iter iter = {hash, *nextNode};
-   return iter;
+   if (!hash->table) {
+      struct cso_hash_iter iter = {hash, NULL};
+      return iter;
+   }
+
+   return cso_hash_probe(hash, cso_hash_slot(hash, key), key);
 }
 
 
+/**
+ * Return an iterator pointing to the next entry with the same key as
+ * \p iter.
+ */
 static inline struct cso_hash_iter
-cso_hash_iter_next(struct cso_hash_iter iter)
+cso_hash_find_next(struct cso_hash_iter iter)
 {
-   struct cso_hash_iter next = {iter.hash, cso_hash_data_next(iter.node)};
-   return next;
+   return cso_hash_probe(iter.hash, iter.node - iter.hash->table + 1,
+                         iter.node->key);
 }
 
+
+/**
+ * Return an iterator pointing to the next entry of the whole hash, in no
+ * particular order.
+ */
+struct cso_hash_iter
+cso_hash_iter_next(struct cso_hash_iter iter);
+
 #ifdef __cplusplus
 }
 #endif
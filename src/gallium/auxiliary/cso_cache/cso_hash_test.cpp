@@ -0,0 +1,252 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "cso_hash.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+/* Runs random operations on a cso_hash and on a std::multimap holding the
+ * same entries, and checks that the two always agree.  Values are unique
+ * non-NULL ids, so each entry can be told apart from the others with the
+ * same key.
+ */
+class cso_hash_test : public ::testing::Test {
+protected:
+   cso_hash_test();
+   ~cso_hash_test() override;
+
+   void insert(unsigned key);
+   void take(unsigned key);
+   void erase(unsigned key);
+   void check_key(unsigned key);
+   void erase_while_iterating(unsigned modulo);
+   void check_all();
+
+   static void *value(uintptr_t id) { return (void *)id; }
+   static uintptr_t id(void *value) { return (uintptr_t)value; }
+
+   struct cso_hash hash;
+   std::multimap<unsigned, uintptr_t> model;
+   std::mt19937 rng;
+   uintptr_t next_id;
+};
+
+cso_hash_test::cso_hash_test()
+   : rng(4359025), next_id(1)
+{
+   cso_hash_init(&hash);
+}
+
+cso_hash_test::~cso_hash_test()
+{
+   cso_hash_deinit(&hash);
+}
+
+void
+cso_hash_test::insert(unsigned key)
+{
+   const uintptr_t v = next_id++;
+   struct cso_hash_iter iter = cso_hash_insert(&hash, key, value(v));
+
+   ASSERT_FALSE(cso_hash_iter_is_null(iter));
+   EXPECT_EQ(cso_hash_iter_key(iter), key);
+   EXPECT_EQ(id(cso_hash_iter_data(iter)), v);
+   model.emplace(key, v);
+}
+
+void
+cso_hash_test::take(unsigned key)
+{
+   void *taken = cso_hash_take(&hash, key);
+   auto range = model.equal_range(key);
+
+   if (range.first == range.second) {
+      EXPECT_EQ(taken, nullptr) << "key " << key;
+      return;
+   }
+
+   /* Any of the entries with the key may be taken. */
+   auto it = std::find_if(range.first, range.second,
+                          [&](const auto &e) { return e.second == id(taken); });
+   ASSERT_NE(it, range.second) << "key " << key;
+   model.erase(it);
+}
+
+/**
+ * Erase the first entry with a key not below \p key, or the first entry
+ * if there is none.
+ */
+void
+cso_hash_test::erase(unsigned key)
+{
+   if (model.empty())
+      return;
+
+   auto entry = model.lower_bound(key);
+   if (entry == model.end())
+      entry = model.begin();
+
+   struct cso_hash_iter iter = cso_hash_find(&hash, entry->first);
+
+   /* Walk the entries with the key to find the exact one, as
+    * cso_find_state_template() does.
+    */
+   while (!cso_hash_iter_is_null(iter) &&
+          id(cso_hash_iter_data(iter)) != entry->second)
+      iter = cso_hash_find_next(iter);
+
+   ASSERT_FALSE(cso_hash_iter_is_null(iter)) << "key " << entry->first;
+   cso_hash_erase(&hash, iter);
+   model.erase(entry);
+}
+
+void
+cso_hash_test::check_key(unsigned key)
+{
+   std::vector<uintptr_t> found, expected;
+
+   for (struct cso_hash_iter iter = cso_hash_find(&hash, key);
+        !cso_hash_iter_is_null(iter); iter = cso_hash_find_next(iter)) {
+      EXPECT_EQ(cso_hash_iter_key(iter), key);
+      found.push_back(id(cso_hash_iter_data(iter)));
+   }
+
+   auto range = model.equal_range(key);
+   for (auto it = range.first; it != range.second; ++it)
+      expected.push_back(it->second);
+
+   std::sort(found.begin(), found.end());
+   std::sort(expected.begin(), expected.end());
+   EXPECT_EQ(found, expected) << "key " << key;
+   EXPECT_EQ(cso_hash_contains(&hash, key), !expected.empty()) << "key " << key;
+}
+
+/**
+ * Erase every entry whose id is a multiple of \p modulo during a single
+ * iteration, which must still visit every entry exactly once.
+ */
+void
+cso_hash_test::erase_while_iterating(unsigned modulo)
+{
+   std::vector<uintptr_t> visited;
+   struct cso_hash_iter iter = cso_hash_first_node(&hash);
+
+   while (!cso_hash_iter_is_null(iter)) {
+      const uintptr_t v = id(cso_hash_iter_data(iter));
+
+      visited.push_back(v);
+      if (v % modulo == 0)
+         iter = cso_hash_erase(&hash, iter);
+      else
+         iter = cso_hash_iter_next(iter);
+   }
+
+   std::vector<uintptr_t> expected;
+   for (const auto &e : model)
+      expected.push_back(e.second);
+
+   std::sort(visited.begin(), visited.end());
+   std::sort(expected.begin(), expected.end());
+   ASSERT_EQ(visited, expected);
+
+   for (auto it = model.begin(); it != model.end();) {
+      if (it->second % modulo == 0)
+         it = model.erase(it);
+      else
+         ++it;
+   }
+}
+
+void
+cso_hash_test::check_all()
+{
+   std::multimap<unsigned, uintptr_t> entries;
+
+   for (struct cso_hash_iter iter = cso_hash_first_node(&hash);
+        !cso_hash_iter_is_null(iter); iter = cso_hash_iter_next(iter))
+      entries.emplace(cso_hash_iter_key(iter), id(cso_hash_iter_data(iter)));
+
+   ASSERT_EQ(cso_hash_size(&hash), (int)model.size());
+
+   /* Multimap equality depends on the order of equal keys. */
+   std::vector<std::pair<unsigned, uintptr_t>> a(entries.begin(), entries.end());
+   std::vector<std::pair<unsigned, uintptr_t>> b(model.begin(), model.end());
+   std::sort(a.begin(), a.end());
+   std::sort(b.begin(), b.end());
+   ASSERT_EQ(a, b);
+}
+
+} // namespace
+
+TEST_F(cso_hash_test, empty)
+{
+   EXPECT_EQ(cso_hash_size(&hash), 0);
+   EXPECT_TRUE(cso_hash_iter_is_null(cso_hash_first_node(&hash)));
+   EXPECT_TRUE(cso_hash_iter_is_null(cso_hash_find(&hash, 0)));
+   EXPECT_FALSE(cso_hash_contains(&hash, 0));
+   EXPECT_EQ(cso_hash_take(&hash, 0), nullptr);
+}
+
+TEST_F(cso_hash_test, duplicate_keys)
+{
+   for (unsigned i = 0; i < 100; i++)
+      insert(i % 3);
+   check_all();
+
+   for (unsigned key = 0; key < 4; key++)
+      check_key(key);
+
+   while (!model.empty())
+      take(rng() % 3);
+   check_all();
+}
+
+TEST_F(cso_hash_test, random_operations)
+{
+   const unsigned num_ops = 400000;
+
+   for (unsigned i = 0; i < num_ops; i++) {
+      /* Alternate between few keys, with many duplicates, and many keys.
+       * Every fourth phase removes more entries than it inserts, so the
+       * table also shrinks and collects tombstones.
+       */
+      const unsigned phase = i / 20000;
+      const unsigned key_range = phase % 2 ? 1u << (phase % 20) : 16;
+      const unsigned key = rng() % key_range;
+      const unsigned op = rng() % 100;
+      const unsigned num_inserts = phase % 4 == 3 ? 30 : 45;
+
+      if (op < num_inserts)
+         insert(key);
+      else if (op < 60)
+         take(key);
+      else if (op < 80)
+         erase(key);
+      else
+         check_key(key);
+
+      if (rng() % 5000 == 0)
+         erase_while_iterating(rng() % 4 + 2);
+
+      if (i % 10000 == 0)
+         check_all();
+
+      if (HasFatalFailure())
+         return;
+   }
+
+   check_all();
+
+   /* Erase everything while iterating. */
+   erase_while_iterating(1);
+   EXPECT_TRUE(model.empty());
+   check_all();
+}
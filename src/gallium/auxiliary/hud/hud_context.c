@@ -1324,6 +1324,15 @@ hud_parse_env_var(struct hud_context *hud, struct pipe_screen *screen,
       else if (strcmp(name, "main-thread-busy") == 0) {
          hud_thread_busy_install(pane, name, true);
       }
+      else if (strcmp(name, "tc-sync-stall") == 0) {
+         hud_tc_counter_install(pane, name, HUD_COUNTER_TC_SYNC_STALL);
+      }
+      else if (strcmp(name, "tc-batch-fill") == 0) {
+         hud_tc_counter_install(pane, name, HUD_COUNTER_TC_BATCH_FILL);
+      }
+      else if (strcmp(name, "tc-calls") == 0) {
+         hud_tc_counter_install(pane, name, HUD_COUNTER_TC_CALLS);
+      }
 #ifdef HAVE_GALLIUM_EXTRA_HUD
       else if (sscanf(name, "nic-rx-%s", arg_name) == 1) {
          hud_nic_graph_install(pane, arg_name, NIC_DIRECTION_RX);
@@ -1640,6 +1649,10 @@ print_help(struct pipe_screen *screen)
    for (i = 0; i < num_cpus; i++)
       printf("    cpu%i\n", i);
 
+   puts("    tc-sync-stall (% of time the threaded context stalled in syncs)");
+   puts("    tc-batch-fill (average % of threaded context batch slots used)");
+   puts("    tc-calls (number of calls recorded by the threaded context)");
+
    if (has_occlusion_query(screen))
       puts("    samples-passed");
    if (has_streamout(screen))
@@ -33,6 +33,7 @@
 #include "util/u_thread.h"
 #include "util/u_memory.h"
 #include "util/u_queue.h"
+#include "util/u_threaded_context.h"
 #include <stdio.h>
 #include <inttypes.h>
 #if DETECT_OS_WINDOWS
@@ -474,3 +475,103 @@ void hud_thread_counter_install(struct hud_pane *pane, const char *name,
    hud_pane_add_graph(pane, gr);
    hud_pane_set_max_value(pane, 100);
 }
+
+struct tc_counter_info {
+   enum hud_counter counter;
+   int64_t last_time;
+   uint64_t last_value;
+   uint64_t last_batches;
+};
+
+static uint64_t
+get_tc_counter(const struct tc_stats *stats, enum hud_counter counter)
+{
+   uint64_t value = 0;
+
+   switch (counter) {
+   case HUD_COUNTER_TC_SYNC_STALL:
+      return stats->sync_stall_ns;
+   case HUD_COUNTER_TC_BATCH_FILL:
+      return stats->num_flushed_slots;
+   case HUD_COUNTER_TC_CALLS:
+      for (unsigned i = 0; i < TC_NUM_CALLS; i++)
+         value += stats->calls[i].count;
+      return value;
+   default:
+      assert(0);
+      return 0;
+   }
+}
+
+static void
+query_tc_counter(struct hud_graph *gr, struct pipe_context *pipe)
+{
+   struct tc_counter_info *info = gr->query_data;
+   struct threaded_context *tc = threaded_context_from_pipe(pipe);
+   int64_t now = os_time_get_nano();
+
+   if (!tc)
+      return;
+
+   uint64_t value = get_tc_counter(&tc->stats, info->counter);
+   uint64_t batches = tc->stats.num_flushed_batches;
+
+   if (info->last_time) {
+      if (info->last_time + gr->pane->period*1000 <= now) {
+         uint64_t delta = value - info->last_value;
+
+         switch (info->counter) {
+         case HUD_COUNTER_TC_SYNC_STALL:
+            /* percentage of the time the recording thread was stalled */
+            hud_graph_add_value(gr, delta * 100.0 / (now - info->last_time));
+            break;
+         case HUD_COUNTER_TC_BATCH_FILL:
+            /* average fill level of the batches flushed in this period */
+            hud_graph_add_value(gr, batches == info->last_batches ? 0.0 :
+                                delta * 100.0 / ((batches - info->last_batches) *
+                                                 TC_SLOTS_PER_BATCH));
+            break;
+         default:
+            hud_graph_add_value(gr, delta);
+            break;
+         }
+
+         info->last_time = now;
+         info->last_value = value;
+         info->last_batches = batches;
+      }
+   } else {
+      /* initialize */
+      info->last_time = now;
+      info->last_value = value;
+      info->last_batches = batches;
+   }
+}
+
+void hud_tc_counter_install(struct hud_pane *pane, const char *name,
+                            enum hud_counter counter)
+{
+   struct hud_graph *gr = CALLOC_STRUCT(hud_graph);
+   if (!gr)
+      return;
+
+   strcpy(gr->name, name);
+
+   gr->query_data = CALLOC_STRUCT(tc_counter_info);
+   if (!gr->query_data) {
+      FREE(gr);
+      return;
+   }
+
+   ((struct tc_counter_info*)gr->query_data)->counter = counter;
+   gr->query_new_value = query_tc_counter;
+
+   /* Don't use free() as our callback as that messes up Gallium's
+    * memory debugger.  Use simple free_query_data() wrapper.
+    */
+   gr->free_query_data = free_query_data;
+
+   hud_pane_add_graph(pane, gr);
+   if (counter != HUD_COUNTER_TC_CALLS)
+      hud_pane_set_max_value(pane, 100);
+}
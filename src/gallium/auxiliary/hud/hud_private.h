@@ -40,6 +40,9 @@ enum hud_counter {
    HUD_COUNTER_DIRECT,
    HUD_COUNTER_SYNCS,
    HUD_COUNTER_BATCHES,
+   HUD_COUNTER_TC_SYNC_STALL,
+   HUD_COUNTER_TC_BATCH_FILL,
+   HUD_COUNTER_TC_CALLS,
 };
 
 struct hud_context {
@@ -172,6 +175,8 @@ void hud_cpu_graph_install(struct hud_pane *pane, unsigned cpu_index);
 void hud_thread_busy_install(struct hud_pane *pane, const char *name, bool main);
 void hud_thread_counter_install(struct hud_pane *pane, const char *name,
                                 enum hud_counter counter);
+void hud_tc_counter_install(struct hud_pane *pane, const char *name,
+                            enum hud_counter counter);
 void hud_pipe_query_install(struct hud_batch_query_context **pbq,
                             struct hud_pane *pane,
                             const char *name,
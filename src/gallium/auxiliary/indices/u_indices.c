@@ -24,6 +24,7 @@
 
 #include "u_indices.h"
 #include "u_indices_priv.h"
+#include "util/u_cpu_detect.h"
 
 static void translate_byte_to_ushort( const void *in,
                                       unsigned start,
@@ -39,6 +40,29 @@ static void translate_byte_to_ushort( const void *in,
    }
 }
 
+static u_translate_func translate_byte_to_ushort_func = translate_byte_to_ushort;
+
+#if defined(USE_AVX2) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64)
+/* The generated translators the SIMD ones replaced, for testing. */
+static u_translate_func translate_generic[IN_COUNT][OUT_COUNT][PV_COUNT][PV_COUNT][PR_COUNT][PRIM_COUNT];
+#endif
+
+/**
+ * Replace some of the generated translators with SIMD versions when the
+ * CPU supports them.  Called at the end of u_index_init().
+ */
+static void
+u_index_init_simd(void)
+{
+#if defined(USE_AVX2) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64)
+   if (util_get_cpu_caps()->has_avx2) {
+      memcpy(translate_generic, translate, sizeof(translate));
+      u_index_init_avx2(translate);
+      translate_byte_to_ushort_func = u_index_translate_byte_to_ushort_avx2;
+   }
+#endif
+}
+
 enum mesa_prim
 u_index_prim_type_convert(unsigned hw_mask, enum mesa_prim prim, bool pv_matches)
 {
@@ -137,7 +161,7 @@ u_index_translator(unsigned hw_mask,
       else if (in_index_size == 2)
          *out_translate = translate_memcpy_ushort;
       else
-         *out_translate = translate_byte_to_ushort;
+         *out_translate = translate_byte_to_ushort_func;
 
       *out_prim = prim;
       *out_nr = nr;
@@ -152,6 +176,30 @@ u_index_translator(unsigned hw_mask,
    return ret;
 }
 
+/**
+ * Return an entry of the translate table, or the generated function it
+ * replaced when \p simd is false.  Lets tests compare the SIMD translators
+ * with the generated ones.
+ */
+u_translate_func
+u_index_lookup_translate(unsigned in_idx,
+                         unsigned out_idx,
+                         unsigned in_pv,
+                         unsigned out_pv,
+                         unsigned prim_restart,
+                         enum mesa_prim prim,
+                         bool simd)
+{
+   u_index_init();
+
+#if defined(USE_AVX2) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64)
+   if (!simd && util_get_cpu_caps()->has_avx2)
+      return translate_generic[in_idx][out_idx][in_pv][out_pv][prim_restart][prim];
+#endif
+
+   return translate[in_idx][out_idx][in_pv][out_pv][prim_restart][prim];
+}
+
 unsigned
 u_index_count_converted_indices(unsigned hw_mask, bool pv_matches, enum mesa_prim prim, unsigned nr)
 {
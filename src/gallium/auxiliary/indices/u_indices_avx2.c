@@ -0,0 +1,421 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file
+ * AVX2 versions of the u_indices_gen.c translators that convert quads,
+ * quad strips, triangle fans and polygons to triangles with primitive
+ * restart, plus the 8 to 16-bit widening copy.  Without restart the
+ * generated loops are simple enough for the compiler to do as well.
+ *
+ * Every conversion emits 24 output indices per block, i.e. 4 quads or
+ * 8 fan triangles.  The block's inputs are loaded into two 8-wide registers
+ * and the outputs are permutes and blends of those and the fan's first
+ * vertex.  The permutes are built at init time from the same primitive
+ * decompositions u_indices_gen.py uses.  Blocks containing the restart
+ * index and the leftover primitives go through a scalar copy of the
+ * generated code, so the output is identical.
+ */
+
+#include "u_indices_priv.h"
+
+#if defined(USE_AVX2) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64)
+
+#include <immintrin.h>
+
+/** Source of an output index that is the fan/polygon's first vertex. */
+#define CENTER -1
+
+enum avx2_prim {
+   AVX2_QUADS,
+   AVX2_QUADSTRIP,
+   AVX2_TRIFAN,
+   AVX2_POLYGON,
+   AVX2_PRIM_COUNT,
+};
+
+struct avx2_pattern {
+   /** Output of one primitive: input offsets from its first vertex. */
+   int8_t prim[6];
+   unsigned out_per_prim;
+   /** Input indices between consecutive primitives. */
+   unsigned prim_stride;
+   /** Input indices checked for the restart index per primitive. */
+   unsigned prim_verts;
+   bool fan;
+
+   /** Input offsets loaded into the two block registers. */
+   unsigned reg_offset[2];
+   /** Input indices checked for the restart index per block. */
+   unsigned block_window;
+   unsigned block_in;
+
+   /* For each of the three output vectors of a block, the lanes to take
+    * from each register and the blend masks selecting register 1 and the
+    * center.
+    */
+   alignas(32) int32_t idx[3][2][8];
+   alignas(32) int32_t sel1[3][8];
+   alignas(32) int32_t sel_center[3][8];
+};
+
+static struct avx2_pattern patterns[AVX2_PRIM_COUNT][PV_COUNT][PV_COUNT];
+
+/* Mirrors do_tri() and do_quad() in u_indices_gen.py. */
+static void
+pattern_tri(int8_t *dst, int v0, int v1, int v2,
+            unsigned in_pv, unsigned out_pv)
+{
+   if (in_pv == out_pv) {
+      dst[0] = v0; dst[1] = v1; dst[2] = v2;
+   } else if (in_pv == PV_FIRST) {
+      dst[0] = v1; dst[1] = v2; dst[2] = v0;
+   } else {
+      dst[0] = v2; dst[1] = v0; dst[2] = v1;
+   }
+}
+
+static void
+pattern_quad(int8_t *dst, int v0, int v1, int v2, int v3,
+             unsigned in_pv, unsigned out_pv)
+{
+   if (in_pv == PV_LAST) {
+      pattern_tri(dst + 0, v0, v1, v3, in_pv, out_pv);
+      pattern_tri(dst + 3, v1, v2, v3, in_pv, out_pv);
+   } else {
+      pattern_tri(dst + 0, v0, v1, v2, in_pv, out_pv);
+      pattern_tri(dst + 3, v0, v2, v3, in_pv, out_pv);
+   }
+}
+
+static void
+init_pattern(struct avx2_pattern *p, enum avx2_prim prim,
+             unsigned in_pv, unsigned out_pv)
+{
+   switch (prim) {
+   case AVX2_QUADS:
+      pattern_quad(p->prim, 0, 1, 2, 3, in_pv, out_pv);
+      p->out_per_prim = 6;
+      p->prim_stride = 4;
+      p->prim_verts = 4;
+      p->reg_offset[0] = 0;
+      p->reg_offset[1] = 8;
+      p->block_window = 16;
+      break;
+   case AVX2_QUADSTRIP:
+      if (in_pv == PV_LAST)
+         pattern_quad(p->prim, 2, 0, 1, 3, in_pv, out_pv);
+      else
+         pattern_quad(p->prim, 0, 1, 3, 2, in_pv, out_pv);
+      p->out_per_prim = 6;
+      p->prim_stride = 2;
+      p->prim_verts = 4;
+      p->reg_offset[0] = 0;
+      p->reg_offset[1] = 2;
+      p->block_window = 10;
+      break;
+   case AVX2_TRIFAN:
+   case AVX2_POLYGON:
+      if ((prim == AVX2_TRIFAN) == (in_pv == PV_FIRST))
+         pattern_tri(p->prim, 1, 2, CENTER, in_pv, out_pv);
+      else
+         pattern_tri(p->prim, CENTER, 1, 2, in_pv, out_pv);
+      p->out_per_prim = 3;
+      p->prim_stride = 1;
+      p->prim_verts = 3;
+      p->fan = true;
+      /* in[i] is only read for the restart check, done separately. */
+      p->reg_offset[0] = 1;
+      p->reg_offset[1] = 2;
+      p->block_window = 10;
+      break;
+   default:
+      unreachable("bad primitive");
+   }
+
+   p->block_in = 24 / p->out_per_prim * p->prim_stride;
+
+   for (unsigned k = 0; k < 24; k++) {
+      const unsigned v = k / 8, lane = k % 8;
+      const int src = p->prim[k % p->out_per_prim];
+      const int offset = k / p->out_per_prim * p->prim_stride + src;
+
+      p->idx[v][0][lane] = 0;
+      p->idx[v][1][lane] = 0;
+      p->sel1[v][lane] = 0;
+      p->sel_center[v][lane] = 0;
+
+      if (src == CENTER) {
+         p->sel_center[v][lane] = -1;
+      } else if (offset - (int)p->reg_offset[0] < 8) {
+         p->idx[v][0][lane] = offset - p->reg_offset[0];
+      } else {
+         p->idx[v][1][lane] = offset - p->reg_offset[1];
+         p->sel1[v][lane] = -1;
+      }
+   }
+}
+
+static ALWAYS_INLINE unsigned
+load_index(const void *in, unsigned i, unsigned in_size)
+{
+   switch (in_size) {
+   case 1: return ((const uint8_t *)in)[i];
+   case 2: return ((const uint16_t *)in)[i];
+   default: return ((const uint32_t *)in)[i];
+   }
+}
+
+static ALWAYS_INLINE void
+store_index(void *out, unsigned j, unsigned v, unsigned out_size)
+{
+   if (out_size == 2)
+      ((uint16_t *)out)[j] = v;
+   else
+      ((uint32_t *)out)[j] = v;
+}
+
+/** Load in[i..i+7] widened to 32 bits. */
+static ALWAYS_INLINE __m256i
+load_indices(const void *in, unsigned i, unsigned in_size)
+{
+   switch (in_size) {
+   case 1:
+      return _mm256_cvtepu8_epi32(
+         _mm_loadl_epi64((const __m128i *)((const uint8_t *)in + i)));
+   case 2:
+      return _mm256_cvtepu16_epi32(
+         _mm_loadu_si128((const __m128i *)((const uint16_t *)in + i)));
+   default:
+      return _mm256_loadu_si256((const __m256i *)((const uint32_t *)in + i));
+   }
+}
+
+/** Store eight indices to out[j..j+7], truncating like a C cast. */
+static ALWAYS_INLINE void
+store_indices(void *out, unsigned j, __m256i v, unsigned out_size)
+{
+   if (out_size == 2) {
+      const __m256i low_halves =
+         _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                          0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+      v = _mm256_shuffle_epi8(v, low_halves);
+      v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+      _mm_storeu_si128((__m128i *)((uint16_t *)out + j),
+                       _mm256_castsi256_si128(v));
+   } else {
+      _mm256_storeu_si256((__m256i *)((uint32_t *)out + j), v);
+   }
+}
+
+/**
+ * A pattern's block shuffle, loaded into registers once per call: the
+ * output stores could otherwise alias the pattern table.
+ */
+struct avx2_shuffle {
+   __m256i idx[3][2];
+   __m256i sel1[3];
+   __m256i sel_center[3];
+};
+
+static ALWAYS_INLINE void
+load_shuffle(struct avx2_shuffle *s, const struct avx2_pattern *p)
+{
+   for (unsigned v = 0; v < 3; v++) {
+      s->idx[v][0] = _mm256_load_si256((const __m256i *)p->idx[v][0]);
+      s->idx[v][1] = _mm256_load_si256((const __m256i *)p->idx[v][1]);
+      s->sel1[v] = _mm256_load_si256((const __m256i *)p->sel1[v]);
+      s->sel_center[v] = _mm256_load_si256((const __m256i *)p->sel_center[v]);
+   }
+}
+
+static ALWAYS_INLINE void
+emit_block(const struct avx2_shuffle *s, bool fan, __m256i r0, __m256i r1,
+           __m256i center, void *out, unsigned j, unsigned out_size)
+{
+   for (unsigned v = 0; v < 3; v++) {
+      const __m256i a = _mm256_permutevar8x32_epi32(r0, s->idx[v][0]);
+      const __m256i b = _mm256_permutevar8x32_epi32(r1, s->idx[v][1]);
+      __m256i res = _mm256_blendv_epi8(a, b, s->sel1[v]);
+
+      if (fan)
+         res = _mm256_blendv_epi8(res, center, s->sel_center[v]);
+      store_indices(out, j + v * 8, res, out_size);
+   }
+}
+
+static ALWAYS_INLINE void
+translate_kernel(const struct avx2_pattern *p, const void *in,
+                 unsigned start, unsigned in_nr, unsigned out_nr,
+                 unsigned restart_index, void *out,
+                 unsigned in_size, unsigned out_size)
+{
+   const __m256i restart = _mm256_set1_epi32(restart_index);
+   const unsigned reg0 = p->reg_offset[0], reg1 = p->reg_offset[1];
+   const unsigned block_in = p->block_in, block_window = p->block_window;
+   const bool fan = p->fan;
+   struct avx2_shuffle shuffle;
+   unsigned i = start, j = 0;
+
+   load_shuffle(&shuffle, p);
+
+   while (j < out_nr) {
+      if (j + 24 <= out_nr && i + block_window <= in_nr) {
+         const __m256i r0 = load_indices(in, i + reg0, in_size);
+         const __m256i r1 = load_indices(in, i + reg1, in_size);
+         const __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi32(r0, restart),
+                                            _mm256_cmpeq_epi32(r1, restart));
+
+         if (_mm256_testz_si256(eq, eq) &&
+             !(fan && load_index(in, i, in_size) == restart_index)) {
+            const __m256i center = fan ?
+               _mm256_set1_epi32(load_index(in, start, in_size)) :
+               _mm256_setzero_si256();
+
+            emit_block(&shuffle, fan, r0, r1, center, out, j, out_size);
+            i += block_in;
+            j += 24;
+            continue;
+         }
+      }
+
+      /* A single primitive, exactly as u_indices_gen.py does it. */
+restart:
+      if (i + p->prim_verts > in_nr) {
+         for (unsigned k = 0; k < p->out_per_prim; k++)
+            store_index(out, j + k, restart_index, out_size);
+         i += p->prim_stride;
+         j += p->out_per_prim;
+         continue;
+      }
+      for (unsigned k = 0; k < p->prim_verts; k++) {
+         if (load_index(in, i + k, in_size) == restart_index) {
+            i += k + 1;
+            if (fan)
+               start = i;
+            goto restart;
+         }
+      }
+
+      for (unsigned k = 0; k < p->out_per_prim; k++) {
+         const int src = p->prim[k];
+         store_index(out, j + k,
+                     load_index(in, src == CENTER ? start : i + src, in_size),
+                     out_size);
+      }
+      i += p->prim_stride;
+      j += p->out_per_prim;
+   }
+}
+
+/* The kernels are specialized on the index sizes; the primitive and
+ * provoking vertex conventions come from the pattern.
+ */
+#define TRANSLATE_KERNEL(IN, OUT)                                             \
+static void                                                                   \
+translate_##IN##_##OUT(const struct avx2_pattern *p, const void *in,          \
+                       unsigned start, unsigned in_nr, unsigned out_nr,       \
+                       unsigned restart_index, void *out)                     \
+{                                                                             \
+   translate_kernel(p, in, start, in_nr, out_nr, restart_index, out,          \
+                    IN, OUT);                                                 \
+}
+
+TRANSLATE_KERNEL(1, 2)
+TRANSLATE_KERNEL(1, 4)
+TRANSLATE_KERNEL(2, 2)
+TRANSLATE_KERNEL(2, 4)
+TRANSLATE_KERNEL(4, 2)
+TRANSLATE_KERNEL(4, 4)
+
+/* u_translate_func has no user data, so each table entry is a wrapper
+ * binding a kernel to its pattern.
+ */
+#define TRANSLATE_ENTRY(PRIM, INPV, OUTPV, IN, OUT)                           \
+static void                                                                   \
+translate_##PRIM##_##INPV##_##OUTPV##_##IN##_##OUT(                           \
+   const void *in, unsigned start, unsigned in_nr, unsigned out_nr,           \
+   unsigned restart_index, void *out)                                         \
+{                                                                             \
+   translate_##IN##_##OUT(&patterns[PRIM][PV_##INPV][PV_##OUTPV], in, start,  \
+                          in_nr, out_nr, restart_index, out);                 \
+}
+
+#define SET_ENTRY(PRIM, INPV, OUTPV, IN, OUT, IN_IDX, OUT_IDX)                \
+   translate[IN_IDX][OUT_IDX][PV_##INPV][PV_##OUTPV][PR_ENABLE][mode] =       \
+      translate_##PRIM##_##INPV##_##OUTPV##_##IN##_##OUT
+
+#define ENTRIES(PRIM, INPV, OUTPV)                                            \
+   TRANSLATE_ENTRY(PRIM, INPV, OUTPV, 1, 2)                                   \
+   TRANSLATE_ENTRY(PRIM, INPV, OUTPV, 1, 4)                                   \
+   TRANSLATE_ENTRY(PRIM, INPV, OUTPV, 2, 2)                                   \
+   TRANSLATE_ENTRY(PRIM, INPV, OUTPV, 2, 4)                                   \
+   TRANSLATE_ENTRY(PRIM, INPV, OUTPV, 4, 2)                                   \
+   TRANSLATE_ENTRY(PRIM, INPV, OUTPV, 4, 4)                                   \
+                                                                              \
+static void                                                                   \
+init_##PRIM##_##INPV##_##OUTPV(                                               \
+   u_translate_func translate[IN_COUNT][OUT_COUNT][PV_COUNT][PV_COUNT][PR_COUNT][PRIM_COUNT], \
+   enum mesa_prim mode)                                                       \
+{                                                                             \
+   init_pattern(&patterns[PRIM][PV_##INPV][PV_##OUTPV], PRIM,                 \
+                PV_##INPV, PV_##OUTPV);                                       \
+                                                                              \
+   SET_ENTRY(PRIM, INPV, OUTPV, 1, 2, IN_UINT8, OUT_UINT16);                  \
+   SET_ENTRY(PRIM, INPV, OUTPV, 1, 4, IN_UINT8, OUT_UINT32);                  \
+   SET_ENTRY(PRIM, INPV, OUTPV, 2, 2, IN_UINT16, OUT_UINT16);                 \
+   SET_ENTRY(PRIM, INPV, OUTPV, 2, 4, IN_UINT16, OUT_UINT32);                 \
+   SET_ENTRY(PRIM, INPV, OUTPV, 4, 2, IN_UINT32, OUT_UINT16);                 \
+   SET_ENTRY(PRIM, INPV, OUTPV, 4, 4, IN_UINT32, OUT_UINT32);                 \
+}
+
+#define ALL_PV_ENTRIES(PRIM)                                                  \
+   ENTRIES(PRIM, FIRST, FIRST)                                                \
+   ENTRIES(PRIM, FIRST, LAST)                                                 \
+   ENTRIES(PRIM, LAST, FIRST)                                                 \
+   ENTRIES(PRIM, LAST, LAST)
+
+ALL_PV_ENTRIES(AVX2_QUADS)
+ALL_PV_ENTRIES(AVX2_QUADSTRIP)
+ALL_PV_ENTRIES(AVX2_TRIFAN)
+ALL_PV_ENTRIES(AVX2_POLYGON)
+
+#define INIT_ALL_PV(PRIM, MODE)                                               \
+   init_##PRIM##_FIRST_FIRST(translate, MODE);                                \
+   init_##PRIM##_FIRST_LAST(translate, MODE);                                 \
+   init_##PRIM##_LAST_FIRST(translate, MODE);                                 \
+   init_##PRIM##_LAST_LAST(translate, MODE)
+
+void
+u_index_init_avx2(u_translate_func translate[IN_COUNT][OUT_COUNT][PV_COUNT][PV_COUNT][PR_COUNT][PRIM_COUNT])
+{
+   INIT_ALL_PV(AVX2_QUADS, MESA_PRIM_QUADS);
+   INIT_ALL_PV(AVX2_QUADSTRIP, MESA_PRIM_QUAD_STRIP);
+   INIT_ALL_PV(AVX2_TRIFAN, MESA_PRIM_TRIANGLE_FAN);
+   INIT_ALL_PV(AVX2_POLYGON, MESA_PRIM_POLYGON);
+}
+
+void
+u_index_translate_byte_to_ushort_avx2(const void *in,
+                                      unsigned start,
+                                      UNUSED unsigned in_nr,
+                                      unsigned out_nr,
+                                      UNUSED unsigned restart_index,
+                                      void *out)
+{
+   const uint8_t *src = (const uint8_t *)in + start;
+   uint16_t *dst = out;
+   unsigned i = 0;
+
+   for (; i + 16 <= out_nr; i += 16) {
+      const __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+      _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu8_epi16(v));
+   }
+
+   for (; i < out_nr; i++)
+      dst[i] = src[i];
+}
+
+#endif
@@ -96,6 +96,7 @@ static u_generate_func  generate[OUT_COUNT][PV_COUNT][PV_COUNT][PRIM_COUNT];
 static u_translate_func translate_quads[IN_COUNT][OUT_COUNT][PV_COUNT][PV_COUNT][PR_COUNT][PRIM_COUNT];
 static u_generate_func  generate_quads[OUT_COUNT][PV_COUNT][PV_COUNT][PRIM_COUNT];
 
+static void u_index_init_simd(void);
 
 ''')
 
@@ -436,6 +437,7 @@ def emit_init(f: 'T.TextIO'):
     f.write('  if (!firsttime) return;\n')
     f.write('  firsttime = 0;\n')
     emit_all_inits(f)
+    f.write('  u_index_init_simd();\n')
     f.write('}\n')
 
 
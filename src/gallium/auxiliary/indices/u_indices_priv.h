@@ -26,6 +26,7 @@
 #define U_INDICES_PRIV_H
 
 #include "util/compiler.h"
+#include "util/detect_arch.h"
 #include "u_indices.h"
 
 #define IN_UINT8      0
@@ -40,27 +41,27 @@
 
 #define PRIM_COUNT   (MESA_PRIM_TRIANGLE_STRIP_ADJACENCY + 1)
 
-static void translate_memcpy_uint( const void *in,
-                                   unsigned start,
-                                   unsigned in_nr,
-                                   unsigned out_nr,
-                                   unsigned restart_index,
-                                   void *out )
+static inline void translate_memcpy_uint( const void *in,
+                                          unsigned start,
+                                          unsigned in_nr,
+                                          unsigned out_nr,
+                                          unsigned restart_index,
+                                          void *out )
 {
    memcpy(out, &((int *)in)[start], out_nr*sizeof(int));
 }
 
-static void translate_memcpy_ushort( const void *in,
-                                     unsigned start,
-                                     unsigned in_nr,
-                                     unsigned out_nr,
-                                     unsigned restart_index,
-                                     void *out )
+static inline void translate_memcpy_ushort( const void *in,
+                                            unsigned start,
+                                            unsigned in_nr,
+                                            unsigned out_nr,
+                                            unsigned restart_index,
+                                            void *out )
 {
    memcpy(out, &((short *)in)[start], out_nr*sizeof(short));
 }
 
-static unsigned out_size_idx( unsigned index_size )
+static inline unsigned out_size_idx( unsigned index_size )
 {
    switch (index_size) {
    case 4: return OUT_UINT32;
@@ -69,7 +70,7 @@ static unsigned out_size_idx( unsigned index_size )
    }
 }
 
-static unsigned in_size_idx( unsigned index_size )
+static inline unsigned in_size_idx( unsigned index_size )
 {
    switch (index_size) {
    case 4: return IN_UINT32;
@@ -79,4 +80,26 @@ static unsigned in_size_idx( unsigned index_size )
    }
 }
 
+u_translate_func
+u_index_lookup_translate(unsigned in_idx,
+                         unsigned out_idx,
+                         unsigned in_pv,
+                         unsigned out_pv,
+                         unsigned prim_restart,
+                         enum mesa_prim prim,
+                         bool simd);
+
+#if defined(USE_AVX2) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64)
+void
+u_index_init_avx2(u_translate_func translate[IN_COUNT][OUT_COUNT][PV_COUNT][PV_COUNT][PR_COUNT][PRIM_COUNT]);
+
+void
+u_index_translate_byte_to_ushort_avx2(const void *in,
+                                      unsigned start,
+                                      unsigned in_nr,
+                                      unsigned out_nr,
+                                      unsigned restart_index,
+                                      void *out);
+#endif
+
 #endif
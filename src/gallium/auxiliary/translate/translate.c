@@ -39,6 +39,12 @@ struct translate *translate_create( const struct translate_key *key )
    struct translate *translate = NULL;
 
 #if DETECT_ARCH_X86 || DETECT_ARCH_X86_64
+#ifdef USE_AVX2
+   translate = translate_avx2_create( key );
+   if (translate)
+      return translate;
+#endif
+
    translate = translate_sse2_create( key );
    if (translate)
       return translate;
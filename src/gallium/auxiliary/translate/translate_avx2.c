@@ -0,0 +1,536 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * AVX2 vertex translation.
+ *
+ * Vertices are processed eight at a time.  Each attribute channel is
+ * fetched for all eight vertices with a single gather, converted to float
+ * in SoA form, and transposed back to one vec4 per vertex for the store.
+ * This covers the formats vertex buffers actually use (8/16-bit normalized
+ * and scaled integers, 10_10_10_2 and 32-bit floats, in any channel order)
+ * to float outputs, plus straight copies and instance IDs.
+ *
+ * The conversions are the same int-to-float multiply the u_format unpack
+ * functions do, so the results are bit-exact with translate_generic.
+ * Keys using anything else return NULL so that translate_create() falls
+ * back to the SSE or generic paths.
+ */
+
+#include "util/detect.h"
+#include "translate.h"
+
+#if defined(USE_AVX2) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64)
+
+#include <immintrin.h>
+
+#include "util/format/u_format.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+
+#define AVX2_BATCH 8
+
+struct translate_avx2_channel {
+   /** Byte offset of the dword holding the channel. */
+   uint8_t offset;
+   /** Bit position and width of the channel within that dword. */
+   uint8_t shift;
+   uint8_t bits;
+   float scale;
+};
+
+struct translate_avx2 {
+   struct translate translate;
+
+   struct {
+      enum translate_element_type type;
+
+      unsigned buffer;
+      unsigned input_offset;
+      unsigned instance_divisor;
+      unsigned output_offset;
+
+      const uint8_t *input_ptr;
+      unsigned input_stride;
+      unsigned max_index;
+
+      /* As in translate_generic: the number of bytes to memcpy when the
+       * input and output formats match, -1 when converting.
+       */
+      int copy_size;
+
+      /* Conversion to float, unused when copying. */
+      unsigned input_size;
+      unsigned nr_channels;
+      bool is_signed;
+      bool is_float;
+      struct translate_avx2_channel channel[4];
+      uint8_t swizzle[4];
+      unsigned nr_outputs;
+   } attrib[TRANSLATE_MAX_ATTRIBS];
+
+   unsigned nr_attrib;
+};
+
+static struct translate_avx2 *
+translate_avx2(struct translate *translate)
+{
+   return (struct translate_avx2 *)translate;
+}
+
+/**
+ * Load the dword at byte \p offset of eight vertices.  Offsets are
+ * computed in 64 bits as stride * index can overflow 32 bits for large
+ * buffers.
+ */
+static inline __m256i
+gather_dwords(const uint8_t *ptr, __m256i lo, __m256i hi)
+{
+   const __m128i a = _mm256_i64gather_epi32((const int *)ptr, lo, 1);
+   const __m128i b = _mm256_i64gather_epi32((const int *)ptr, hi, 1);
+
+   return _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+}
+
+/**
+ * Load whole vertices smaller than a dword one at a time, since a gather
+ * could read past the end of the buffer.
+ */
+static inline __m256i
+load_small(const uint8_t *ptr, const unsigned *index, unsigned stride,
+           unsigned size)
+{
+   uint32_t dw[AVX2_BATCH];
+
+   for (unsigned i = 0; i < AVX2_BATCH; i++) {
+      dw[i] = 0;
+      memcpy(&dw[i], ptr + (size_t)index[i] * stride, size);
+   }
+
+   return _mm256_loadu_si256((const __m256i *)dw);
+}
+
+static inline __m256
+extract_channel(__m256i dw, const struct translate_avx2_channel *chan,
+                bool is_signed, bool is_float)
+{
+   if (is_float)
+      return _mm256_castsi256_ps(dw);
+
+   __m256i v;
+   if (is_signed) {
+      v = _mm256_sll_epi32(dw, _mm_cvtsi32_si128(32 - chan->shift - chan->bits));
+      v = _mm256_sra_epi32(v, _mm_cvtsi32_si128(32 - chan->bits));
+   } else {
+      v = _mm256_srl_epi32(dw, _mm_cvtsi32_si128(chan->shift));
+      v = _mm256_and_si256(v, _mm256_set1_epi32((1u << chan->bits) - 1));
+   }
+
+   return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(chan->scale));
+}
+
+/**
+ * Store the first \p n of eight SoA vec4s to consecutive vertices.
+ */
+static inline void
+store_aos(uint8_t *dst, unsigned stride, const __m256 c[4], unsigned n,
+          unsigned nr_outputs)
+{
+   const __m256 t0 = _mm256_unpacklo_ps(c[0], c[1]);
+   const __m256 t1 = _mm256_unpackhi_ps(c[0], c[1]);
+   const __m256 t2 = _mm256_unpacklo_ps(c[2], c[3]);
+   const __m256 t3 = _mm256_unpackhi_ps(c[2], c[3]);
+   __m256 v[4];
+
+   /* v[i] holds vertex i in the low half and vertex i + 4 in the high. */
+   v[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+   v[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+   v[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+   v[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+   const __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(nr_outputs),
+                                        _mm_setr_epi32(0, 1, 2, 3));
+
+   for (unsigned i = 0; i < n; i++) {
+      const __m128 vert = i < 4 ? _mm256_castps256_ps128(v[i]) :
+                                  _mm256_extractf128_ps(v[i - 4], 1);
+
+      if (nr_outputs == 4)
+         _mm_storeu_ps((float *)dst, vert);
+      else
+         _mm_maskstore_ps((float *)dst, mask, vert);
+
+      dst += stride;
+   }
+}
+
+/**
+ * Translate \p n <= 8 vertices.  \p elts always holds eight valid indices,
+ * the unused ones repeating the last used one.
+ */
+static void
+avx2_run_batch(struct translate_avx2 *ta, const unsigned *elts, unsigned n,
+               bool clamp, unsigned start_instance, unsigned instance_id,
+               uint8_t *vert)
+{
+   const unsigned output_stride = ta->translate.key.output_stride;
+   const __m256i elts_v = _mm256_loadu_si256((const __m256i *)elts);
+
+   for (unsigned attr = 0; attr < ta->nr_attrib; attr++) {
+      uint8_t *dst = vert + ta->attrib[attr].output_offset;
+
+      if (ta->attrib[attr].type == TRANSLATE_ELEMENT_INSTANCE_ID) {
+         for (unsigned i = 0; i < n; i++) {
+            if (ta->attrib[attr].copy_size >= 0) {
+               memcpy(dst, &instance_id, 4);
+            } else {
+               const float f = (float)instance_id;
+               memcpy(dst, &f, 4);
+            }
+            dst += output_stride;
+         }
+         continue;
+      }
+
+      __m256i index;
+      if (ta->attrib[attr].instance_divisor) {
+         /* Not clamped, see generic_run_one(). */
+         index = _mm256_set1_epi32(start_instance +
+                                   instance_id / ta->attrib[attr].instance_divisor);
+      } else if (clamp) {
+         index = _mm256_min_epu32(elts_v,
+                                  _mm256_set1_epi32(ta->attrib[attr].max_index));
+      } else {
+         index = elts_v;
+      }
+
+      const uint8_t *src = ta->attrib[attr].input_ptr;
+      const unsigned stride = ta->attrib[attr].input_stride;
+
+      if (ta->attrib[attr].copy_size >= 0) {
+         unsigned idx[AVX2_BATCH];
+         _mm256_storeu_si256((__m256i *)idx, index);
+
+         for (unsigned i = 0; i < n; i++) {
+            memcpy(dst, src + (size_t)idx[i] * stride,
+                   ta->attrib[attr].copy_size);
+            dst += output_stride;
+         }
+         continue;
+      }
+
+      const bool is_signed = ta->attrib[attr].is_signed;
+      const bool is_float = ta->attrib[attr].is_float;
+      __m256 chan[4];
+      __m256i dw = _mm256_setzero_si256();
+
+      if (ta->attrib[attr].input_size < 4) {
+         unsigned idx[AVX2_BATCH];
+         _mm256_storeu_si256((__m256i *)idx, index);
+         dw = load_small(src, idx, stride, ta->attrib[attr].input_size);
+
+         for (unsigned c = 0; c < ta->attrib[attr].nr_channels; c++)
+            chan[c] = extract_channel(dw, &ta->attrib[attr].channel[c],
+                                      is_signed, is_float);
+      } else {
+         const __m256i stride_v = _mm256_set1_epi64x(stride);
+         const __m256i lo =
+            _mm256_mul_epu32(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(index)),
+                             stride_v);
+         const __m256i hi =
+            _mm256_mul_epu32(_mm256_cvtepu32_epi64(_mm256_extracti128_si256(index, 1)),
+                             stride_v);
+         int offset = -1;
+
+         /* Channels sharing a dword, e.g. all of RGBA8, share a gather. */
+         for (unsigned c = 0; c < ta->attrib[attr].nr_channels; c++) {
+            const struct translate_avx2_channel *channel =
+               &ta->attrib[attr].channel[c];
+
+            if (channel->offset != offset) {
+               offset = channel->offset;
+               dw = gather_dwords(src + offset, lo, hi);
+            }
+            chan[c] = extract_channel(dw, channel, is_signed, is_float);
+         }
+      }
+
+      __m256 out[4];
+      for (unsigned c = 0; c < 4; c++) {
+         const unsigned swz = ta->attrib[attr].swizzle[c];
+
+         if (swz <= PIPE_SWIZZLE_W)
+            out[c] = chan[swz];
+         else if (swz == PIPE_SWIZZLE_1)
+            out[c] = _mm256_set1_ps(1.0f);
+         else
+            out[c] = _mm256_setzero_ps();
+      }
+
+      store_aos(dst, output_stride, out, n, ta->attrib[attr].nr_outputs);
+   }
+}
+
+static void
+avx2_run_elts32(struct translate_avx2 *ta, const unsigned *elts, unsigned count,
+                unsigned start_instance, unsigned instance_id, uint8_t *vert)
+{
+   const unsigned batch_stride = AVX2_BATCH * ta->translate.key.output_stride;
+   unsigned i;
+
+   for (i = 0; i + AVX2_BATCH <= count; i += AVX2_BATCH) {
+      avx2_run_batch(ta, elts + i, AVX2_BATCH, true,
+                     start_instance, instance_id, vert);
+      vert += batch_stride;
+   }
+
+   if (i < count) {
+      unsigned tail[AVX2_BATCH];
+
+      for (unsigned j = 0; j < AVX2_BATCH; j++)
+         tail[j] = elts[MIN2(i + j, count - 1)];
+
+      avx2_run_batch(ta, tail, count - i, true,
+                     start_instance, instance_id, vert);
+   }
+}
+
+static void UTIL_CDECL
+avx2_run_elts(struct translate *translate,
+              const unsigned *elts,
+              unsigned count,
+              unsigned start_instance,
+              unsigned instance_id,
+              void *output_buffer)
+{
+   avx2_run_elts32(translate_avx2(translate), elts, count,
+                   start_instance, instance_id, output_buffer);
+}
+
+#define RUN_ELTS_NARROW(NAME, TYPE)                                          \
+static void UTIL_CDECL                                                       \
+NAME(struct translate *translate,                                            \
+     const TYPE *elts,                                                       \
+     unsigned count,                                                         \
+     unsigned start_instance,                                                \
+     unsigned instance_id,                                                   \
+     void *output_buffer)                                                    \
+{                                                                            \
+   struct translate_avx2 *ta = translate_avx2(translate);                    \
+   const unsigned batch_stride = AVX2_BATCH * translate->key.output_stride;  \
+   uint8_t *vert = output_buffer;                                            \
+   unsigned batch[AVX2_BATCH];                                               \
+   unsigned i;                                                               \
+                                                                             \
+   for (i = 0; i < count; i += AVX2_BATCH) {                                 \
+      const unsigned n = MIN2(count - i, AVX2_BATCH);                        \
+                                                                             \
+      for (unsigned j = 0; j < AVX2_BATCH; j++)                              \
+         batch[j] = elts[i + MIN2(j, n - 1)];                                \
+                                                                             \
+      avx2_run_batch(ta, batch, n, true, start_instance, instance_id, vert); \
+      vert += batch_stride;                                                  \
+   }                                                                         \
+}
+
+RUN_ELTS_NARROW(avx2_run_elts16, uint16_t)
+RUN_ELTS_NARROW(avx2_run_elts8, uint8_t)
+
+static void UTIL_CDECL
+avx2_run(struct translate *translate,
+         unsigned start,
+         unsigned count,
+         unsigned start_instance,
+         unsigned instance_id,
+         void *output_buffer)
+{
+   struct translate_avx2 *ta = translate_avx2(translate);
+   const unsigned batch_stride = AVX2_BATCH * translate->key.output_stride;
+   uint8_t *vert = output_buffer;
+   unsigned batch[AVX2_BATCH];
+
+   for (unsigned i = 0; i < count; i += AVX2_BATCH) {
+      const unsigned n = MIN2(count - i, AVX2_BATCH);
+
+      for (unsigned j = 0; j < AVX2_BATCH; j++)
+         batch[j] = start + i + MIN2(j, n - 1);
+
+      avx2_run_batch(ta, batch, n, false, start_instance, instance_id, vert);
+      vert += batch_stride;
+   }
+}
+
+static void
+avx2_set_buffer(struct translate *translate,
+                unsigned buf,
+                const void *ptr,
+                unsigned stride,
+                unsigned max_index)
+{
+   struct translate_avx2 *ta = translate_avx2(translate);
+
+   for (unsigned i = 0; i < ta->nr_attrib; i++) {
+      if (ta->attrib[i].buffer == buf) {
+         ta->attrib[i].input_ptr = ((const uint8_t *)ptr +
+                                    ta->attrib[i].input_offset);
+         ta->attrib[i].input_stride = stride;
+         ta->attrib[i].max_index = max_index;
+      }
+   }
+}
+
+static void
+avx2_release(struct translate *translate)
+{
+   FREE(translate);
+}
+
+static unsigned
+float_output_size(enum pipe_format format)
+{
+   switch (format) {
+   case PIPE_FORMAT_R32_FLOAT:          return 1;
+   case PIPE_FORMAT_R32G32_FLOAT:       return 2;
+   case PIPE_FORMAT_R32G32B32_FLOAT:    return 3;
+   case PIPE_FORMAT_R32G32B32A32_FLOAT: return 4;
+   default:                             return 0;
+   }
+}
+
+/**
+ * Set up the float conversion of \p element, returning false if it isn't
+ * one we handle.
+ */
+static bool
+setup_conversion(struct translate_avx2 *ta, unsigned i,
+                 const struct translate_element *element)
+{
+   const struct util_format_description *desc =
+      util_format_description(element->input_format);
+   const struct util_format_channel_description *chan0 = &desc->channel[0];
+
+   ta->attrib[i].nr_outputs = float_output_size(element->output_format);
+   if (!ta->attrib[i].nr_outputs)
+      return false;
+
+   if (desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       desc->colorspace != UTIL_FORMAT_COLORSPACE_RGB ||
+       desc->block.width != 1 || desc->block.height != 1 ||
+       desc->block.bits > 128 || (desc->block.bits & 7))
+      return false;
+
+   if (chan0->type != UTIL_FORMAT_TYPE_UNSIGNED &&
+       chan0->type != UTIL_FORMAT_TYPE_SIGNED &&
+       chan0->type != UTIL_FORMAT_TYPE_FLOAT)
+      return false;
+
+   const unsigned size = desc->block.bits / 8;
+
+   ta->attrib[i].input_size = size;
+   ta->attrib[i].nr_channels = desc->nr_channels;
+   ta->attrib[i].is_signed = chan0->type == UTIL_FORMAT_TYPE_SIGNED;
+   ta->attrib[i].is_float = chan0->type == UTIL_FORMAT_TYPE_FLOAT;
+
+   for (unsigned c = 0; c < desc->nr_channels; c++) {
+      const struct util_format_channel_description *chan = &desc->channel[c];
+      struct translate_avx2_channel *out = &ta->attrib[i].channel[c];
+
+      /* Pure integers would need integer outputs, and 32-bit integers
+       * and halfs don't convert with a single cvtepi32_ps.
+       */
+      if (chan->type != chan0->type ||
+          chan->pure_integer ||
+          (chan->type == UTIL_FORMAT_TYPE_FLOAT ? chan->size != 32 :
+                                                  chan->size > 16))
+         return false;
+
+      /* Whole vertices smaller than a dword are loaded one by one. */
+      unsigned offset = size < 4 ? 0 : MIN2(chan->shift / 8, size - 4);
+
+      out->offset = offset;
+      out->shift = chan->shift - offset * 8;
+      out->bits = chan->size;
+      assert(out->shift + out->bits <= 32);
+
+      if (!chan->normalized)
+         out->scale = 1.0f;
+      else if (chan->type == UTIL_FORMAT_TYPE_SIGNED)
+         out->scale = 1.0f / (float)((1u << (chan->size - 1)) - 1);
+      else
+         out->scale = 1.0f / (float)((1u << chan->size) - 1);
+   }
+
+   for (unsigned c = 0; c < 4; c++) {
+      const unsigned swz = desc->swizzle[c];
+
+      if (swz < desc->nr_channels || swz == PIPE_SWIZZLE_0 ||
+          swz == PIPE_SWIZZLE_1)
+         ta->attrib[i].swizzle[c] = swz;
+      else
+         return false;
+   }
+
+   return true;
+}
+
+struct translate *
+translate_avx2_create(const struct translate_key *key)
+{
+   if (!util_get_cpu_caps()->has_avx2)
+      return NULL;
+
+   struct translate_avx2 *ta = CALLOC_STRUCT(translate_avx2);
+   if (!ta)
+      return NULL;
+
+   assert(key->nr_elements <= TRANSLATE_MAX_ATTRIBS);
+
+   ta->translate.key = *key;
+   ta->translate.release = avx2_release;
+   ta->translate.set_buffer = avx2_set_buffer;
+   ta->translate.run_elts = avx2_run_elts;
+   ta->translate.run_elts16 = avx2_run_elts16;
+   ta->translate.run_elts8 = avx2_run_elts8;
+   ta->translate.run = avx2_run;
+
+   for (unsigned i = 0; i < key->nr_elements; i++) {
+      const struct translate_element *element = &key->element[i];
+      const struct util_format_description *desc =
+         util_format_description(element->input_format);
+
+      ta->attrib[i].type = element->type;
+      ta->attrib[i].buffer = element->input_buffer;
+      ta->attrib[i].input_offset = element->input_offset;
+      ta->attrib[i].instance_divisor = element->instance_divisor;
+      ta->attrib[i].output_offset = element->output_offset;
+      ta->attrib[i].copy_size = -1;
+
+      if (element->type == TRANSLATE_ELEMENT_INSTANCE_ID) {
+         if (element->output_format == PIPE_FORMAT_R32_USCALED ||
+             element->output_format == PIPE_FORMAT_R32_SSCALED)
+            ta->attrib[i].copy_size = 4;
+         else if (element->output_format != PIPE_FORMAT_R32_FLOAT)
+            goto fail;
+      } else if (element->input_format == element->output_format &&
+                 desc->block.width == 1 &&
+                 desc->block.height == 1 &&
+                 !(desc->block.bits & 7)) {
+         ta->attrib[i].copy_size = desc->block.bits >> 3;
+      } else if (!setup_conversion(ta, i, element)) {
+         goto fail;
+      }
+   }
+
+   ta->nr_attrib = key->nr_elements;
+
+   return &ta->translate;
+
+fail:
+   FREE(ta);
+   return NULL;
+}
+
+#endif
@@ -32,6 +32,7 @@
 #include "util/u_upload_mgr.h"
 #include "driver_trace/tr_context.h"
 #include "util/log.h"
+#include "util/os_time.h"
 #include "util/perf/cpu_trace.h"
 #include "util/thread_sched.h"
 #include "compiler/shader_info.h"
@@ -54,13 +55,11 @@
 
 #define TC_SENTINEL 0x5ca1ab1e
 
-#if TC_DEBUG >= 3 || defined(TC_TRACE)
 static const char *tc_call_names[] = {
 #define CALL(name) #name,
 #include "u_threaded_context_calls.h"
 #undef CALL
 };
-#endif
 
 #ifdef TC_TRACE
 #  define TC_TRACE_SCOPE(call_id) MESA_TRACE_SCOPE(tc_call_names[call_id])
@@ -450,7 +449,16 @@ batch_execute(struct tc_batch *batch, struct pipe_context *pipe, uint64_t *last,
 
       TC_TRACE_SCOPE(call->call_id);
 
-      iter += execute_func[call->call_id](pipe, call);
+      if (unlikely(batch->tc->stats.time_calls)) {
+         unsigned call_id = call->call_id;
+         int64_t start = os_time_get_nano();
+
+         iter += execute_func[call_id](pipe, call);
+         batch->tc->stats.calls[call_id].execute_ns +=
+            os_time_get_nano() - start;
+      } else {
+         iter += execute_func[call->call_id](pipe, call);
+      }
 
       if (parsing) {
          if (call->call_id == TC_CALL_flush) {
@@ -580,6 +588,8 @@ tc_batch_flush(struct threaded_context *tc, bool full_copy)
    tc_debug_check(tc);
    tc->bytes_mapped_estimate = 0;
    p_atomic_add(&tc->num_offloaded_slots, next->num_total_slots);
+   tc->stats.num_flushed_batches++;
+   tc->stats.num_flushed_slots += next->num_total_slots;
 
    if (next->token) {
       next->token->tc = NULL;
@@ -632,6 +642,9 @@ tc_add_sized_call(struct threaded_context *tc, enum tc_call_id id,
    struct tc_call_base *call = (struct tc_call_base*)&next->slots[next->num_total_slots];
    next->num_total_slots += num_slots;
 
+   tc->stats.calls[id].count++;
+   tc->stats.calls[id].slots += num_slots;
+
 #if !defined(NDEBUG) && TC_DEBUG >= 1
    call->sentinel = TC_SENTINEL;
 #endif
@@ -714,10 +727,32 @@ tc_is_sync(struct threaded_context *tc)
 }
 
 static void
-_tc_sync(struct threaded_context *tc, UNUSED const char *info, UNUSED const char *func)
+tc_add_sync_stats(struct threaded_context *tc, const char *func,
+                  uint64_t stall_ns)
+{
+   tc->stats.sync_stall_ns += stall_ns;
+
+   /* func is always a __func__ string, so comparing pointers is enough. */
+   for (unsigned i = 0; i < TC_MAX_SYNC_REASONS; i++) {
+      struct tc_sync_stats *sync = &tc->stats.syncs[i];
+
+      if (!sync->func)
+         sync->func = func;
+
+      if (sync->func == func || i == TC_MAX_SYNC_REASONS - 1) {
+         sync->count++;
+         sync->stall_ns += stall_ns;
+         return;
+      }
+   }
+}
+
+static void
+_tc_sync(struct threaded_context *tc, UNUSED const char *info, const char *func)
 {
    struct tc_batch *last = &tc->batch_slots[tc->last];
    struct tc_batch *next = &tc->batch_slots[tc->next];
+   int64_t start = os_time_get_nano();
    bool synced = false;
 
    MESA_TRACE_SCOPE(func);
@@ -763,6 +798,7 @@ _tc_sync(struct threaded_context *tc, UNUSED const char *info, UNUSED const char
 
    if (synced) {
       p_atomic_inc(&tc->num_syncs);
+      tc_add_sync_stats(tc, func, os_time_get_nano() - start);
 
       if (tc_strcmp(func, "tc_destroy") != 0) {
          tc_printf("sync %s %s", func, info);
@@ -5078,6 +5114,34 @@ tc_callback(struct pipe_context *_pipe, void (*fn)(void *), void *data,
  * create & destroy
  */
 
+static void
+tc_print_stats(struct threaded_context *tc)
+{
+   const struct tc_stats *stats = &tc->stats;
+
+   mesa_logi("threaded context %p: %"PRIu64" batches flushed, %.1f%% full",
+             (void *)tc, stats->num_flushed_batches,
+             stats->num_flushed_batches ?
+                100.0 * stats->num_flushed_slots /
+                (stats->num_flushed_batches * TC_SLOTS_PER_BATCH) : 0.0);
+
+   mesa_logi("%-32s %12s %12s %12s", "call", "count", "slots", "execute ms");
+   for (unsigned i = 0; i < TC_NUM_CALLS; i++) {
+      if (!stats->calls[i].count)
+         continue;
+
+      mesa_logi("%-32s %12"PRIu64" %12"PRIu64" %12.3f", tc_call_names[i],
+                stats->calls[i].count, stats->calls[i].slots,
+                stats->calls[i].execute_ns / 1000000.0);
+   }
+
+   mesa_logi("%-32s %12s %12s", "sync", "count", "stall ms");
+   for (unsigned i = 0; i < TC_MAX_SYNC_REASONS && stats->syncs[i].func; i++) {
+      mesa_logi("%-32s %12"PRIu64" %12.3f", stats->syncs[i].func,
+                stats->syncs[i].count, stats->syncs[i].stall_ns / 1000000.0);
+   }
+}
+
 static void
 tc_destroy(struct pipe_context *_pipe)
 {
@@ -5093,6 +5157,9 @@ tc_destroy(struct pipe_context *_pipe)
 
    tc_sync(tc);
 
+   if (tc->stats.time_calls)
+      tc_print_stats(tc);
+
    if (util_queue_is_initialized(&tc->queue)) {
       util_queue_destroy(&tc->queue);
 
@@ -5182,6 +5249,7 @@ threaded_context_create(struct pipe_context *pipe,
 
    tc->pipe = pipe;
    tc->replace_buffer_storage = replace_buffer;
+   tc->stats.time_calls = debug_get_bool_option("GALLIUM_TC_STATS", false);
    tc->map_buffer_alignment =
       pipe->screen->get_param(pipe->screen, PIPE_CAP_MIN_MAP_BUFFER_ALIGNMENT);
    tc->ubo_alignment =
@@ -5394,6 +5462,16 @@ fail:
    return NULL;
 }
 
+/**
+ * Return the threaded context if \p pipe is one, e.g. for the HUD to read
+ * the call stream statistics.
+ */
+struct threaded_context *
+threaded_context_from_pipe(struct pipe_context *pipe)
+{
+   return pipe && pipe->destroy == tc_destroy ? threaded_context(pipe) : NULL;
+}
+
 void
 threaded_context_init_bytes_mapped_limit(struct threaded_context *tc, unsigned divisor)
 {
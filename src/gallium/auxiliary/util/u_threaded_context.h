@@ -530,6 +530,38 @@ struct tc_batch {
    struct util_dynarray renderpass_infos;
 };
 
+#define TC_MAX_SYNC_REASONS 32
+
+struct tc_call_stats {
+   uint64_t count;
+   uint64_t slots;
+   /* Only gathered with GALLIUM_TC_STATS. */
+   uint64_t execute_ns;
+};
+
+struct tc_sync_stats {
+   /* The function that caused the sync. */
+   const char *func;
+   uint64_t count;
+   uint64_t stall_ns;
+};
+
+/**
+ * Call stream statistics.  Everything but the execute times is updated by
+ * the thread recording the calls, so it can be read from there without
+ * locking.
+ */
+struct tc_stats {
+   struct tc_call_stats calls[TC_NUM_CALLS];
+   /* The last entry also collects the reasons that don't fit. */
+   struct tc_sync_stats syncs[TC_MAX_SYNC_REASONS];
+   uint64_t sync_stall_ns;
+   uint64_t num_flushed_batches;
+   uint64_t num_flushed_slots;
+   /* Time the execution of each call, set by GALLIUM_TC_STATS. */
+   bool time_calls;
+};
+
 struct tc_buffer_list {
    /* Signalled by the driver after it flushes its internal command buffer. */
    struct util_queue_fence driver_flushed_fence;
@@ -588,6 +620,7 @@ struct threaded_context {
    unsigned num_offloaded_slots;
    unsigned num_direct_slots;
    unsigned num_syncs;
+   struct tc_stats stats;
 
    bool use_forced_staging_uploads;
    bool add_all_gfx_bindings_to_buffer_list;
@@ -702,6 +735,9 @@ threaded_context_create(struct pipe_context *pipe,
 void
 threaded_context_init_bytes_mapped_limit(struct threaded_context *tc, unsigned divisor);
 
+struct threaded_context *
+threaded_context_from_pipe(struct pipe_context *pipe);
+
 void
 threaded_context_flush(struct pipe_context *_pipe,
                        struct tc_unflushed_batch_token *token,
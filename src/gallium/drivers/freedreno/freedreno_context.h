@@ -664,6 +664,11 @@ struct fd_context {
        */
       struct ir3_shader_key *key;
 
+      /* ir3_compiler::variants_replaced as of the last draw, see
+       * ir3_fixup_shader_state()
+       */
+      uint32_t variants_replaced;
+
    } last dt;
 };
 
@@ -98,6 +98,7 @@ static const struct debug_named_value fd_debug_options[] = {
    {"nofp16",    FD_DBG_NOFP16,   "Disable mediump precision lowering"},
    {"nohw",      FD_DBG_NOHW,     "Disable submitting commands to the HW"},
    {"nosbin",    FD_DBG_NOSBIN,   "Execute GMEM bins in raster order instead of 'S' pattern"},
+   {"nofastv",   FD_DBG_NOFASTV,  "Fully optimize shader variants compiled at draw time right away"},
    DEBUG_NAMED_VALUE_END
 };
 /* clang-format on */
@@ -102,6 +102,7 @@ enum fd_debug_flag {
    FD_DBG_NOFP16       = BITFIELD_BIT(27),
    FD_DBG_NOHW         = BITFIELD_BIT(28),
    FD_DBG_NOSBIN       = BITFIELD_BIT(29),
+   FD_DBG_NOFASTV      = BITFIELD_BIT(30),
 };
 /* clang-format on */
 
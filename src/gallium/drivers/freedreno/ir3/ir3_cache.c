@@ -85,6 +85,18 @@ ir3_cache_destroy(struct ir3_cache *cache)
    ralloc_free(cache);
 }
 
+static const struct ir3_shader_variant *
+get_variant(struct ir3_shader_state *hwcso, struct ir3_shader *shader,
+            struct ir3_shader_key key, bool binning_pass,
+            struct util_debug_callback *debug)
+{
+   /* The passthrough TCS has no state object. */
+   if (!hwcso)
+      return ir3_shader_variant(shader, key, binning_pass, debug);
+
+   return ir3_shader_state_variant(hwcso, key, binning_pass, debug);
+}
+
 struct ir3_program_state *
 ir3_cache_lookup(struct ir3_cache *cache, const struct ir3_cache_key *key,
                  struct util_debug_callback *debug)
@@ -102,6 +114,13 @@ ir3_cache_lookup(struct ir3_cache *cache, const struct ir3_cache_key *key,
    if (key->hs)
       assert(key->ds);
 
+   struct ir3_shader_state *hwcsos[MESA_SHADER_STAGES] = {
+      [MESA_SHADER_VERTEX] = key->vs,
+      [MESA_SHADER_TESS_CTRL] = key->hs,
+      [MESA_SHADER_TESS_EVAL] = key->ds,
+      [MESA_SHADER_GEOMETRY] = key->gs,
+      [MESA_SHADER_FRAGMENT] = key->fs,
+   };
    struct ir3_shader *shaders[MESA_SHADER_STAGES] = {
       [MESA_SHADER_VERTEX] = ir3_get_shader(key->vs),
       [MESA_SHADER_TESS_CTRL] = ir3_get_shader(key->hs),
@@ -123,8 +142,8 @@ ir3_cache_lookup(struct ir3_cache *cache, const struct ir3_cache_key *key,
    for (gl_shader_stage stage = MESA_SHADER_VERTEX; stage < MESA_SHADER_STAGES;
         stage++) {
       if (shaders[stage]) {
-         variants[stage] =
-            ir3_shader_variant(shaders[stage], shader_key, false, debug);
+         variants[stage] = get_variant(hwcsos[stage], shaders[stage],
+                                       shader_key, false, debug);
          if (!variants[stage])
             return NULL;
       } else {
@@ -139,8 +158,8 @@ ir3_cache_lookup(struct ir3_cache *cache, const struct ir3_cache_key *key,
    for (gl_shader_stage stage = MESA_SHADER_VERTEX; stage < MESA_SHADER_STAGES;
         stage++) {
       if (safe_constlens & (1 << stage)) {
-         variants[stage] =
-            ir3_shader_variant(shaders[stage], shader_key, false, debug);
+         variants[stage] = get_variant(hwcsos[stage], shaders[stage],
+                                       shader_key, false, debug);
          if (!variants[stage])
             return NULL;
       }
@@ -154,8 +173,8 @@ ir3_cache_lookup(struct ir3_cache *cache, const struct ir3_cache_key *key,
        */
       shader_key.safe_constlen = (compiler->gen >= 6) &&
             !!(safe_constlens & (1 << MESA_SHADER_VERTEX));
-      bs =
-         ir3_shader_variant(shaders[MESA_SHADER_VERTEX], shader_key, true, debug);
+      bs = get_variant(key->vs, shaders[MESA_SHADER_VERTEX], shader_key,
+                       true, debug);
       if (!bs)
          return NULL;
    } else {
@@ -169,6 +188,13 @@ ir3_cache_lookup(struct ir3_cache *cache, const struct ir3_cache_key *key,
       key);
    state->key = *key;
 
+   state->fast = bs->fast_compile;
+   for (gl_shader_stage stage = MESA_SHADER_VERTEX; stage < MESA_SHADER_STAGES;
+        stage++) {
+      if (variants[stage] && variants[stage]->fast_compile)
+         state->fast = true;
+   }
+
    /* NOTE: uses copy of key in state obj, because pointer passed by caller
     * is probably on the stack
     */
@@ -196,3 +222,18 @@ ir3_cache_invalidate(struct ir3_cache *cache, void *stobj)
       }
    }
 }
+
+void
+ir3_cache_invalidate_fast(struct ir3_cache *cache)
+{
+   if (!cache)
+      return;
+
+   hash_table_foreach (cache->ht, entry) {
+      struct ir3_program_state *state = entry->data;
+      if (state->fast) {
+         cache->funcs->destroy_state(cache->data, state);
+         _mesa_hash_table_remove(cache->ht, entry);
+      }
+   }
+}
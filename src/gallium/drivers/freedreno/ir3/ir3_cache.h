@@ -57,6 +57,9 @@ struct ir3_cache_key {
  */
 struct ir3_program_state {
    struct ir3_cache_key key;
+
+   /* built from at least one fast variant, see ir3_cache_invalidate_fast() */
+   bool fast;
 };
 
 struct ir3_cache_funcs {
@@ -87,6 +90,11 @@ struct ir3_program_state *ir3_cache_lookup(struct ir3_cache *cache,
  */
 void ir3_cache_invalidate(struct ir3_cache *cache, void *stobj);
 
+/* call when fast variants have been replaced, to drop the cache entries
+ * built from fast variants so that they get rebuilt from the optimized ones.
+ */
+void ir3_cache_invalidate_fast(struct ir3_cache *cache);
+
 ENDC;
 
 #endif /* IR3_CACHE_H_ */
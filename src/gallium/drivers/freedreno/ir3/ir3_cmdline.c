@@ -54,6 +54,8 @@
 
 #include "pipe/p_context.h"
 
+#include "util/os_time.h"
+
 static void
 dump_info(struct ir3_shader_variant *so, const char *str)
 {
@@ -261,9 +263,61 @@ load_spirv(const char *filename, const char *entry, gl_shader_stage stage)
    return nir;
 }
 
-static const char *shortopts = "g:hv";
+static struct ir3_shader_variant *
+create_variant(struct ir3_shader *shader, const struct ir3_shader_key *key,
+               bool fast_compile)
+{
+   struct ir3_shader_variant *v = rzalloc_size(shader, sizeof(*v));
+   v->id = ++shader->variant_count;
+   v->type = shader->type;
+   v->compiler = compiler;
+   v->key = *key;
+   v->fast_compile = fast_compile;
+   v->const_state = rzalloc_size(v, sizeof(*v->const_state));
+
+   return v;
+}
+
+/* Compile the same variant over and over to measure compile time without
+ * hardware.  Each iteration goes through ir3_compile_shader_nir() and the
+ * assembler, which is what a variant miss at draw time costs.
+ */
+static void
+bench_variant(struct ir3_shader *shader, const struct ir3_shader_key *key,
+              bool fast_compile, unsigned iterations)
+{
+   uint64_t total = 0, min = UINT64_MAX, max = 0;
+   unsigned instrs = 0;
+
+   for (unsigned i = 0; i < iterations; i++) {
+      struct ir3_shader_variant *v = create_variant(shader, key, fast_compile);
+
+      int64_t start = os_time_get_nano();
+      if (ir3_compile_shader_nir(compiler, shader, v))
+         errx(1, "compiler failed!");
+      if (!ir3_shader_assemble(v))
+         errx(1, "assembler failed!");
+      uint64_t elapsed = os_time_get_nano() - start;
+
+      total += elapsed;
+      min = MIN2(min, elapsed);
+      max = MAX2(max, elapsed);
+      instrs = v->info.instrs_count;
+
+      ralloc_free(v);
+   }
+
+   printf("; %s: %u iterations, %u instrs, "
+          "min %.3f ms, avg %.3f ms, max %.3f ms\n",
+          fast_compile ? "fast" : "full", iterations, instrs,
+          min / 1000000.0, total / (iterations * 1000000.0), max / 1000000.0);
+}
+
+static const char *shortopts = "b:fg:hv";
 
 static const struct option longopts[] = {
+   {"bench",   required_argument, 0, 'b'},
+   {"fast",    no_argument,       0, 'f'},
    {"gpu",     required_argument, 0, 'g'},
    {"help",    no_argument,       0, 'h'},
    {"verbose", no_argument,       0, 'v'},
@@ -274,6 +328,8 @@ print_usage(void)
 {
    printf("Usage: ir3_compiler [OPTIONS]... <file.tgsi | file.spv entry_point "
           "| (file.vert | file.frag)*>\n");
+   printf("    -b, --bench N    - compile N times and report compile time\n");
+   printf("    -f, --fast       - use the fast variant compile mode\n");
    printf("    -g, --gpu GPU_ID - specify gpu-id (default 320)\n");
    printf("    -h, --help       - show this message\n");
    printf("    -v, --verbose    - verbose compiler/debug messages\n");
@@ -292,11 +348,19 @@ main(int argc, char **argv)
    const char *spirv_entry = NULL;
    void *ptr;
    bool from_tgsi = false;
+   bool fast_compile = false;
+   unsigned bench_iterations = 0;
    size_t size;
 
    while ((opt = getopt_long_only(argc, argv, shortopts, longopts, NULL)) !=
           -1) {
       switch (opt) {
+      case 'b':
+         bench_iterations = strtoul(optarg, NULL, 0);
+         break;
+      case 'f':
+         fast_compile = true;
+         break;
       case 'g':
          gpu_id = strtol(optarg, NULL, 0);
          break;
@@ -422,18 +486,17 @@ main(int argc, char **argv)
 
    ir3_nir_post_finalize(shader);
 
-   struct ir3_shader_variant *v = rzalloc_size(shader, sizeof(*v));
-   v->type = shader->type;
-   v->compiler = compiler;
-   v->key = key;
-   v->const_state = rzalloc_size(v, sizeof(*v->const_state));
-
+   struct ir3_shader_variant *v = create_variant(shader, &key, fast_compile);
    shader->variants = v;
-   shader->variant_count = 1;
 
    ir3_nir_lower_variant(v, nir);
 
-   info = "NIR compiler";
+   if (bench_iterations) {
+      bench_variant(shader, &key, false, bench_iterations);
+      bench_variant(shader, &key, true, bench_iterations);
+   }
+
+   info = fast_compile ? "NIR compiler (fast)" : "NIR compiler";
    ret = ir3_compile_shader_nir(compiler, shader, v);
    if (ret) {
       fprintf(stderr, "compiler failed!\n");
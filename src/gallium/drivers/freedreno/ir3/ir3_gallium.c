@@ -28,6 +28,7 @@
 #include "pipe/p_state.h"
 #include "tgsi/tgsi_dump.h"
 #include "util/format/u_format.h"
+#include "util/u_atomic.h"
 #include "util/u_inlines.h"
 #include "util/u_memory.h"
 #include "util/u_string.h"
@@ -53,9 +54,13 @@
  */
 struct ir3_shader_state {
    struct ir3_shader *shader;
+   struct fd_screen *screen;
 
    /* Fence signalled when async compile is completed: */
    struct util_queue_fence ready;
+
+   /* Number of queued jobs replacing fast variants: */
+   unsigned replace_jobs;
 };
 
 /**
@@ -117,12 +122,12 @@ upload_shader_variant(struct ir3_shader_variant *v)
    fd_bo_upload(v->bo, v->bin, 0, v->info.size);
 }
 
-struct ir3_shader_variant *
-ir3_shader_variant(struct ir3_shader *shader, struct ir3_shader_key key,
-                   bool binning_pass, struct util_debug_callback *debug)
+static struct ir3_shader_variant *
+get_variant(struct ir3_shader *shader, struct ir3_shader_key key,
+            bool binning_pass, bool fast_compile,
+            struct util_debug_callback *debug, bool *created)
 {
    struct ir3_shader_variant *v;
-   bool created = false;
 
    MESA_TRACE_FUNC();
 
@@ -132,15 +137,20 @@ ir3_shader_variant(struct ir3_shader *shader, struct ir3_shader_key key,
     */
    ir3_key_clear_unused(&key, shader);
 
-   v = ir3_shader_get_variant(shader, &key, binning_pass, false, &created);
+   if (fast_compile)
+      v = ir3_shader_get_fast_variant(shader, &key, binning_pass, false, created);
+   else
+      v = ir3_shader_get_variant(shader, &key, binning_pass, false, created);
 
-   if (created) {
+   if (*created) {
       if (shader->initial_variants_done) {
          perf_debug_message(debug, SHADER_INFO,
-                            "%s shader: recompiling at draw time: global "
+                            "%s shader: recompiling at draw time%s: global "
                             "0x%08x, vfsamples %x/%x, astc %x/%x\n",
-                            ir3_shader_stage(v), key.global, key.vsamples,
-                            key.fsamples, key.vastc_srgb, key.fastc_srgb);
+                            ir3_shader_stage(v),
+                            v->fast_compile ? " (fast)" : "", key.global,
+                            key.vsamples, key.fsamples, key.vastc_srgb,
+                            key.fastc_srgb);
       }
 
       dump_shader_info(v, debug);
@@ -155,6 +165,98 @@ ir3_shader_variant(struct ir3_shader *shader, struct ir3_shader_key key,
    return v;
 }
 
+struct ir3_shader_variant *
+ir3_shader_variant(struct ir3_shader *shader, struct ir3_shader_key key,
+                   bool binning_pass, struct util_debug_callback *debug)
+{
+   bool created = false;
+
+   return get_variant(shader, key, binning_pass, false, debug, &created);
+}
+
+struct replace_variant_job {
+   struct ir3_shader_state *hwcso;
+   struct ir3_shader_key key;
+};
+
+static void
+replace_variant_async(void *job, void *gdata, int thread_index)
+{
+   struct replace_variant_job *j = job;
+   struct ir3_shader *shader = j->hwcso->shader;
+
+   MESA_TRACE_FUNC();
+
+   struct ir3_shader_variant *v =
+      ir3_shader_create_variant(shader, &j->key, false);
+   if (!v)
+      return;
+
+   upload_shader_variant(v);
+   if (v->binning)
+      upload_shader_variant(v->binning);
+
+   ir3_shader_replace_variant(shader, v);
+}
+
+static void
+replace_variant_cleanup(void *job, void *gdata, int thread_index)
+{
+   struct replace_variant_job *j = job;
+
+   p_atomic_dec(&j->hwcso->replace_jobs);
+   free(j);
+}
+
+/**
+ * Should variants compiled at draw time be fast variants?
+ *
+ * Not if they wouldn't be replaced asynchronously, or if their stats
+ * are reported (see initial_variants_synchronous()).
+ */
+static bool
+fast_variants_enabled(struct util_debug_callback *debug)
+{
+   return !(unlikely(debug && debug->debug_message) || FD_DBG(SHADERDB) ||
+            FD_DBG(SERIALC) || FD_DBG(NOFASTV));
+}
+
+/**
+ * Get the variant of a shader state object for a draw.
+ *
+ * Variants not covered by the initial variants stall the draw, so those
+ * are compiled with the fast pipeline, and a fully optimized compile is
+ * queued to replace them.  Once it is done, ir3_fixup_shader_state()
+ * makes the draws pick it up.
+ */
+struct ir3_shader_variant *
+ir3_shader_state_variant(struct ir3_shader_state *hwcso,
+                         struct ir3_shader_key key, bool binning_pass,
+                         struct util_debug_callback *debug)
+{
+   struct ir3_shader *shader = hwcso->shader;
+   bool fast_compile =
+      shader->initial_variants_done && fast_variants_enabled(debug);
+   bool created = false;
+
+   struct ir3_shader_variant *v =
+      get_variant(shader, key, binning_pass, fast_compile, debug, &created);
+
+   if (v && created && v->fast_compile) {
+      struct replace_variant_job *job = calloc(1, sizeof(*job));
+
+      if (job) {
+         job->hwcso = hwcso;
+         job->key = binning_pass ? v->nonbinning->key : v->key;
+         p_atomic_inc(&hwcso->replace_jobs);
+         util_queue_add_job(&hwcso->screen->compile_queue, job, NULL,
+                            replace_variant_async, replace_variant_cleanup, 0);
+      }
+   }
+
+   return v;
+}
+
 static void
 copy_stream_out(struct ir3_stream_output_info *i,
                 const struct pipe_stream_output_info *p)
@@ -343,6 +445,7 @@ ir3_shader_compute_state_create(struct pipe_context *pctx,
 
    util_queue_fence_init(&hwcso->ready);
    hwcso->shader = shader;
+   hwcso->screen = ctx->screen;
 
    /* Immediately compile a standard variant.  We have so few variants in our
     * shaders, that doing so almost eliminates draw-time recompiles.  (This
@@ -407,6 +510,7 @@ ir3_shader_state_create(struct pipe_context *pctx,
                               .real_wavesize = IR3_SINGLE_OR_DOUBLE,
                           },
                           &stream_output);
+   hwcso->screen = ctx->screen;
 
    /*
     * Create initial variants to avoid draw-time stalls.  This is
@@ -444,6 +548,10 @@ ir3_shader_state_delete(struct pipe_context *pctx, void *_hwcso)
     */
    util_queue_drop_job(&screen->compile_queue, &hwcso->ready);
 
+   /* Jobs replacing fast variants add to so->variants: */
+   if (p_atomic_read(&hwcso->replace_jobs))
+      util_queue_finish(&screen->compile_queue);
+
    /* free the uploaded shaders, since this is handled outside of the
     * shared ir3 code (ie. not used by turnip):
     */
@@ -515,6 +623,18 @@ ir3_fixup_shader_state(struct pipe_context *pctx, struct ir3_shader_key *key)
 
       *ctx->last.key = *key;
    }
+
+   /* Fast variants have been replaced, rebuild the program state that
+    * was built from them:
+    */
+   struct ir3_compiler *compiler = ctx->screen->compiler;
+   uint32_t variants_replaced = p_atomic_read(&compiler->variants_replaced);
+   if (unlikely(ctx->last.variants_replaced != variants_replaced)) {
+      ir3_cache_invalidate_fast(ctx->shader_cache);
+      fd_context_dirty_shader(ctx, PIPE_SHADER_VERTEX, FD_DIRTY_SHADER_PROG);
+      fd_context_dirty_shader(ctx, PIPE_SHADER_FRAGMENT, FD_DIRTY_SHADER_PROG);
+      ctx->last.variants_replaced = variants_replaced;
+   }
 }
 
 static char *
@@ -381,6 +381,7 @@ nv50_program_translate(struct nv50_program *prog, uint16_t chipset,
 #else
    info->optLevel = 4;
 #endif
+   info->fastRA = debug_get_bool_option("NV50_PROG_FAST_RA", false);
 
    ret = nv50_ir_generate_code(info, &info_out);
    if (ret) {
@@ -601,6 +601,7 @@ nvc0_program_translate(struct nvc0_program *prog, uint16_t chipset,
 #else
    info->optLevel = 4;
 #endif
+   info->fastRA = debug_get_bool_option("NV50_PROG_FAST_RA", false);
 
    info->bin.smemSize = prog->cp.smem_size;
    info->io.genUserClip = prog->vp.num_ucps;
@@ -68,12 +68,16 @@ r600_shader_from_nir(struct r600_context *rctx,
 
    struct r600_pipe_shader_selector *sel = pipeshader->selector;
 
+   r600::SfnCompileStats stats(_mesa_shader_stage_to_abbrev(sel->nir->info.stage));
+
    if (rctx->screen->b.debug_flags & DBG_PREOPT_IR) {
       fprintf(stderr, "PRE-OPT-NIR-----------.------------------------------\n");
       nir_print_shader(sel->nir, stderr);
       fprintf(stderr, "END PRE-OPT-NIR--------------------------------------\n\n");
    }
 
+   stats.step("nir");
+
    auto sh = nir_shader_clone(sel->nir, sel->nir);
 
    r600_lower_and_optimize_nir(sh, key, rctx->b.gfx_level, &sel->so);
@@ -107,6 +111,8 @@ r600_shader_from_nir(struct r600_context *rctx,
       gs_shader = &rctx->gs_shader->current->shader;
    r600_screen *rscreen = rctx->screen;
 
+   stats.step("from_nir");
+
    r600::Shader *shader =
       r600::Shader::translate_from_nir(sh, &sel->so, gs_shader, *key,
                                        rctx->isa->hw_class, rscreen->b.family);
@@ -121,8 +127,10 @@ r600_shader_from_nir(struct r600_context *rctx,
    pipeshader->selector->info.writes_memory =
       shader->has_flag(r600::Shader::sh_writes_memory);
 
+   stats.step("opt");
    r600_finalize_and_optimize_shader(shader);
 
+   stats.step("sched");
    auto scheduled_shader = r600_schedule_shader(shader);
    if (!scheduled_shader) {
       return -1;
@@ -148,6 +156,7 @@ r600_shader_from_nir(struct r600_context *rctx,
    pipeshader->shader.bc.isa = rctx->isa;
    pipeshader->shader.bc.ngpr = scheduled_shader->required_registers();
 
+   stats.step("asm");
    r600::Assembler afs(&pipeshader->shader, *key);
    if (!afs.lower(scheduled_shader)) {
       R600_ERR("%s: Lowering to assembly failed\n", __func__);
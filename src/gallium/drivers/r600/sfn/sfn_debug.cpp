@@ -26,6 +26,8 @@
 
 #include "sfn_debug.h"
 
+#include "sfn_memorypool.h"
+#include "util/os_time.h"
 #include "util/u_debug.h"
 
 namespace r600 {
@@ -65,6 +67,7 @@ static const struct debug_named_value sfn_debug_options[] = {
    {"opt",      SfnLog::opt,         "Log optimization"                     },
    {"steps",    SfnLog::steps,       "Log shaders at transformation steps"  },
    {"noopt",    SfnLog::noopt,       "Don't run backend optimizations"      },
+   {"stats",    SfnLog::stats,       "Print compile time and memory stats"  },
    {"warn" ,    SfnLog::warn,        "Print warnings"                       },
    DEBUG_NAMED_VALUE_END
 };
@@ -136,4 +139,65 @@ SfnTrace::~SfnTrace()
 
 int SfnTrace::m_indention = 0;
 
+SfnCompileStats::SfnCompileStats(const char *stage):
+    m_stage(stage),
+    m_enabled(sfn_log.has_debug_flag(SfnLog::stats)),
+    m_nsteps(0),
+    m_step_start(0),
+    m_step_bytes(0),
+    m_step_allocations(0)
+{
+}
+
+void
+SfnCompileStats::end_step()
+{
+   if (!m_nsteps)
+      return;
+
+   auto& pool = MemoryPool::instance().stats();
+   auto& s = m_steps[m_nsteps - 1];
+   s.time_ns = os_time_get_nano() - m_step_start;
+   s.bytes = pool.bytes - m_step_bytes;
+   s.allocations = pool.allocations - m_step_allocations;
+}
+
+void
+SfnCompileStats::step(const char *name)
+{
+   if (!m_enabled || m_nsteps == ARRAY_SIZE(m_steps))
+      return;
+
+   end_step();
+
+   auto& pool = MemoryPool::instance().stats();
+   m_steps[m_nsteps++] = {name, 0, 0, 0};
+   m_step_bytes = pool.bytes;
+   m_step_allocations = pool.allocations;
+   m_step_start = os_time_get_nano();
+}
+
+SfnCompileStats::~SfnCompileStats()
+{
+   if (!m_enabled)
+      return;
+
+   end_step();
+
+   uint64_t total_ns = 0;
+   size_t total_bytes = 0;
+
+   fprintf(stderr, "SFN %s:", m_stage);
+   for (int i = 0; i < m_nsteps; ++i) {
+      auto& s = m_steps[i];
+      fprintf(stderr, " %s %.3fms %zuKiB/%zu",
+              s.name, s.time_ns / 1e6, s.bytes / 1024, s.allocations);
+      total_ns += s.time_ns;
+      total_bytes += s.bytes;
+   }
+   fprintf(stderr, ", total %.3fms %zuKiB, pool %zuKiB\n",
+           total_ns / 1e6, total_bytes / 1024,
+           MemoryPool::instance().stats().capacity / 1024);
+}
+
 } // namespace r600
@@ -70,6 +70,7 @@ public:
       nomerge = 1 << 16,
       steps = 1 << 17,
       noopt = 1 << 18,
+      stats = 1 << 19,
       warn = 1 << 20,
    };
 
@@ -122,6 +123,35 @@ private:
    static int m_indention;
 };
 
+/* Collect the time and the memory pool usage of the steps of one shader
+ * compile, printed when the "stats" debug flag is set */
+class SfnCompileStats {
+public:
+   SfnCompileStats(const char *stage);
+   ~SfnCompileStats();
+
+   /* End the current step and start a new one */
+   void step(const char *name);
+
+private:
+   void end_step();
+
+   struct Step {
+      const char *name;
+      uint64_t time_ns;
+      size_t bytes;
+      size_t allocations;
+   };
+
+   const char *m_stage;
+   bool m_enabled;
+   Step m_steps[8];
+   int m_nsteps;
+   uint64_t m_step_start;
+   size_t m_step_bytes;
+   size_t m_step_allocations;
+};
+
 #ifndef NDEBUG
 #define SFN_TRACE_FUNC(LEVEL, MSG) SfnTrace __trace(LEVEL, MSG)
 #else
@@ -26,6 +26,9 @@
 
 #include "sfn_memorypool.h"
 
+#include "util/macros.h"
+#include "util/u_math.h"
+
 #include <cassert>
 #include <iostream>
 
@@ -38,6 +41,12 @@
 
 namespace r600 {
 
+/* The first buffer of the pool is kept between compiles, start with this
+ * and grow it up to the given limit depending on what earlier compiles
+ * needed. */
+static const size_t min_pool_size = 64 * 1024;
+static const size_t max_pool_size = 8 * 1024 * 1024;
+
 #ifndef HAVE_MEMORY_RESOURCE
 /* Fallback memory resource if the C++17 memory resource is not
  * available
@@ -46,23 +55,32 @@ struct MemoryBacking {
    ~MemoryBacking();
    void *allocate(size_t size);
    void *allocate(size_t size, size_t align);
+   void release();
    std::list<void *> m_data;
 };
 #endif
 
 struct MemoryPoolImpl {
 public:
-   MemoryPoolImpl();
+   MemoryPoolImpl(size_t size);
    ~MemoryPoolImpl();
 #ifdef HAVE_MEMORY_RESOURCE
    using MemoryBacking = ::std::pmr::monotonic_buffer_resource;
 #endif
    MemoryBacking *pool;
+   void *buffer;
+   size_t size;
 };
 
 MemoryPool::MemoryPool() noexcept:
-    impl(nullptr)
+    impl(nullptr),
+    m_stats{0, 0, min_pool_size}
+{
+}
+
+MemoryPool::~MemoryPool()
 {
+   free();
 }
 
 MemoryPool&
@@ -79,17 +97,37 @@ MemoryPool::free()
    impl = nullptr;
 }
 
+void
+MemoryPool::reset()
+{
+   if (!impl)
+      return;
+
+   if (m_stats.bytes > impl->size && impl->size < max_pool_size) {
+      /* Re-create with a bigger first buffer on the next initialize() */
+      m_stats.capacity =
+         MIN2(util_next_power_of_two64(m_stats.bytes), max_pool_size);
+      free();
+   } else {
+      impl->pool->release();
+   }
+}
+
 void
 MemoryPool::initialize()
 {
    if (!impl)
-      impl = new MemoryPoolImpl();
+      impl = new MemoryPoolImpl(m_stats.capacity);
+   m_stats.bytes = 0;
+   m_stats.allocations = 0;
 }
 
 void *
 MemoryPool::allocate(size_t size)
 {
    assert(impl);
+   m_stats.bytes += size;
+   m_stats.allocations++;
    return impl->pool->allocate(size);
 }
 
@@ -97,13 +135,15 @@ void *
 MemoryPool::allocate(size_t size, size_t align)
 {
    assert(impl);
+   m_stats.bytes += size;
+   m_stats.allocations++;
    return impl->pool->allocate(size, align);
 }
 
 void
 MemoryPool::release_all()
 {
-   instance().free();
+   instance().reset();
 }
 
 void
@@ -130,15 +170,40 @@ Allocate::operator delete(void *p, size_t size)
    // MemoryPool::instance().deallocate(p, size);
 }
 
-MemoryPoolImpl::MemoryPoolImpl() { pool = new MemoryBacking(); }
+#ifdef HAVE_MEMORY_RESOURCE
+MemoryPoolImpl::MemoryPoolImpl(size_t size):
+    buffer(malloc(size)),
+    size(buffer ? size : 0)
+{
+   pool = buffer ? new MemoryBacking(buffer, size) : new MemoryBacking();
+}
+#else
+MemoryPoolImpl::MemoryPoolImpl(size_t size):
+    buffer(nullptr),
+    size(size)
+{
+   pool = new MemoryBacking();
+}
+#endif
 
-MemoryPoolImpl::~MemoryPoolImpl() { delete pool; }
+MemoryPoolImpl::~MemoryPoolImpl()
+{
+   delete pool;
+   ::free(buffer);
+}
 
 #ifndef HAVE_MEMORY_RESOURCE
 MemoryBacking::~MemoryBacking()
+{
+   release();
+}
+
+void
+MemoryBacking::release()
 {
    for (auto p : m_data)
       free(p);
+   m_data.clear();
 }
 
 void *
@@ -46,21 +46,40 @@ public:
    void operator delete(void *p, size_t size);
 };
 
+struct MemoryPoolStats {
+   /* Bytes and number of allocations since the last initialize() */
+   size_t bytes;
+   size_t allocations;
+   /* Size of the buffer that is kept between compiles */
+   size_t capacity;
+};
+
 class MemoryPool {
 public:
    static MemoryPool& instance();
    static void release_all();
 
+   ~MemoryPool();
+
+   /* Drop all memory, including the buffer kept for reuse */
    void free();
+
+   /* Drop all allocations but keep the backing buffer for the next
+    * compile on this thread, growing it if this compile needed more */
+   void reset();
+
    void initialize();
 
    void *allocate(size_t size);
    void *allocate(size_t size, size_t align);
 
+   const MemoryPoolStats& stats() const { return m_stats; }
+
 private:
    MemoryPool() noexcept;
 
    struct MemoryPoolImpl *impl;
+   MemoryPoolStats m_stats;
 };
 
 template <typename T> struct Allocator {
@@ -195,6 +195,7 @@ private:
    template <typename I> bool schedule_block(std::list<I *>& ready_list);
 
    void update_array_writes(const AluGroup& group);
+   int register_priority_weight() const;
    bool check_array_reads(const AluInstr& instr);
    bool check_array_reads(const AluGroup& group);
 
@@ -243,6 +244,8 @@ private:
 
    ArrayCheckSet m_last_indirect_array_write;
    ArrayCheckSet m_last_direct_array_write;
+
+   LiveValueTracker m_live_values;
 };
 
 Shader *
@@ -328,6 +331,8 @@ BlockScheduler::schedule_block(Block& in_block,
    CollectInstructions cir(vf);
    in_block.accept(cir);
 
+   m_live_values.clear();
+
    bool have_instr = collect_ready(cir);
 
    m_current_block = new Block(in_block.nesting_depth(), m_next_block_id++);
@@ -685,6 +690,7 @@ BlockScheduler::schedule_alu(Shader::ShaderBlocks& out_blocks)
    m_current_block->push_back(group);
 
    update_array_writes(*group);
+   m_live_values.scheduled(*group);
 
    m_idx0_pending |= m_idx0_loading;
    m_idx0_loading = false;
@@ -731,10 +737,12 @@ BlockScheduler::schedule_tex(Shader::ShaderBlocks& out_blocks)
       for (auto prep : (*ii)->prepare_instr()) {
          prep->set_scheduled();
          m_current_block->push_back(prep);
+         m_live_values.scheduled(*prep);
       }
 
       (*ii)->set_scheduled();
       m_current_block->push_back(*ii);
+      m_live_values.scheduled(**ii);
       tex_ready.erase(ii);
       return true;
    }
@@ -983,6 +991,7 @@ BlockScheduler::schedule(std::list<I *>& ready_list)
       sfn_log << SfnLog::schedule << "Schedule: " << **ii << "\n";
       (*ii)->set_scheduled();
       m_current_block->push_back(*ii);
+      m_live_values.scheduled(**ii);
       ready_list.erase(ii);
       return true;
    }
@@ -1000,6 +1009,7 @@ BlockScheduler::schedule_block(std::list<I *>& ready_list)
               << m_current_block->remaining_slots() << "\n";
       (*ii)->set_scheduled();
       m_current_block->push_back(*ii);
+      m_live_values.scheduled(**ii);
       ready_list.erase(ii);
       success = true;
    }
@@ -1018,6 +1028,7 @@ BlockScheduler::schedule_exports(Shader::ShaderBlocks& out_blocks,
       sfn_log << SfnLog::schedule << "Schedule: " << **ii << "\n";
       (*ii)->set_scheduled();
       m_current_block->push_back(*ii);
+      m_live_values.scheduled(**ii);
       switch ((*ii)->export_type()) {
       case ExportInstr::pos:
          m_last_pos = *ii;
@@ -1056,6 +1067,32 @@ BlockScheduler::collect_ready(CollectInstructions& available)
    return result;
 }
 
+/* Each GPR holds four channels, and every live SSA value takes one of them.
+ * The GPRs of a SIMD are shared by all threads in flight, so the number of
+ * threads starts to go down long before RA runs out of registers.
+ */
+static const unsigned live_value_capacity = 4 * VirtualValue::gpr_register_end;
+static const unsigned moderate_register_pressure = live_value_capacity / 4;
+static const unsigned high_register_pressure = 3 * live_value_capacity / 8;
+
+/* The register priority is scaled by how many values the schedule currently
+ * keeps alive: at low pressure it only breaks ties between otherwise equal
+ * instructions, but with increasing pressure instructions that end live
+ * ranges are preferred over those that start new ones. The weight stays
+ * below the priorities given to LDS and indirect access instructions.
+ */
+int
+BlockScheduler::register_priority_weight() const
+{
+   const unsigned num_live = m_live_values.size();
+
+   if (num_live > high_register_pressure)
+      return 1000;
+   if (num_live > moderate_register_pressure)
+      return 300;
+   return 100;
+}
+
 bool
 BlockScheduler::collect_ready_alu_vec(std::list<AluInstr *>& ready,
                                      std::list<AluInstr *>& available)
@@ -1063,8 +1100,10 @@ BlockScheduler::collect_ready_alu_vec(std::list<AluInstr *>& ready,
    auto i = available.begin();
    auto e = available.end();
 
+   const int register_weight = register_priority_weight();
+
    for (auto alu : ready) {
-      alu->add_priority(100 * alu->register_priority());
+      alu->add_priority(register_weight * alu->register_priority());
    }
 
    int max_check = 0;
@@ -1108,7 +1147,7 @@ BlockScheduler::collect_ready_alu_vec(std::list<AluInstr *>& ready,
                priority = -1;
          }
 
-         priority += 100 * (*i)->register_priority();
+         priority += register_weight * (*i)->register_priority();
 
          (*i)->add_priority(priority);
          ready.push_back(*i);
@@ -1317,4 +1356,113 @@ bool BlockScheduler::check_array_reads(const AluGroup& group)
 }
 
 
+class LiveValueTracker::Visitor : public ConstInstrVisitor {
+public:
+   Visitor(LiveValueTracker& tracker):
+       m_tracker(tracker)
+   {
+   }
+
+   void visit(const AluInstr& instr) override
+   {
+      m_tracker.end_reads(instr);
+      if (instr.has_alu_flag(alu_write))
+         m_tracker.add(instr.dest());
+   }
+
+   void visit(const AluGroup& instr) override
+   {
+      for (auto alu : instr) {
+         if (alu)
+            visit(*alu);
+      }
+   }
+
+   void visit(const TexInstr& instr) override { vector_result(instr); }
+   void visit(const FetchInstr& instr) override { vector_result(instr); }
+
+   void visit(const GDSInstr& instr) override
+   {
+      m_tracker.end_reads(instr);
+      m_tracker.add(instr.dest());
+   }
+
+   void visit(const LDSAtomicInstr& instr) override
+   {
+      m_tracker.end_reads(instr);
+      m_tracker.add(instr.dest());
+   }
+
+   void visit(const ExportInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const Block& instr) override { m_tracker.end_reads(instr); }
+   void visit(const ControlFlowInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const IfInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const ScratchIOInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const StreamOutInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const MemRingOutInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const EmitVertexInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const WriteTFInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const LDSReadInstr& instr) override { m_tracker.end_reads(instr); }
+   void visit(const RatInstr& instr) override { m_tracker.end_reads(instr); }
+
+private:
+   void vector_result(const InstrWithVectorResult& instr)
+   {
+      m_tracker.end_reads(instr);
+      for (int i = 0; i < 4; ++i)
+         m_tracker.add(instr.dst()[i]);
+   }
+
+   LiveValueTracker& m_tracker;
+};
+
+void
+LiveValueTracker::clear()
+{
+   m_num_readers.clear();
+   m_reads.clear();
+}
+
+void
+LiveValueTracker::scheduled(const Instr& instr)
+{
+   Visitor visitor(*this);
+   instr.accept(visitor);
+}
+
+void
+LiveValueTracker::add(const Register *reg)
+{
+   if (!reg || !reg->has_flag(Register::ssa) ||
+       reg->has_flag(Register::addr_or_idx) || m_num_readers.count(reg))
+      return;
+
+   unsigned num_readers = 0;
+   for (auto use : reg->uses()) {
+      if (!use->is_scheduled()) {
+         m_reads[use].push_back(reg);
+         ++num_readers;
+      }
+   }
+
+   if (num_readers)
+      m_num_readers[reg] = num_readers;
+}
+
+void
+LiveValueTracker::end_reads(const Instr& instr)
+{
+   auto reads = m_reads.find(&instr);
+   if (reads == m_reads.end())
+      return;
+
+   for (auto reg : reads->second) {
+      auto num_readers = m_num_readers.find(reg);
+      if (--num_readers->second == 0)
+         m_num_readers.erase(num_readers);
+   }
+
+   m_reads.erase(reads);
+}
+
 } // namespace r600
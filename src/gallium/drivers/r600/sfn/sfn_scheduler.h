@@ -29,11 +29,38 @@
 
 #include "sfn_shader.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace r600 {
 
 Shader *
 schedule(Shader *original);
 
+/* Estimates the register pressure of a partial schedule by tracking the SSA
+ * values written by the instructions scheduled so far that still have
+ * readers which are not scheduled yet. Instructions of any type must be
+ * passed to scheduled() after they have been marked as scheduled.
+ */
+class LiveValueTracker {
+public:
+   void clear();
+   void scheduled(const Instr& instr);
+   size_t size() const { return m_num_readers.size(); }
+
+private:
+   class Visitor;
+
+   void add(const Register *reg);
+   void end_reads(const Instr& instr);
+
+   /* Number of unscheduled readers of every live value */
+   std::unordered_map<const Register *, unsigned> m_num_readers;
+
+   /* Live values read by every unscheduled reader */
+   std::unordered_map<const Instr *, std::vector<const Register *>> m_reads;
+};
+
 }
 
 #endif // SCHEDULER_H
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "../sfn_scheduler.h"
+#include "../sfn_shader.h"
+#include "sfn_test_shaders.h"
+
+using namespace r600;
+
+class LiveValueTrackerTest : public TestShader {
+protected:
+   /* Schedules the instructions of the shader in program order and returns
+    * the number of live values after each of them. */
+   std::vector<size_t> live_values_after_each(Shader *sh);
+};
+
+std::vector<size_t>
+LiveValueTrackerTest::live_values_after_each(Shader *sh)
+{
+   LiveValueTracker tracker;
+   std::vector<size_t> result;
+
+   for (auto block : sh->func()) {
+      for (auto instr : *block) {
+         instr->set_scheduled();
+         tracker.scheduled(*instr);
+         result.push_back(tracker.size());
+      }
+   }
+   return result;
+}
+
+TEST_F(LiveValueTrackerTest, TexReadEndsLiveRange)
+{
+   const char *shader_input =
+      R"(FS
+CHIPCLASS EVERGREEN
+PROP MAX_COLOR_EXPORTS:1
+PROP COLOR_EXPORTS:1
+PROP COLOR_EXPORT_MASK:15
+OUTPUT LOC:0 FRAG_RESULT:2 MASK:15
+SHADER
+ALU MOV S1.x@group : KC0[0].x {W}
+ALU MOV S1.y@group : KC0[0].y {W}
+ALU MOV S1.z@group : KC0[0].z {W}
+ALU MOV S1.w@group : KC0[0].w {WL}
+TEX SAMPLE S2.xyzw : S1.xyzw RID:18 SID:0 NNNN
+EXPORT_DONE PIXEL 0 S2.xyzw
+)";
+
+   auto sh = from_string(shader_input);
+
+   /* The texture instruction is the only reader of S1, and the export the
+    * only reader of S2. */
+   std::vector<size_t> expect = {1, 2, 3, 4, 4, 0};
+   EXPECT_EQ(live_values_after_each(sh), expect);
+}
+
+TEST_F(LiveValueTrackerTest, AluAndTexReaders)
+{
+   const char *shader_input =
+      R"(FS
+CHIPCLASS EVERGREEN
+PROP MAX_COLOR_EXPORTS:1
+PROP COLOR_EXPORTS:1
+PROP COLOR_EXPORT_MASK:15
+OUTPUT LOC:0 FRAG_RESULT:2 MASK:15
+SHADER
+ALU MOV S1.x@group : KC0[0].x {W}
+ALU MOV S1.y@group : KC0[0].y {WL}
+ALU MOV S3.x : S1.x {WL}
+TEX SAMPLE S2.xyzw : S1.xy__ RID:18 SID:0 NNNN
+ALU ADD S4.x@group : S2.x S3.x {W}
+ALU MOV S4.y@group : S2.y {W}
+ALU MOV S4.z@group : S2.z {W}
+ALU MOV S4.w@group : S2.w {WL}
+EXPORT_DONE PIXEL 0 S4.xyzw
+)";
+
+   auto sh = from_string(shader_input);
+
+   /* S1.x stays live after the ALU read until the texture instruction is
+    * scheduled, and S3.x stays live across it until the ADD. */
+   std::vector<size_t> expect = {1, 2, 3, 5, 4, 4, 4, 4, 0};
+   EXPECT_EQ(live_values_after_each(sh), expect);
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Checks that translate_avx2 gives the same bytes as translate_generic for
+ * every run function, with partial batches, clamped indices, instanced
+ * attributes and instance IDs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "translate/translate.h"
+#include "util/format/u_format.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+
+#define NUM_VERTICES 64
+#define MAX_COUNT 37
+#define MAX_STRIDE 64
+
+static const enum pipe_format input_formats[] = {
+   PIPE_FORMAT_R8_UNORM,
+   PIPE_FORMAT_R8G8_SNORM,
+   PIPE_FORMAT_R8G8B8_UNORM,
+   PIPE_FORMAT_R8G8B8A8_UNORM,
+   PIPE_FORMAT_B8G8R8A8_UNORM,
+   PIPE_FORMAT_R8G8B8A8_SNORM,
+   PIPE_FORMAT_R8G8B8A8_USCALED,
+   PIPE_FORMAT_R8G8B8A8_SSCALED,
+   PIPE_FORMAT_R16_UNORM,
+   PIPE_FORMAT_R16G16_SNORM,
+   PIPE_FORMAT_R16G16B16_USCALED,
+   PIPE_FORMAT_R16G16B16A16_UNORM,
+   PIPE_FORMAT_R16G16B16A16_SSCALED,
+   PIPE_FORMAT_R10G10B10A2_UNORM,
+   PIPE_FORMAT_B10G10R10A2_UNORM,
+   PIPE_FORMAT_R10G10B10A2_SNORM,
+   PIPE_FORMAT_R32_FLOAT,
+   PIPE_FORMAT_R32G32_FLOAT,
+   PIPE_FORMAT_R32G32B32_FLOAT,
+   PIPE_FORMAT_R32G32B32A32_FLOAT,
+};
+
+static const enum pipe_format output_formats[] = {
+   PIPE_FORMAT_R32_FLOAT,
+   PIPE_FORMAT_R32G32_FLOAT,
+   PIPE_FORMAT_R32G32B32_FLOAT,
+   PIPE_FORMAT_R32G32B32A32_FLOAT,
+};
+
+static const unsigned counts[] = { 1, 3, 7, 8, 9, 16, 17, MAX_COUNT };
+
+enum run_func {
+   RUN,
+   RUN_ELTS,
+   RUN_ELTS16,
+   RUN_ELTS8,
+};
+
+static const char *run_func_names[] = {
+   "run", "run_elts", "run_elts16", "run_elts8",
+};
+
+static uint8_t *vertex_buffer;
+static uint8_t *instance_buffer;
+static unsigned elts[MAX_COUNT];
+static uint16_t elts16[MAX_COUNT];
+static uint8_t elts8[MAX_COUNT];
+
+static void
+fill_buffer(uint8_t *buf, unsigned size, bool is_float)
+{
+   if (is_float) {
+      float *f = (float *)buf;
+
+      for (unsigned i = 0; i < size / sizeof(float); i++)
+         f[i] = (float)(rand() - RAND_MAX / 2) / 1024.0f;
+   } else {
+      for (unsigned i = 0; i < size; i++)
+         buf[i] = rand();
+   }
+}
+
+static void
+run(struct translate *t, enum run_func func, unsigned count,
+    unsigned instance_id, uint8_t *out)
+{
+   const unsigned start_instance = 2;
+
+   switch (func) {
+   case RUN:
+      t->run(t, 5, count, start_instance, instance_id, out);
+      break;
+   case RUN_ELTS:
+      t->run_elts(t, elts, count, start_instance, instance_id, out);
+      break;
+   case RUN_ELTS16:
+      t->run_elts16(t, elts16, count, start_instance, instance_id, out);
+      break;
+   case RUN_ELTS8:
+      t->run_elts8(t, elts8, count, start_instance, instance_id, out);
+      break;
+   }
+}
+
+/**
+ * Translate with both implementations and compare the whole output
+ * buffers, so that writes past the last vertex are caught too.
+ */
+static bool
+test_key(const struct translate_key *key, unsigned vertex_stride,
+         unsigned instance_stride, unsigned *num_tested)
+{
+   static uint8_t out_avx2[MAX_COUNT * MAX_STRIDE + MAX_STRIDE];
+   static uint8_t out_generic[MAX_COUNT * MAX_STRIDE + MAX_STRIDE];
+   struct translate *avx2 = translate_avx2_create(key);
+   struct translate *generic = translate_generic_create(key);
+   bool pass = true;
+
+   if (!avx2) {
+      generic->release(generic);
+      return true;
+   }
+
+   /* Leave the last few vertices out of range, so that indices past
+    * max_index are clamped.
+    */
+   avx2->set_buffer(avx2, 0, vertex_buffer, vertex_stride, NUM_VERTICES - 5);
+   generic->set_buffer(generic, 0, vertex_buffer, vertex_stride,
+                       NUM_VERTICES - 5);
+   avx2->set_buffer(avx2, 1, instance_buffer, instance_stride, 3);
+   generic->set_buffer(generic, 1, instance_buffer, instance_stride, 3);
+
+   for (unsigned f = RUN; f <= RUN_ELTS8; f++) {
+      for (unsigned c = 0; c < ARRAY_SIZE(counts); c++) {
+         for (unsigned instance_id = 0; instance_id < 6; instance_id += 5) {
+            memset(out_avx2, 0xcd, sizeof(out_avx2));
+            memset(out_generic, 0xcd, sizeof(out_generic));
+
+            run(avx2, f, counts[c], instance_id, out_avx2);
+            run(generic, f, counts[c], instance_id, out_generic);
+
+            if (memcmp(out_avx2, out_generic, sizeof(out_avx2))) {
+               printf("FAIL: %s -> %s, %s, count %u, instance %u\n",
+                      util_format_name(key->element[0].input_format),
+                      util_format_name(key->element[0].output_format),
+                      run_func_names[f], counts[c], instance_id);
+               pass = false;
+            }
+         }
+      }
+   }
+
+   avx2->release(avx2);
+   generic->release(generic);
+   (*num_tested)++;
+
+   return pass;
+}
+
+int
+main(int argc, char **argv)
+{
+   unsigned num_tested = 0;
+   bool pass = true;
+
+   if (!util_get_cpu_caps()->has_avx2) {
+      printf("SKIP: no AVX2\n");
+      return 77;
+   }
+
+   vertex_buffer = MALLOC(NUM_VERTICES * MAX_STRIDE);
+   instance_buffer = MALLOC(NUM_VERTICES * MAX_STRIDE);
+
+   srand(4359025);
+
+   for (unsigned i = 0; i < MAX_COUNT; i++) {
+      elts[i] = rand() % NUM_VERTICES;
+      elts16[i] = elts[i];
+      elts8[i] = elts[i];
+   }
+
+   for (unsigned i = 0; i < ARRAY_SIZE(input_formats); i++) {
+      const enum pipe_format input_format = input_formats[i];
+      const struct util_format_description *desc =
+         util_format_description(input_format);
+      const bool is_float = desc->channel[0].type == UTIL_FORMAT_TYPE_FLOAT;
+      const unsigned input_size = util_format_get_blocksize(input_format);
+
+      /* An odd stride and offset give unaligned gathers. */
+      const unsigned vertex_stride = input_size + 3;
+      const unsigned instance_stride = 16;
+
+      fill_buffer(vertex_buffer, NUM_VERTICES * MAX_STRIDE, is_float);
+      fill_buffer(instance_buffer, NUM_VERTICES * MAX_STRIDE, false);
+
+      for (unsigned o = 0; o < ARRAY_SIZE(output_formats); o++) {
+         const enum pipe_format output_format = output_formats[o];
+         const unsigned output_size = util_format_get_blocksize(output_format);
+         struct translate_key key;
+
+         memset(&key, 0, sizeof(key));
+         key.nr_elements = 4;
+
+         /* The attribute under test. */
+         key.element[0].type = TRANSLATE_ELEMENT_NORMAL;
+         key.element[0].input_format = input_format;
+         key.element[0].output_format = output_format;
+         key.element[0].input_buffer = 0;
+         key.element[0].input_offset = 1;
+         key.element[0].output_offset = 0;
+
+         /* A copy of the same vertices. */
+         key.element[1].type = TRANSLATE_ELEMENT_NORMAL;
+         key.element[1].input_format = input_format;
+         key.element[1].output_format = input_format;
+         key.element[1].input_buffer = 0;
+         key.element[1].input_offset = 1;
+         key.element[1].output_offset = output_size;
+
+         /* An instanced attribute. */
+         key.element[2].type = TRANSLATE_ELEMENT_NORMAL;
+         key.element[2].input_format = PIPE_FORMAT_R8G8B8A8_UNORM;
+         key.element[2].output_format = PIPE_FORMAT_R32G32B32A32_FLOAT;
+         key.element[2].input_buffer = 1;
+         key.element[2].input_offset = 4;
+         key.element[2].instance_divisor = 3;
+         key.element[2].output_offset = output_size + input_size;
+
+         key.element[3].type = TRANSLATE_ELEMENT_INSTANCE_ID;
+         key.element[3].input_format = PIPE_FORMAT_R32_USCALED;
+         key.element[3].output_format = PIPE_FORMAT_R32_FLOAT;
+         key.element[3].output_offset = output_size + input_size + 16;
+
+         key.output_stride = output_size + input_size + 20;
+         assert(key.output_stride <= MAX_STRIDE);
+
+         pass = test_key(&key, vertex_stride, instance_stride,
+                         &num_tested) && pass;
+      }
+   }
+
+   FREE(vertex_buffer);
+   FREE(instance_buffer);
+
+   printf("%u keys tested\n", num_tested);
+
+   /* Every format above is one translate_avx2 is meant to handle. */
+   if (num_tested != ARRAY_SIZE(input_formats) * ARRAY_SIZE(output_formats)) {
+      printf("FAIL: translate_avx2 rejected some keys\n");
+      pass = false;
+   }
+
+   return pass ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Checks that the AVX2 index translators u_index_init() installs give the
+ * same output as the generated ones they replace, with and without
+ * primitive restart, for nonzero starts and for out_nr past the end of the
+ * input primitives.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "indices/u_indices.h"
+#include "indices/u_indices_priv.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_prim.h"
+
+#define MAX_NR 300
+/* Room for the widest output, including the restart fill. */
+#define BUFFER_SIZE (4 * (3 * MAX_NR + 16))
+
+static const enum mesa_prim prims[] = {
+   MESA_PRIM_QUADS,
+   MESA_PRIM_QUAD_STRIP,
+   MESA_PRIM_TRIANGLE_FAN,
+   MESA_PRIM_POLYGON,
+};
+
+static const unsigned in_sizes[IN_COUNT] = { 1, 2, 4 };
+
+static uint8_t in[BUFFER_SIZE];
+static uint8_t out_simd[BUFFER_SIZE];
+static uint8_t out_generic[BUFFER_SIZE];
+
+static unsigned
+restart_index(unsigned in_size)
+{
+   return in_size == 4 ? 0xffffffff : (1u << (in_size * 8)) - 1;
+}
+
+/**
+ * Fill the input with random indices, with restarts in about one of every
+ * \p density * 10 when \p density isn't 0.
+ */
+static void
+fill_input(unsigned in_size, unsigned nr, unsigned density)
+{
+   const unsigned restart = restart_index(in_size);
+
+   for (unsigned i = 0; i < nr; i++) {
+      unsigned v = rand();
+
+      if (in_size == 4 && rand() % 2)
+         v |= 0x80000000;
+      if (density && rand() % (density * 10) == 0)
+         v = restart;
+
+      switch (in_size) {
+      case 1: in[i] = v; break;
+      case 2: ((uint16_t *)in)[i] = v; break;
+      case 4: ((uint32_t *)in)[i] = v; break;
+      }
+   }
+}
+
+static unsigned
+converted_nr(enum mesa_prim prim, unsigned nr)
+{
+   switch (prim) {
+   case MESA_PRIM_QUADS:
+      return nr / 4 * 6;
+   case MESA_PRIM_QUAD_STRIP:
+      return nr >= 4 ? (nr - 2) / 2 * 6 : 0;
+   default:
+      return nr >= 3 ? (nr - 2) * 3 : 0;
+   }
+}
+
+static bool
+test_translators(unsigned *num_checks)
+{
+   bool pass = true;
+
+   for (unsigned p = 0; p < ARRAY_SIZE(prims); p++) {
+      for (unsigned in_idx = 0; in_idx < IN_COUNT; in_idx++) {
+         for (unsigned out_idx = 0; out_idx < OUT_COUNT; out_idx++) {
+            for (unsigned in_pv = 0; in_pv < PV_COUNT; in_pv++) {
+               for (unsigned out_pv = 0; out_pv < PV_COUNT; out_pv++) {
+                  for (unsigned pr = 0; pr < PR_COUNT; pr++) {
+                     const enum mesa_prim prim = prims[p];
+                     const unsigned in_size = in_sizes[in_idx];
+                     u_translate_func simd =
+                        u_index_lookup_translate(in_idx, out_idx, in_pv,
+                                                 out_pv, pr, prim, true);
+                     u_translate_func generic =
+                        u_index_lookup_translate(in_idx, out_idx, in_pv,
+                                                 out_pv, pr, prim, false);
+
+                     /* Only the restart translators are replaced. */
+                     if ((simd != generic) != (pr == PR_ENABLE)) {
+                        printf("FAIL: %s in %u out %u pv %u/%u pr %u %s\n",
+                               u_prim_name(prim), in_size, out_idx,
+                               in_pv, out_pv, pr,
+                               simd == generic ? "not replaced" :
+                                                 "replaced");
+                        pass = false;
+                        continue;
+                     }
+
+                     const unsigned nr = rand() % MAX_NR;
+                     const unsigned start = rand() % 8;
+                     const unsigned in_nr = start + nr;
+                     unsigned out_nr = converted_nr(prim, nr);
+
+                     /* With restart, extra output is filled with the
+                      * restart index.
+                      */
+                     if (pr && rand() % 3 == 0)
+                        out_nr += 3 * (rand() % 4);
+
+                     fill_input(in_size, in_nr + 16, pr ? rand() % 4 : 0);
+
+                     memset(out_simd, 0xcd, sizeof(out_simd));
+                     memset(out_generic, 0xcd, sizeof(out_generic));
+
+                     simd(in, start, in_nr, out_nr, restart_index(in_size),
+                          out_simd);
+                     generic(in, start, in_nr, out_nr, restart_index(in_size),
+                             out_generic);
+                     (*num_checks)++;
+
+                     if (memcmp(out_simd, out_generic, sizeof(out_simd))) {
+                        printf("FAIL: %s in %u out %u pv %u/%u pr %u "
+                               "nr %u start %u out_nr %u\n",
+                               u_prim_name(prim), in_size, out_idx,
+                               in_pv, out_pv, pr, nr, start, out_nr);
+                        pass = false;
+                     }
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   return pass;
+}
+
+/**
+ * The 8 to 16-bit copy u_index_translator() returns when only the index
+ * size changes.
+ */
+static bool
+test_byte_to_ushort(unsigned *num_checks)
+{
+   enum mesa_prim out_prim;
+   unsigned out_index_size, out_nr;
+   u_translate_func func;
+   const unsigned nr = rand() % 500;
+   const unsigned start = rand() % 8;
+   const uint16_t *out = (const uint16_t *)out_simd;
+
+   u_index_translator(1 << MESA_PRIM_TRIANGLES, MESA_PRIM_TRIANGLES, 1, nr,
+                      PV_FIRST, PV_FIRST, PR_DISABLE, &out_prim,
+                      &out_index_size, &out_nr, &func);
+
+   fill_input(1, start + nr, 0);
+   memset(out_simd, 0xcd, sizeof(out_simd));
+   func(in, start, start + nr, out_nr, 0, out_simd);
+   (*num_checks)++;
+
+   for (unsigned i = 0; i < nr; i++) {
+      if (out[i] != in[start + i]) {
+         printf("FAIL: byte to ushort, nr %u start %u index %u\n",
+                nr, start, i);
+         return false;
+      }
+   }
+
+   if (out[nr] != 0xcdcd) {
+      printf("FAIL: byte to ushort, nr %u start %u overrun\n", nr, start);
+      return false;
+   }
+
+   return true;
+}
+
+int
+main(int argc, char **argv)
+{
+   unsigned num_checks = 0;
+   bool pass = true;
+
+   if (!util_get_cpu_caps()->has_avx2) {
+      printf("SKIP: no AVX2\n");
+      return 77;
+   }
+
+   srand(1);
+
+   for (unsigned iter = 0; iter < 1000 && pass; iter++) {
+      pass = test_translators(&num_checks) && pass;
+      pass = test_byte_to_ushort(&num_checks) && pass;
+   }
+
+   printf("%u checks\n", num_checks);
+
+   return pass ? 0 : 1;
+}
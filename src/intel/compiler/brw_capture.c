@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file brw_capture.c
+ *
+ * Serialization of brw_compile_* inputs so that shaders seen by a driver
+ * can be recompiled offline without a GPU, see brw_compile_bench.c.
+ */
+
+#include <stdio.h>
+
+#include "brw_capture.h"
+#include "brw_compiler.h"
+#include "compiler/nir/nir.h"
+#include "compiler/nir/nir_serialize.h"
+#include "dev/intel_device_info.h"
+#include "util/blob.h"
+#include "util/mesa-sha1.h"
+#include "util/ralloc.h"
+#include "util/u_debug.h"
+
+DEBUG_GET_ONCE_OPTION(shader_capture_path, "INTEL_SHADER_CAPTURE_PATH", NULL);
+
+bool
+brw_should_capture_shader(void)
+{
+   return debug_get_option_shader_capture_path() != NULL;
+}
+
+void
+brw_capture_shader(const struct brw_capture *capture,
+                   const struct nir_shader *nir)
+{
+   const struct brw_stage_prog_data *prog_data = capture->prog_data;
+   struct blob blob;
+
+   blob_init(&blob);
+
+   blob_write_uint32(&blob, BRW_CAPTURE_MAGIC);
+   blob_write_uint32(&blob, BRW_CAPTURE_VERSION);
+   blob_write_uint32(&blob, capture->stage);
+   blob_write_bytes(&blob, capture->devinfo, sizeof(*capture->devinfo));
+
+   blob_write_uint32(&blob, capture->key_size);
+   blob_write_bytes(&blob, capture->key, capture->key_size);
+
+   blob_write_uint32(&blob, capture->prog_data_size);
+   blob_write_bytes(&blob, prog_data, capture->prog_data_size);
+   blob_write_uint32(&blob, prog_data->nr_params);
+   if (prog_data->nr_params > 0) {
+      blob_write_bytes(&blob, prog_data->param,
+                       prog_data->nr_params * sizeof(uint32_t));
+   }
+
+   blob_write_uint32(&blob, capture->vue_map != NULL);
+   if (capture->vue_map)
+      blob_write_bytes(&blob, capture->vue_map, sizeof(*capture->vue_map));
+
+   blob_write_uint8(&blob, capture->allow_spilling);
+   blob_write_uint8(&blob, capture->use_rep_send);
+   blob_write_uint8(&blob, capture->max_polygons);
+
+   nir_serialize(&blob, nir, false);
+
+   if (blob.out_of_memory) {
+      blob_finish(&blob);
+      return;
+   }
+
+   unsigned char sha1[20];
+   char sha1_str[41];
+   _mesa_sha1_compute(blob.data, blob.size, sha1);
+   _mesa_sha1_format(sha1_str, sha1);
+
+   char *name = ralloc_asprintf(NULL, "%s/%s-%s.brwc",
+                                debug_get_option_shader_capture_path(),
+                                _mesa_shader_stage_to_abbrev(capture->stage),
+                                sha1_str);
+
+   FILE *f = fopen(name, "wb");
+   if (f) {
+      fwrite(blob.data, blob.size, 1, f);
+      fclose(f);
+   }
+
+   ralloc_free(name);
+   blob_finish(&blob);
+}
+
+bool
+brw_capture_read(const void *data, size_t size, struct brw_capture *capture)
+{
+   struct blob_reader blob;
+
+   blob_reader_init(&blob, data, size);
+
+   if (blob_read_uint32(&blob) != BRW_CAPTURE_MAGIC ||
+       blob_read_uint32(&blob) != BRW_CAPTURE_VERSION)
+      return false;
+
+   capture->stage = (gl_shader_stage)blob_read_uint32(&blob);
+   if (capture->stage >= MESA_ALL_SHADER_STAGES)
+      return false;
+
+   capture->devinfo = blob_read_bytes(&blob, sizeof(*capture->devinfo));
+
+   capture->key_size = blob_read_uint32(&blob);
+   capture->key = blob_read_bytes(&blob, capture->key_size);
+
+   capture->prog_data_size = blob_read_uint32(&blob);
+   capture->prog_data = blob_read_bytes(&blob, capture->prog_data_size);
+   if (blob.overrun ||
+       capture->prog_data_size < sizeof(struct brw_stage_prog_data))
+      return false;
+
+   const uint32_t nr_params = blob_read_uint32(&blob);
+   capture->param = nr_params == 0 ? NULL :
+      blob_read_bytes(&blob, nr_params * sizeof(uint32_t));
+
+   capture->vue_map = blob_read_uint32(&blob) ?
+      blob_read_bytes(&blob, sizeof(*capture->vue_map)) : NULL;
+
+   capture->allow_spilling = blob_read_uint8(&blob);
+   capture->use_rep_send = blob_read_uint8(&blob);
+   capture->max_polygons = blob_read_uint8(&blob);
+
+   capture->nir = blob.current;
+   capture->nir_size = blob.end - blob.current;
+
+   return !blob.overrun;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "compiler/shader_enums.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct brw_stage_prog_data;
+struct intel_device_info;
+struct intel_vue_map;
+struct nir_shader;
+
+#define BRW_CAPTURE_MAGIC   0x43575242 /* "BRWC" */
+#define BRW_CAPTURE_VERSION 2
+
+/**
+ * Everything besides the NIR that a brw_compile_* entrypoint needs to
+ * reproduce a compile offline.
+ *
+ * Captures are written by the compiler itself when
+ * INTEL_SHADER_CAPTURE_PATH is set and replayed by brw_compile_bench.  They
+ * are a debugging aid, not a stable format: the key and prog_data are
+ * stored as raw structs, so a capture is only meaningful to a build of the
+ * same Mesa revision.
+ */
+struct brw_capture {
+   gl_shader_stage stage;
+
+   /**
+    * The device the shader was compiled for.  The NIR was lowered by the
+    * driver for this device already, so it is the only one a capture can
+    * be replayed for.
+    */
+   const struct intel_device_info *devinfo;
+
+   const void *key;
+   uint32_t key_size;
+
+   /**
+    * The prog_data as handed to the compiler by the driver.  Only the
+    * fields the driver fills in before compiling (push parameters, UBO
+    * ranges, ...) are meaningful.  Pointers are not preserved; the
+    * parameter array is stored separately in \c param.
+    */
+   const struct brw_stage_prog_data *prog_data;
+   uint32_t prog_data_size;
+   const uint32_t *param;
+
+   /** Input VUE map for tessellation evaluation and fragment shaders. */
+   const struct intel_vue_map *vue_map;
+
+   /* brw_compile_fs_params */
+   bool allow_spilling;
+   bool use_rep_send;
+   uint8_t max_polygons;
+
+   /** Output of nir_serialize(), only set by brw_capture_read(). */
+   const void *nir;
+   size_t nir_size;
+};
+
+bool brw_should_capture_shader(void);
+
+/**
+ * Write \p capture and \p nir to INTEL_SHADER_CAPTURE_PATH.  The file is
+ * named after the stage and the SHA-1 of its contents so that identical
+ * compiles are only stored once.
+ */
+void brw_capture_shader(const struct brw_capture *capture,
+                        const struct nir_shader *nir);
+
+/**
+ * Parse a capture file.  The returned pointers point into \p data.
+ */
+bool brw_capture_read(const void *data, size_t size,
+                      struct brw_capture *capture);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
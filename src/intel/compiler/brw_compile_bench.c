@@ -0,0 +1,454 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file brw_compile_bench.c
+ *
+ * Offline compile benchmark for the brw backend.
+ *
+ * Replays shaders captured with INTEL_SHADER_CAPTURE_PATH through
+ * brw_compile_* for the devices they were captured on, without a GPU, and
+ * reports the compile time together with the statistics the compiler
+ * itself produces (instruction count, estimated cycles, spills and fills)
+ * as CSV.  This makes it possible to measure the effect of a backend change
+ * on compile time and code quality over a whole shader corpus.
+ */
+
+#include <dirent.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compiler/brw_capture.h"
+#include "compiler/brw_compiler.h"
+#include "compiler/glsl_types.h"
+#include "compiler/nir/nir.h"
+#include "compiler/nir/nir_serialize.h"
+#include "dev/intel_device_info.h"
+#include "util/blob.h"
+#include "util/os_file.h"
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "util/u_dynarray.h"
+
+struct bench_capture {
+   char *path;
+   char *data;
+   struct brw_capture capture;
+
+   /** Index of the capture's device in the list of devices. */
+   unsigned device;
+};
+
+static void
+bench_log(void *data, unsigned *id, const char *fmt, ...)
+{
+}
+
+static size_t
+capture_key_size(gl_shader_stage stage)
+{
+   switch (stage) {
+   case MESA_SHADER_VERTEX:    return sizeof(struct brw_vs_prog_key);
+   case MESA_SHADER_TESS_CTRL: return sizeof(struct brw_tcs_prog_key);
+   case MESA_SHADER_TESS_EVAL: return sizeof(struct brw_tes_prog_key);
+   case MESA_SHADER_GEOMETRY:  return sizeof(struct brw_gs_prog_key);
+   case MESA_SHADER_FRAGMENT:  return sizeof(struct brw_wm_prog_key);
+   case MESA_SHADER_COMPUTE:   return sizeof(struct brw_cs_prog_key);
+   default:                    return 0;
+   }
+}
+
+static size_t
+capture_prog_data_size(gl_shader_stage stage)
+{
+   switch (stage) {
+   case MESA_SHADER_VERTEX:    return sizeof(struct brw_vs_prog_data);
+   case MESA_SHADER_TESS_CTRL: return sizeof(struct brw_tcs_prog_data);
+   case MESA_SHADER_TESS_EVAL: return sizeof(struct brw_tes_prog_data);
+   case MESA_SHADER_GEOMETRY:  return sizeof(struct brw_gs_prog_data);
+   case MESA_SHADER_FRAGMENT:  return sizeof(struct brw_wm_prog_data);
+   case MESA_SHADER_COMPUTE:   return sizeof(struct brw_cs_prog_data);
+   default:                    return 0;
+   }
+}
+
+static bool
+load_capture(struct bench_capture *bc, const char *path)
+{
+   size_t size;
+
+   bc->data = os_read_file(path, &size);
+   if (bc->data == NULL) {
+      fprintf(stderr, "%s: failed to read file\n", path);
+      return false;
+   }
+
+   if (!brw_capture_read(bc->data, size, &bc->capture)) {
+      fprintf(stderr, "%s: not a valid capture\n", path);
+      free(bc->data);
+      return false;
+   }
+
+   /* Keys and prog_data are stored as raw structs. */
+   const gl_shader_stage stage = bc->capture.stage;
+   if (capture_key_size(stage) == 0 ||
+       bc->capture.key_size != capture_key_size(stage) ||
+       bc->capture.prog_data_size != capture_prog_data_size(stage)) {
+      fprintf(stderr, "%s: unsupported stage or captured by a different "
+                      "Mesa build\n", path);
+      free(bc->data);
+      return false;
+   }
+
+   bc->path = strdup(path);
+   return true;
+}
+
+static void
+add_path(struct util_dynarray *captures, const char *path)
+{
+   DIR *dir = opendir(path);
+
+   if (dir == NULL) {
+      struct bench_capture bc;
+      if (load_capture(&bc, path))
+         util_dynarray_append(captures, struct bench_capture, bc);
+      return;
+   }
+
+   struct dirent *entry;
+   while ((entry = readdir(dir)) != NULL) {
+      const size_t len = strlen(entry->d_name);
+      if (len < 5 || strcmp(entry->d_name + len - 5, ".brwc") != 0)
+         continue;
+
+      char *file = ralloc_asprintf(NULL, "%s/%s", path, entry->d_name);
+      struct bench_capture bc;
+      if (load_capture(&bc, file))
+         util_dynarray_append(captures, struct bench_capture, bc);
+      ralloc_free(file);
+   }
+
+   closedir(dir);
+}
+
+/**
+ * Return the index of the \p captured devinfo in \p devices, adding it if
+ * needed.  The captured devinfo is not necessarily aligned, so it is copied
+ * out.
+ */
+static unsigned
+find_or_add_device(struct util_dynarray *devices, const void *captured)
+{
+   struct intel_device_info devinfo;
+   memcpy(&devinfo, captured, sizeof(devinfo));
+
+   unsigned i = 0;
+   util_dynarray_foreach(devices, struct intel_device_info, d) {
+      if (memcmp(d, &devinfo, sizeof(devinfo)) == 0)
+         return i;
+      i++;
+   }
+
+   util_dynarray_append(devices, struct intel_device_info, devinfo);
+   return i;
+}
+
+/**
+ * Compile a capture once.  Returns the time spent in the compiler proper in
+ * nanoseconds, or 0 on failure.
+ */
+static uint64_t
+compile_capture(const struct brw_compiler *compiler, void *mem_ctx,
+                const struct brw_capture *capture,
+                struct brw_compile_stats *stats)
+{
+   struct blob_reader reader;
+   blob_reader_init(&reader, capture->nir, capture->nir_size);
+
+   nir_shader *nir =
+      nir_deserialize(mem_ctx, compiler->nir_options[capture->stage], &reader);
+   if (nir == NULL)
+      return 0;
+
+   /* The capture data is not necessarily aligned, copy it out. */
+   void *key = ralloc_size(mem_ctx, capture->key_size);
+   memcpy(key, capture->key, capture->key_size);
+
+   struct brw_stage_prog_data *prog_data =
+      ralloc_size(mem_ctx, capture->prog_data_size);
+   memcpy(prog_data, capture->prog_data, capture->prog_data_size);
+   prog_data->relocs = NULL;
+   prog_data->num_relocs = 0;
+   prog_data->param = NULL;
+   if (prog_data->nr_params > 0) {
+      prog_data->param = ralloc_array(mem_ctx, uint32_t, prog_data->nr_params);
+      memcpy(prog_data->param, capture->param,
+             prog_data->nr_params * sizeof(uint32_t));
+   }
+
+   struct intel_vue_map *vue_map = NULL;
+   if (capture->vue_map) {
+      vue_map = ralloc(mem_ctx, struct intel_vue_map);
+      memcpy(vue_map, capture->vue_map, sizeof(*vue_map));
+   }
+
+   const struct brw_compile_params base = {
+      .mem_ctx = mem_ctx,
+      .nir = nir,
+      .stats = stats,
+   };
+
+   const unsigned *assembly = NULL;
+   const uint64_t start = os_time_get_nano();
+
+   switch (capture->stage) {
+   case MESA_SHADER_VERTEX: {
+      struct brw_compile_vs_params params = {
+         .base = base,
+         .key = key,
+         .prog_data = (struct brw_vs_prog_data *)prog_data,
+      };
+      assembly = brw_compile_vs(compiler, &params);
+      break;
+   }
+   case MESA_SHADER_TESS_CTRL: {
+      struct brw_compile_tcs_params params = {
+         .base = base,
+         .key = key,
+         .prog_data = (struct brw_tcs_prog_data *)prog_data,
+      };
+      assembly = brw_compile_tcs(compiler, &params);
+      break;
+   }
+   case MESA_SHADER_TESS_EVAL: {
+      if (vue_map == NULL)
+         return 0;
+      struct brw_compile_tes_params params = {
+         .base = base,
+         .key = key,
+         .prog_data = (struct brw_tes_prog_data *)prog_data,
+         .input_vue_map = vue_map,
+      };
+      assembly = brw_compile_tes(compiler, &params);
+      break;
+   }
+   case MESA_SHADER_GEOMETRY: {
+      struct brw_compile_gs_params params = {
+         .base = base,
+         .key = key,
+         .prog_data = (struct brw_gs_prog_data *)prog_data,
+      };
+      assembly = brw_compile_gs(compiler, &params);
+      break;
+   }
+   case MESA_SHADER_FRAGMENT: {
+      struct brw_compile_fs_params params = {
+         .base = base,
+         .key = key,
+         .prog_data = (struct brw_wm_prog_data *)prog_data,
+         .vue_map = vue_map,
+         .allow_spilling = capture->allow_spilling,
+         .use_rep_send = capture->use_rep_send,
+         .max_polygons = MAX2(capture->max_polygons, 1),
+      };
+      assembly = brw_compile_fs(compiler, &params);
+      break;
+   }
+   case MESA_SHADER_COMPUTE: {
+      struct brw_compile_cs_params params = {
+         .base = base,
+         .key = key,
+         .prog_data = (struct brw_cs_prog_data *)prog_data,
+      };
+      assembly = brw_compile_cs(compiler, &params);
+      break;
+   }
+   default:
+      unreachable("unsupported stage filtered out in load_capture()");
+   }
+
+   const uint64_t end = os_time_get_nano();
+
+   return assembly ? MAX2(end - start, 1) : 0;
+}
+
+static void
+print_help(const char *progname, FILE *file)
+{
+   fprintf(file,
+           "Usage: %s [OPTION]... CAPTURE...\n"
+           "Recompile shaders captured with INTEL_SHADER_CAPTURE_PATH and\n"
+           "report compile times and shader statistics as CSV.\n"
+           "CAPTURE can be a .brwc file or a directory containing them.\n\n"
+           "Each capture is compiled for the device it was captured on.\n\n"
+           "      --help                 display this help and exit\n"
+           "  -n, --iterations=N         compile each shader N times (default 1)\n"
+           "  -o, --output=PATH          write the CSV to PATH instead of stdout\n",
+           progname);
+}
+
+int main(int argc, char *argv[])
+{
+   struct util_dynarray devices;
+   struct util_dynarray captures;
+   const char *output_path = NULL;
+   unsigned iterations = 1;
+   int result = EXIT_FAILURE;
+   int c;
+
+   util_dynarray_init(&devices, NULL);
+   util_dynarray_init(&captures, NULL);
+
+   bool help = false;
+   const struct option bench_opts[] = {
+      { "help",          no_argument,       (int *) &help,      true },
+      { "iterations",    required_argument, NULL,               'n' },
+      { "output",        required_argument, NULL,               'o' },
+      { NULL,            0,                 NULL,                0 }
+   };
+
+   while ((c = getopt_long(argc, argv, ":n:o:h", bench_opts, NULL)) != -1) {
+      switch (c) {
+      case 'n':
+         iterations = MAX2(atoi(optarg), 1);
+         break;
+      case 'o':
+         output_path = optarg;
+         break;
+      case 'h':
+         help = true;
+         break;
+      case 0:
+         break;
+      case ':':
+         fprintf(stderr, "%s: option `-%c' requires an argument\n",
+                 argv[0], optopt);
+         goto end;
+      case '?':
+      default:
+         fprintf(stderr, "%s: option `-%c' is invalid: ignored\n",
+                 argv[0], optopt);
+         goto end;
+      }
+   }
+
+   if (help || optind >= argc) {
+      print_help(argv[0], help ? stdout : stderr);
+      result = help ? EXIT_SUCCESS : EXIT_FAILURE;
+      goto end;
+   }
+
+   for (int i = optind; i < argc; i++)
+      add_path(&captures, argv[i]);
+
+   if (util_dynarray_num_elements(&captures, struct bench_capture) == 0) {
+      fprintf(stderr, "No captures found\n");
+      goto end;
+   }
+
+   util_dynarray_foreach(&captures, struct bench_capture, bc)
+      bc->device = find_or_add_device(&devices, bc->capture.devinfo);
+
+   FILE *out = output_path ? fopen(output_path, "w") : stdout;
+   if (out == NULL) {
+      fprintf(stderr, "Failed to open %s\n", output_path);
+      goto end;
+   }
+
+   glsl_type_singleton_init_or_ref();
+
+   fprintf(out, "device,capture,stage,dispatch_width,instructions,sends,"
+                "loops,cycles,spills,fills,max_live_registers,compile_us\n");
+
+   unsigned device_index = 0;
+   util_dynarray_foreach(&devices, struct intel_device_info, devinfo) {
+      const unsigned device = device_index++;
+
+      void *compiler_ctx = ralloc_context(NULL);
+      struct brw_compiler *compiler =
+         brw_compiler_create(compiler_ctx, devinfo);
+      compiler->shader_debug_log = bench_log;
+      compiler->shader_perf_log = bench_log;
+
+      unsigned compiled = 0, failed = 0;
+      uint64_t total_ns = 0;
+
+      util_dynarray_foreach(&captures, struct bench_capture, bc) {
+         if (bc->device != device)
+            continue;
+
+         struct brw_compile_stats stats[3];
+         uint64_t ns = 0;
+
+         for (unsigned i = 0; i < iterations; i++) {
+            void *mem_ctx = ralloc_context(NULL);
+
+            memset(stats, 0, sizeof(stats));
+            const uint64_t t =
+               compile_capture(compiler, mem_ctx, &bc->capture, stats);
+
+            ralloc_free(mem_ctx);
+
+            if (t == 0) {
+               ns = 0;
+               break;
+            }
+            ns += t;
+         }
+
+         if (ns == 0) {
+            fprintf(stderr, "%s: %s: compile failed\n", devinfo->name,
+                    bc->path);
+            failed++;
+            continue;
+         }
+
+         compiled++;
+         total_ns += ns;
+
+         for (unsigned s = 0; s < ARRAY_SIZE(stats); s++) {
+            if (stats[s].instructions == 0)
+               continue;
+
+            fprintf(out, "0x%04x,%s,%s,%u,%u,%u,%u,%u,%u,%u,%u,%.1f\n",
+                    devinfo->pci_device_id, bc->path,
+                    _mesa_shader_stage_to_abbrev(bc->capture.stage),
+                    stats[s].dispatch_width, stats[s].instructions,
+                    stats[s].sends, stats[s].loops, stats[s].cycles,
+                    stats[s].spills, stats[s].fills,
+                    stats[s].max_live_registers,
+                    ns / (iterations * 1000.0));
+         }
+      }
+
+      fprintf(stderr, "%s: %u shaders compiled, %u failed, %.1f ms total, "
+                      "%.1f shaders/s\n",
+              devinfo->name, compiled, failed, total_ns / (iterations * 1e6),
+              total_ns ? compiled * iterations * 1e9 / total_ns : 0.0);
+
+      ralloc_free(compiler_ctx);
+   }
+
+   glsl_type_singleton_decref();
+
+   if (out != stdout)
+      fclose(out);
+
+   result = EXIT_SUCCESS;
+
+end:
+   util_dynarray_foreach(&captures, struct bench_capture, bc) {
+      free(bc->path);
+      free(bc->data);
+   }
+   util_dynarray_fini(&captures);
+   util_dynarray_fini(&devices);
+
+   return result;
+}
@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include "brw_capture.h"
 #include "brw_eu.h"
 #include "intel_nir.h"
 #include "brw_nir.h"
@@ -51,6 +52,18 @@ brw_compile_tcs(const struct brw_compiler *compiler,
 
    const bool debug_enabled = brw_should_print_shader(nir, DEBUG_TCS);
 
+   if (brw_should_capture_shader()) {
+      const struct brw_capture capture = {
+         .stage = MESA_SHADER_TESS_CTRL,
+         .devinfo = compiler->devinfo,
+         .key = key,
+         .key_size = sizeof(*key),
+         .prog_data = &prog_data->base.base,
+         .prog_data_size = sizeof(*prog_data),
+      };
+      brw_capture_shader(&capture, nir);
+   }
+
    vue_prog_data->base.stage = MESA_SHADER_TESS_CTRL;
    prog_data->base.base.ray_queries = nir->info.ray_queries;
    prog_data->base.base.total_scratch = 0;
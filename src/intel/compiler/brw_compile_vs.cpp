@@ -4,6 +4,7 @@
  */
 
 #include "brw_fs.h"
+#include "brw_capture.h"
 #include "brw_eu.h"
 #include "brw_nir.h"
 #include "brw_private.h"
@@ -22,6 +23,18 @@ brw_compile_vs(const struct brw_compiler *compiler,
       brw_should_print_shader(nir, params->base.debug_flag ?
                                    params->base.debug_flag : DEBUG_VS);
 
+   if (brw_should_capture_shader()) {
+      const struct brw_capture capture = {
+         .stage = MESA_SHADER_VERTEX,
+         .devinfo = compiler->devinfo,
+         .key = key,
+         .key_size = sizeof(*key),
+         .prog_data = &prog_data->base.base,
+         .prog_data_size = sizeof(*prog_data),
+      };
+      brw_capture_shader(&capture, nir);
+   }
+
    prog_data->base.base.stage = MESA_SHADER_VERTEX;
    prog_data->base.base.ray_queries = nir->info.ray_queries;
    prog_data->base.base.total_scratch = 0;
@@ -93,6 +93,9 @@ brw_compiler_create(void *mem_ctx, const struct intel_device_info *devinfo)
 
    compiler->precise_trig = debug_get_bool_option("INTEL_PRECISE_TRIG", false);
 
+   compiler->parallel_fs_simd =
+      debug_get_bool_option("INTEL_PARALLEL_FS_SIMD", false);
+
    compiler->use_tcs_multi_patch = devinfo->ver >= 12;
 
    /* Default to the sampler since that's what we've done since forever */
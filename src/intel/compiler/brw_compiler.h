@@ -119,6 +119,14 @@ struct brw_compiler {
     */
    int spilling_rate;
 
+   /**
+    * Compile the wider fragment shader SIMD variants speculatively on a
+    * worker thread pool while the narrowest one is compiled on the calling
+    * thread.  The selection between variants is still done in the same
+    * order as the serial path so the generated code is identical.
+    */
+   bool parallel_fs_simd;
+
    struct nir_shader *clc_shader;
 
    struct {
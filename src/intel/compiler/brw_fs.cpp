@@ -33,6 +33,7 @@
 #include "brw_fs_builder.h"
 #include "brw_fs_live_variables.h"
 #include "brw_nir.h"
+#include "brw_capture.h"
 #include "brw_cfg.h"
 #include "brw_private.h"
 #include "intel_nir.h"
@@ -41,7 +42,10 @@
 #include "dev/intel_wa.h"
 #include "compiler/glsl_types.h"
 #include "compiler/nir/nir_builder.h"
+#include "util/u_call_once.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_math.h"
+#include "util/u_queue.h"
 
 #include <memory>
 
@@ -2918,6 +2922,67 @@ brw_get_scratch_size(int size)
    return MAX2(1024, util_next_power_of_two(size));
 }
 
+/**
+ * Cheap check run on the optimized IR of a fragment shader variant which is
+ * not allowed to spill, right before the expensive scheduling and register
+ * allocation steps.
+ *
+ * Pre-RA scheduling only reorders instructions within a block, so a VGRF
+ * which is defined before a block and used after it is live across that
+ * block in every schedule.  The live ranges of all such VGRFs overlap, so
+ * the register allocator makes them interfere with each other.  If they
+ * need more registers than there are, assign_regs() is bound to fail for
+ * every scheduling mode and the variant can be dropped right away.
+ */
+bool
+fs_visitor::pre_ra_viable()
+{
+   const fs_live_variables &live = live_analysis.require();
+   const unsigned num_ips = cfg->last_block()->end_ip + 1;
+
+   int *block_of_ip = new int[num_ips];
+   int *delta = new int[cfg->num_blocks + 1]();
+
+   foreach_block(block, cfg) {
+      for (int ip = block->start_ip; ip <= block->end_ip; ip++)
+         block_of_ip[ip] = block->num;
+   }
+
+   /* Add the size of each VGRF to the blocks strictly inside its live
+    * range.
+    */
+   for (unsigned i = 0; i < alloc.count; i++) {
+      if (live.vgrf_start[i] > live.vgrf_end[i])
+         continue;
+
+      const int first = block_of_ip[live.vgrf_start[i]] + 1;
+      const int last = block_of_ip[live.vgrf_end[i]] - 1;
+      if (first > last)
+         continue;
+
+      const int size = DIV_ROUND_UP(alloc.sizes[i], reg_unit(devinfo));
+      delta[first] += size;
+      delta[last + 1] -= size;
+   }
+
+   bool viable = true;
+   int live_across = 0;
+   for (int b = 0; b < cfg->num_blocks; b++) {
+      live_across += delta[b];
+      if (live_across > BRW_MAX_GRF) {
+         fail("SIMD%d would spill, %d registers are live across "
+              "block %d.\n", dispatch_width, live_across, b);
+         viable = false;
+         break;
+      }
+   }
+
+   delete[] block_of_ip;
+   delete[] delta;
+
+   return viable;
+}
+
 void
 fs_visitor::allocate_registers(bool allow_spilling)
 {
@@ -3393,6 +3458,9 @@ fs_visitor::run_fs(bool allow_spilling, bool do_rep_send)
       brw_fs_workaround_memory_fence_before_eot(*this);
       brw_fs_workaround_emit_dummy_mov_instruction(*this);
 
+      if (!allow_spilling && !pre_ra_viable())
+         return false;
+
       allocate_registers(allow_spilling);
    }
 
@@ -3873,6 +3941,126 @@ brw_nir_populate_wm_prog_data(nir_shader *shader,
    brw_compute_flat_inputs(prog_data, shader);
 }
 
+/**
+ * A SIMD16 or SIMD32 fragment shader compile started on the worker pool
+ * before the result of the preceding narrower compile is known.
+ *
+ * The visitor gets its own copy of the prog_data and its own ralloc context
+ * so that it doesn't race with the compile running on the calling thread.
+ * Only the fields that fs_visitor::run_fs() may set differently from the
+ * other variants are folded back into the real prog_data when the result
+ * is used, see fs_speculative_compile_finish().
+ */
+struct fs_speculative_compile {
+   fs_speculative_compile() : allow_spilling(false), success(false),
+                              submitted(false)
+   {
+      memset(&prog_data, 0, sizeof(prog_data));
+      memset(&params, 0, sizeof(params));
+      util_queue_fence_init(&fence);
+   }
+
+   ~fs_speculative_compile()
+   {
+      if (submitted)
+         util_queue_fence_wait(&fence);
+      util_queue_fence_destroy(&fence);
+      v.reset();
+      ralloc_free(params.mem_ctx);
+   }
+
+   struct brw_compile_params params;
+   struct brw_wm_prog_data prog_data;
+   std::unique_ptr<fs_visitor> v;
+   struct util_queue_fence fence;
+   bool allow_spilling;
+   bool success;
+   bool submitted;
+};
+
+static struct util_queue fs_simd_queue;
+static bool fs_simd_queue_valid;
+static util_once_flag fs_simd_queue_once = UTIL_ONCE_FLAG_INIT;
+
+static void
+fs_simd_queue_init(void)
+{
+   /* There are at most two speculative compiles per fragment shader, the
+    * extra threads only help when several shaders are compiled at once.
+    */
+   const unsigned num_threads = MIN2(util_get_cpu_caps()->nr_cpus, 4);
+
+   if (num_threads < 2)
+      return;
+
+   fs_simd_queue_valid =
+      util_queue_init(&fs_simd_queue, "brw_fs_simd", 8, num_threads,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL, NULL);
+}
+
+static void
+fs_speculative_compile_execute(void *job, void *gdata, int thread_index)
+{
+   fs_speculative_compile *sc = (fs_speculative_compile *) job;
+
+   sc->success = sc->v->run_fs(sc->allow_spilling, false /* do_rep_send */);
+   /* The performance analysis is needed for the final selection anyway. */
+   if (sc->success)
+      sc->v->performance_analysis.require();
+}
+
+static void
+fs_speculative_compile_start(fs_speculative_compile *sc,
+                             const struct brw_compiler *compiler,
+                             const struct brw_compile_fs_params *params,
+                             const struct brw_wm_prog_data *prog_data,
+                             const nir_shader *nir,
+                             unsigned dispatch_width)
+{
+   sc->params = params->base;
+   sc->params.mem_ctx = ralloc_context(NULL);
+   sc->prog_data = *prog_data;
+
+   /* Every variant computes the same uniform layout for fragment shaders,
+    * so unlike the serial path there is no need to import_uniforms() from
+    * the SIMD8 compile.  Spilling is only ever allowed for the first
+    * variant that is compiled.
+    */
+   sc->v = std::make_unique<fs_visitor>(compiler, &sc->params, params->key,
+                                        &sc->prog_data, nir, dispatch_width, 1,
+                                        params->base.stats != NULL,
+                                        false /* debug_enabled */);
+   sc->allow_spilling = false;
+
+   util_queue_add_job(&fs_simd_queue, sc, &sc->fence,
+                      fs_speculative_compile_execute, NULL, 0);
+   sc->submitted = true;
+}
+
+/**
+ * Waits for a speculative compile and takes it over as if it had been run
+ * on the calling thread at this point.
+ */
+static bool
+fs_speculative_compile_finish(fs_speculative_compile *sc,
+                              struct brw_wm_prog_data *prog_data,
+                              std::unique_ptr<fs_visitor> &v)
+{
+   util_queue_fence_wait(&sc->fence);
+   sc->submitted = false;
+
+   prog_data->base.total_scratch = MAX2(prog_data->base.total_scratch,
+                                        sc->prog_data.base.total_scratch);
+   prog_data->base.has_ubo_pull |= sc->prog_data.base.has_ubo_pull;
+   prog_data->has_side_effects |= sc->prog_data.has_side_effects;
+   prog_data->pulls_bary |= sc->prog_data.pulls_bary;
+   prog_data->uses_nonperspective_interp_modes |=
+      sc->prog_data.uses_nonperspective_interp_modes;
+
+   v = std::move(sc->v);
+   return sc->success;
+}
+
 const unsigned *
 brw_compile_fs(const struct brw_compiler *compiler,
                struct brw_compile_fs_params *params)
@@ -3885,6 +4073,23 @@ brw_compile_fs(const struct brw_compiler *compiler,
       brw_should_print_shader(nir, params->base.debug_flag ?
                                    params->base.debug_flag : DEBUG_WM);
 
+   /* Mesh pipelines pass the MUE map instead, which is not captured. */
+   if (brw_should_capture_shader() && params->mue_map == NULL) {
+      const struct brw_capture capture = {
+         .stage = MESA_SHADER_FRAGMENT,
+         .devinfo = compiler->devinfo,
+         .key = key,
+         .key_size = sizeof(*key),
+         .prog_data = &prog_data->base,
+         .prog_data_size = sizeof(*prog_data),
+         .vue_map = params->vue_map,
+         .allow_spilling = params->allow_spilling,
+         .use_rep_send = params->use_rep_send,
+         .max_polygons = params->max_polygons,
+      };
+      brw_capture_shader(&capture, nir);
+   }
+
    prog_data->base.stage = MESA_SHADER_FRAGMENT;
    prog_data->base.ray_queries = nir->info.ray_queries;
    prog_data->base.total_scratch = 0;
@@ -3916,6 +4121,30 @@ brw_compile_fs(const struct brw_compiler *compiler,
    brw_nir_populate_wm_prog_data(nir, compiler->devinfo, key, prog_data,
                                  params->mue_map);
 
+   /* Start the wider variants early on the worker pool.  They are only
+    * picked up below if the serial logic would have compiled them, with
+    * the same spilling setting, so the result doesn't depend on this.
+    */
+   fs_speculative_compile spec16, spec32;
+
+   if (compiler->parallel_fs_simd && !debug_enabled &&
+       !params->use_rep_send && nir->info.ray_queries == 0 &&
+       (devinfo->ver < 20 || INTEL_SIMD(FS, 16))) {
+      util_call_once(&fs_simd_queue_once, fs_simd_queue_init);
+
+      if (fs_simd_queue_valid) {
+         /* SIMD16 is only compiled without spilling if a SIMD8 compile
+          * is kept before it.  A failing SIMD8 compile returns early.
+          */
+         if (devinfo->ver < 20 && INTEL_SIMD(FS, 8) && INTEL_SIMD(FS, 16))
+            fs_speculative_compile_start(&spec16, compiler, params,
+                                         prog_data, nir, 16);
+         if (!key->coarse_pixel && INTEL_SIMD(FS, 32))
+            fs_speculative_compile_start(&spec32, compiler, params,
+                                         prog_data, nir, 32);
+      }
+   }
+
    std::unique_ptr<fs_visitor> v8, v16, v32, vmulti;
    cfg_t *simd8_cfg = NULL, *simd16_cfg = NULL, *simd32_cfg = NULL,
       *multi_cfg = NULL;
@@ -3960,13 +4189,20 @@ brw_compile_fs(const struct brw_compiler *compiler,
        (!v8 || v8->max_dispatch_width >= 16) &&
        (INTEL_SIMD(FS, 16) || params->use_rep_send)) {
       /* Try a SIMD16 compile */
-      v16 = std::make_unique<fs_visitor>(compiler, &params->base, key,
-                                         prog_data, nir, 16, 1,
-                                         params->base.stats != NULL,
-                                         debug_enabled);
-      if (v8)
-         v16->import_uniforms(v8.get());
-      if (!v16->run_fs(allow_spilling, params->use_rep_send)) {
+      bool v16_compiled;
+      if (spec16.submitted && !allow_spilling) {
+         v16_compiled = fs_speculative_compile_finish(&spec16, prog_data, v16);
+      } else {
+         v16 = std::make_unique<fs_visitor>(compiler, &params->base, key,
+                                            prog_data, nir, 16, 1,
+                                            params->base.stats != NULL,
+                                            debug_enabled);
+         if (v8)
+            v16->import_uniforms(v8.get());
+         v16_compiled = v16->run_fs(allow_spilling, params->use_rep_send);
+      }
+
+      if (!v16_compiled) {
          brw_shader_perf_log(compiler, params->base.log_data,
                              "SIMD16 shader failed to compile: %s\n",
                              v16->fail_msg);
@@ -3992,16 +4228,23 @@ brw_compile_fs(const struct brw_compiler *compiler,
        !simd16_failed &&
        INTEL_SIMD(FS, 32)) {
       /* Try a SIMD32 compile */
-      v32 = std::make_unique<fs_visitor>(compiler, &params->base, key,
-                                         prog_data, nir, 32, 1,
-                                         params->base.stats != NULL,
-                                         debug_enabled);
-      if (v8)
-         v32->import_uniforms(v8.get());
-      else if (v16)
-         v32->import_uniforms(v16.get());
-
-      if (!v32->run_fs(allow_spilling, false)) {
+      bool v32_compiled;
+      if (spec32.submitted && !allow_spilling) {
+         v32_compiled = fs_speculative_compile_finish(&spec32, prog_data, v32);
+      } else {
+         v32 = std::make_unique<fs_visitor>(compiler, &params->base, key,
+                                            prog_data, nir, 32, 1,
+                                            params->base.stats != NULL,
+                                            debug_enabled);
+         if (v8)
+            v32->import_uniforms(v8.get());
+         else if (v16)
+            v32->import_uniforms(v16.get());
+
+         v32_compiled = v32->run_fs(allow_spilling, false);
+      }
+
+      if (!v32_compiled) {
          brw_shader_perf_log(compiler, params->base.log_data,
                              "SIMD32 shader failed to compile: %s\n",
                              v32->fail_msg);
@@ -4265,6 +4508,18 @@ brw_compile_cs(const struct brw_compiler *compiler,
       brw_should_print_shader(nir, params->base.debug_flag ?
                                    params->base.debug_flag : DEBUG_CS);
 
+   if (brw_should_capture_shader()) {
+      const struct brw_capture capture = {
+         .stage = MESA_SHADER_COMPUTE,
+         .devinfo = compiler->devinfo,
+         .key = key,
+         .key_size = sizeof(*key),
+         .prog_data = &prog_data->base,
+         .prog_data_size = sizeof(*prog_data),
+      };
+      brw_capture_shader(&capture, nir);
+   }
+
    prog_data->base.stage = MESA_SHADER_COMPUTE;
    prog_data->base.total_shared = nir->info.shared_size;
    prog_data->base.ray_queries = nir->info.ray_queries;
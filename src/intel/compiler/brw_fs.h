@@ -254,6 +254,7 @@ public:
    bool run_bs(bool allow_spilling);
    bool run_task(bool allow_spilling);
    bool run_mesh(bool allow_spilling);
+   bool pre_ra_viable();
    void allocate_registers(bool allow_spilling);
    uint32_t compute_max_register_pressure();
    void assign_curb_setup();
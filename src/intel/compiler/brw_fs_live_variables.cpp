@@ -87,7 +87,7 @@ fs_live_variables::setup_one_write(struct block_data *bd, fs_inst *inst,
       if (!inst->is_partial_write() && !BITSET_TEST(bd->use, var))
          BITSET_SET(bd->def, var);
 
-      BITSET_SET(bd->defout, var);
+      BITSET_SET(bd->defgen, var);
    }
 }
 
@@ -148,84 +148,252 @@ fs_live_variables::setup_def_use()
 /**
  * The algorithm incrementally sets bits in liveout and livein,
  * propagating it through control flow.  It will eventually terminate
- * because it only ever adds bits, and stops when no bits are added in
- * a pass.
+ * because it only ever adds bits, and stops when the worklist of blocks
+ * whose inputs changed runs empty.
+ *
+ * Only the \p num_words bitset words listed in \p words are solved, and the
+ * flag registers only if \p flags is set.  The equations of every variable
+ * are independent of each other, so the solution of the remaining words can
+ * be taken from elsewhere.
  */
 void
-fs_live_variables::compute_live_variables()
+fs_live_variables::compute_live_variables(const unsigned *words,
+                                          unsigned num_words, bool flags)
 {
-   bool cont = true;
+   if (num_words == 0 && !flags)
+      return;
+
+   /* Blocks are popped from the end of the stack, and a block is never on
+    * it twice.
+    */
+   unsigned *stack = ralloc_array(mem_ctx, unsigned, cfg->num_blocks);
+   BITSET_WORD *queued = rzalloc_array(mem_ctx, BITSET_WORD,
+                                       BITSET_WORDS(cfg->num_blocks));
+   unsigned stack_size = 0;
+
+   for (int b = 0; b < cfg->num_blocks; b++) {
+      struct block_data *bd = &block_data[b];
+
+      for (unsigned w = 0; w < num_words; w++) {
+         const unsigned i = words[w];
+         bd->defin[i] = 0;
+         bd->defout[i] = bd->defgen[i];
+         bd->livein[i] = 0;
+         bd->liveout[i] = 0;
+      }
+
+      if (flags) {
+         bd->flag_livein[0] = 0;
+         bd->flag_liveout[0] = 0;
+      }
+   }
 
    /* Propagate defin and defout down the CFG to calculate the union of live
     * variables potentially defined along any possible control flow path.
     */
-   do {
-      cont = false;
-
-      foreach_block (block, cfg) {
-         const struct block_data *bd = &block_data[block->num];
+   for (int b = cfg->num_blocks - 1; b >= 0; b--) {
+      stack[stack_size++] = b;
+      BITSET_SET(queued, b);
+   }
 
-         foreach_list_typed(bblock_link, child_link, link, &block->children) {
-            struct block_data *child_bd = &block_data[child_link->block->num];
+   while (stack_size) {
+      const bblock_t *block = cfg->blocks[stack[--stack_size]];
+      const struct block_data *bd = &block_data[block->num];
+      BITSET_CLEAR(queued, block->num);
+
+      foreach_list_typed(bblock_link, child_link, link, &block->children) {
+         const int child = child_link->block->num;
+         struct block_data *child_bd = &block_data[child];
+         bool progress = false;
+
+         for (unsigned w = 0; w < num_words; w++) {
+            const unsigned i = words[w];
+            const BITSET_WORD new_def = bd->defout[i] & ~child_bd->defin[i];
+            child_bd->defin[i] |= new_def;
+            child_bd->defout[i] |= new_def;
+            progress |= new_def;
+         }
 
-            for (int i = 0; i < bitset_words; i++) {
-               const BITSET_WORD new_def = bd->defout[i] & ~child_bd->defin[i];
-               child_bd->defin[i] |= new_def;
-               child_bd->defout[i] |= new_def;
-               cont |= new_def;
-            }
+         if (progress && !BITSET_TEST(queued, child)) {
+            stack[stack_size++] = child;
+            BITSET_SET(queued, child);
          }
       }
-   } while (cont);
-
-   do {
-      cont = false;
+   }
 
-      foreach_block_reverse (block, cfg) {
-         struct block_data *bd = &block_data[block->num];
+   /* Then propagate liveness up, starting from the end of the program. */
+   for (int b = 0; b < cfg->num_blocks; b++) {
+      stack[stack_size++] = b;
+      BITSET_SET(queued, b);
+   }
 
-         /* Update liveout */
-         foreach_list_typed(bblock_link, child_link, link, &block->children) {
-            struct block_data *child_bd = &block_data[child_link->block->num];
+   while (stack_size) {
+      const bblock_t *block = cfg->blocks[stack[--stack_size]];
+      struct block_data *bd = &block_data[block->num];
+      bool progress = false;
+      BITSET_CLEAR(queued, block->num);
+
+      /* Update liveout */
+      foreach_list_typed(bblock_link, child_link, link, &block->children) {
+         struct block_data *child_bd = &block_data[child_link->block->num];
+
+         for (unsigned w = 0; w < num_words; w++) {
+            const unsigned i = words[w];
+            BITSET_WORD new_liveout = (child_bd->livein[i] &
+                                       ~bd->liveout[i]);
+            new_liveout &= bd->defout[i]; /* Screen off uses with no reaching def */
+            if (new_liveout)
+               bd->liveout[i] |= new_liveout;
+         }
 
-            for (int i = 0; i < bitset_words; i++) {
-               BITSET_WORD new_liveout = (child_bd->livein[i] &
-                                          ~bd->liveout[i]);
-               new_liveout &= bd->defout[i]; /* Screen off uses with no reaching def */
-               if (new_liveout)
-                  bd->liveout[i] |= new_liveout;
-            }
+         if (flags) {
             BITSET_WORD new_liveout = (child_bd->flag_livein[0] &
                                        ~bd->flag_liveout[0]);
             if (new_liveout)
                bd->flag_liveout[0] |= new_liveout;
          }
+      }
 
-         /* Update livein */
-         for (int i = 0; i < bitset_words; i++) {
-            BITSET_WORD new_livein = (bd->use[i] |
-                                      (bd->liveout[i] &
-                                       ~bd->def[i]));
-            new_livein &= bd->defin[i]; /* Screen off uses with no reaching def */
-            if (new_livein & ~bd->livein[i]) {
-               bd->livein[i] |= new_livein;
-               cont = true;
-            }
+      /* Update livein */
+      for (unsigned w = 0; w < num_words; w++) {
+         const unsigned i = words[w];
+         BITSET_WORD new_livein = (bd->use[i] |
+                                   (bd->liveout[i] &
+                                    ~bd->def[i]));
+         new_livein &= bd->defin[i]; /* Screen off uses with no reaching def */
+         if (new_livein & ~bd->livein[i]) {
+            bd->livein[i] |= new_livein;
+            progress = true;
          }
+      }
+
+      if (flags) {
          BITSET_WORD new_livein = (bd->flag_use[0] |
                                    (bd->flag_liveout[0] &
                                     ~bd->flag_def[0]));
          if (new_livein & ~bd->flag_livein[0]) {
             bd->flag_livein[0] |= new_livein;
-            cont = true;
+            progress = true;
          }
       }
-   } while (cont);
+
+      if (progress) {
+         foreach_list_typed(bblock_link, parent_link, link, &block->parents) {
+            const int parent = parent_link->block->num;
+            if (!BITSET_TEST(queued, parent)) {
+               stack[stack_size++] = parent;
+               BITSET_SET(queued, parent);
+            }
+         }
+      }
+   }
+
+   ralloc_free(queued);
+   ralloc_free(stack);
+}
+
+void
+fs_live_variables::compute_all_live_variables()
+{
+   unsigned *words = ralloc_array(mem_ctx, unsigned, bitset_words);
+   for (int i = 0; i < bitset_words; i++)
+      words[i] = i;
+
+   compute_live_variables(words, bitset_words, true);
+   ralloc_free(words);
+}
+
+/**
+ * Bring the block-level solution of a stale analysis up to date.
+ *
+ * The data flow equations of every variable only depend on the def/use
+ * information of that variable, so the stale solution is still exact for
+ * all variables whose def/use information didn't change in any block.  The
+ * common edits (removing an instruction, renaming a register, coalescing
+ * two VGRFs) only change it for the few variables they touch, and only the
+ * bitset words containing those are solved again.
+ *
+ * Returns false if the stale result can't be used because the CFG changed
+ * or existing variables were renumbered.  Variables may have been appended
+ * since.
+ */
+bool
+fs_live_variables::update_live_variables(const fs_live_variables &stale,
+                                         analysis_dependency_class dirty)
+{
+   if ((dirty & DEPENDENCY_BLOCKS) || stale.cfg != cfg ||
+       stale.num_blocks != num_blocks || stale.num_vgrfs > num_vgrfs)
+      return false;
+
+   if (memcmp(stale.blocks, blocks, num_blocks * sizeof(*blocks)) != 0)
+      return false;
+
+   if (memcmp(stale.var_from_vgrf, var_from_vgrf,
+              stale.num_vgrfs * sizeof(*var_from_vgrf)) != 0 ||
+       (stale.num_vgrfs < num_vgrfs ?
+        var_from_vgrf[stale.num_vgrfs] : num_vars) != stale.num_vars)
+      return false;
+
+   unsigned *words = ralloc_array(mem_ctx, unsigned, bitset_words);
+   unsigned num_words = 0;
+   bool flags = false;
+
+   for (int b = 0; b < cfg->num_blocks; b++) {
+      flags |= block_data[b].flag_def[0] != stale.block_data[b].flag_def[0] ||
+               block_data[b].flag_use[0] != stale.block_data[b].flag_use[0];
+   }
+
+   for (int i = 0; i < bitset_words; i++) {
+      bool changed = false;
+
+      /* Words past the end of the stale bitsets only hold variables added
+       * since, which had no defs or uses.
+       */
+      for (int b = 0; b < cfg->num_blocks && !changed; b++) {
+         const struct block_data *bd = &block_data[b];
+         const struct block_data *stale_bd = &stale.block_data[b];
+
+         if (i < stale.bitset_words) {
+            changed = bd->def[i] != stale_bd->def[i] ||
+                      bd->use[i] != stale_bd->use[i] ||
+                      bd->defgen[i] != stale_bd->defgen[i];
+         } else {
+            changed = bd->def[i] | bd->use[i] | bd->defgen[i];
+         }
+      }
+
+      if (changed) {
+         words[num_words++] = i;
+      } else if (i < stale.bitset_words) {
+         for (int b = 0; b < cfg->num_blocks; b++) {
+            struct block_data *bd = &block_data[b];
+            const struct block_data *stale_bd = &stale.block_data[b];
+
+            bd->livein[i] = stale_bd->livein[i];
+            bd->liveout[i] = stale_bd->liveout[i];
+            bd->defin[i] = stale_bd->defin[i];
+            bd->defout[i] = stale_bd->defout[i];
+         }
+      }
+   }
+
+   if (!flags) {
+      for (int b = 0; b < cfg->num_blocks; b++) {
+         block_data[b].flag_livein[0] = stale.block_data[b].flag_livein[0];
+         block_data[b].flag_liveout[0] = stale.block_data[b].flag_liveout[0];
+      }
+   }
+
+   compute_live_variables(words, num_words, flags);
+   ralloc_free(words);
+
+   return true;
 }
 
 /**
  * Extend the start/end ranges for each variable to account for the
- * new information calculated from control flow.
+ * new information calculated from control flow, and merge them into the
+ * ranges of whole VGRFs.
  */
 void
 fs_live_variables::compute_start_end()
@@ -244,10 +412,17 @@ fs_live_variables::compute_start_end()
          end[i] = MAX2(end[i], block->end_ip);
       }
    }
+
+   /* Merge the per-component live ranges to whole VGRF live ranges. */
+   for (int i = 0; i < num_vars; i++) {
+      const unsigned vgrf = vgrf_from_var[i];
+      vgrf_start[vgrf] = MIN2(vgrf_start[vgrf], start[i]);
+      vgrf_end[vgrf] = MAX2(vgrf_end[vgrf], end[i]);
+   }
 }
 
-fs_live_variables::fs_live_variables(const fs_visitor *s)
-   : devinfo(s->devinfo), cfg(s->cfg)
+void
+fs_live_variables::init(const fs_visitor *s)
 {
    mem_ctx = ralloc_context(NULL);
    linear_ctx *lin_ctx = linear_context(mem_ctx);
@@ -281,6 +456,10 @@ fs_live_variables::fs_live_variables(const fs_visitor *s)
       vgrf_end[i] = -1;
    }
 
+   num_blocks = cfg->num_blocks;
+   blocks = linear_alloc_array(lin_ctx, const bblock_t *, num_blocks);
+   memcpy(blocks, cfg->blocks, num_blocks * sizeof(*blocks));
+
    block_data = linear_zalloc_array(lin_ctx, struct block_data, cfg->num_blocks);
 
    bitset_words = BITSET_WORDS(num_vars);
@@ -291,6 +470,7 @@ fs_live_variables::fs_live_variables(const fs_visitor *s)
       block_data[i].liveout = linear_zalloc_array(lin_ctx, BITSET_WORD, bitset_words);
       block_data[i].defin = linear_zalloc_array(lin_ctx, BITSET_WORD, bitset_words);
       block_data[i].defout = linear_zalloc_array(lin_ctx, BITSET_WORD, bitset_words);
+      block_data[i].defgen = linear_zalloc_array(lin_ctx, BITSET_WORD, bitset_words);
 
       block_data[i].flag_def[0] = 0;
       block_data[i].flag_use[0] = 0;
@@ -299,15 +479,26 @@ fs_live_variables::fs_live_variables(const fs_visitor *s)
    }
 
    setup_def_use();
-   compute_live_variables();
+}
+
+fs_live_variables::fs_live_variables(const fs_visitor *s)
+   : devinfo(s->devinfo), cfg(s->cfg)
+{
+   init(s);
+   compute_all_live_variables();
    compute_start_end();
+}
 
-   /* Merge the per-component live ranges to whole VGRF live ranges. */
-   for (int i = 0; i < num_vars; i++) {
-      const unsigned vgrf = vgrf_from_var[i];
-      vgrf_start[vgrf] = MIN2(vgrf_start[vgrf], start[i]);
-      vgrf_end[vgrf] = MAX2(vgrf_end[vgrf], end[i]);
-   }
+fs_live_variables::fs_live_variables(const fs_visitor *s,
+                                     const fs_live_variables &stale,
+                                     analysis_dependency_class dirty)
+   : devinfo(s->devinfo), cfg(s->cfg)
+{
+   init(s);
+
+   if (!update_live_variables(stale, dirty))
+      compute_all_live_variables();
+   compute_start_end();
 }
 
 fs_live_variables::~fs_live_variables()
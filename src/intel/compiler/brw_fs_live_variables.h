@@ -71,6 +71,12 @@ public:
        */
       BITSET_WORD *defout;
 
+      /**
+       * Variables written anywhere in the block, i.e. the part of defout
+       * that doesn't depend on other blocks.
+       */
+      BITSET_WORD *defgen;
+
       BITSET_WORD flag_def[1];
       BITSET_WORD flag_use[1];
       BITSET_WORD flag_livein[1];
@@ -78,6 +84,8 @@ public:
    };
 
    fs_live_variables(const fs_visitor *s);
+   fs_live_variables(const fs_visitor *s, const fs_live_variables &stale,
+                     analysis_dependency_class dirty);
    ~fs_live_variables();
 
    bool validate(const fs_visitor *s) const;
@@ -131,18 +139,40 @@ public:
    struct block_data *block_data;
 
 protected:
+   void init(const fs_visitor *s);
+   bool update_live_variables(const fs_live_variables &stale,
+                              analysis_dependency_class dirty);
    void setup_def_use();
    void setup_one_read(struct block_data *bd, int ip, const fs_reg &reg);
    void setup_one_write(struct block_data *bd, fs_inst *inst, int ip,
                         const fs_reg &reg);
-   void compute_live_variables();
+   void compute_live_variables(const unsigned *words, unsigned num_words,
+                               bool flags);
+   void compute_all_live_variables();
    void compute_start_end();
 
    const struct intel_device_info *devinfo;
    const cfg_t *cfg;
    void *mem_ctx;
+
+   /**
+    * The blocks of the CFG at the time of the analysis.  Removing the last
+    * instruction of a block removes the block as well, which is only
+    * signaled as DEPENDENCY_INSTRUCTIONS.
+    */
+   const bblock_t **blocks;
+   int num_blocks;
 };
 
 } /* namespace brw */
 
+/**
+ * Most invalidations only touch a few instructions, and the block-level
+ * data flow solution only has to be redone for the variables they access.
+ */
+template<>
+struct brw_analysis_traits<brw::fs_live_variables> {
+   static const bool incremental = true;
+};
+
 #endif /* BRW_FS_LIVE_VARIABLES_H */
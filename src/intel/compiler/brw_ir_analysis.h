@@ -98,6 +98,22 @@ namespace brw {
    }
 }
 
+/**
+ * Properties of an analysis result type \p T used by brw_analysis.  Analyses
+ * can specialize this to opt into the optional behavior described below.
+ */
+template<class T>
+struct brw_analysis_traits {
+   /**
+    * Whether a stale result can be brought up to date more cheaply than by
+    * computing it from scratch.  If set, invalidating the analysis only marks
+    * the cached result as stale, and the next require() constructs the new
+    * result as 'T(c, stale, dirty)' where \p dirty is the union of the
+    * dependency classes invalidated since the last computation.
+    */
+   static const bool incremental = false;
+};
+
 /**
  * Instantiate a program analysis class \p L which can calculate an object of
  * type \p T as result.  \p C is a closure that encapsulates whatever
@@ -138,7 +154,7 @@ public:
     * passed as argument to the constructor of the analysis result
     * object of type \p T.
     */
-   brw_analysis(const C *c) : c(c), p(NULL) {}
+   brw_analysis(const C *c) : c(c), p(NULL), dirty(brw::DEPENDENCY_NOTHING) {}
 
    /**
     * Destroy a program analysis.
@@ -156,6 +172,15 @@ public:
    T &
    require()
    {
+      if constexpr (brw_analysis_traits<T>::incremental) {
+         if (p && dirty) {
+            T *q = new T(c, *p, dirty);
+            delete p;
+            p = q;
+            dirty = brw::DEPENDENCY_NOTHING;
+         }
+      }
+
       if (p)
          assert(p->validate(c));
       else
@@ -179,14 +204,19 @@ public:
    invalidate(brw::analysis_dependency_class c)
    {
       if (p && (c & p->dependency_class())) {
-         delete p;
-         p = NULL;
+         if constexpr (brw_analysis_traits<T>::incremental) {
+            dirty = dirty | c;
+         } else {
+            delete p;
+            p = NULL;
+         }
       }
    }
 
 private:
    const C *c;
    T *p;
+   brw::analysis_dependency_class dirty;
 };
 
 #endif
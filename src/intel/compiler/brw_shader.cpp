@@ -21,6 +21,7 @@
  * IN THE SOFTWARE.
  */
 
+#include "brw_capture.h"
 #include "brw_cfg.h"
 #include "brw_eu.h"
 #include "brw_fs.h"
@@ -605,6 +606,19 @@ brw_compile_tes(const struct brw_compiler *compiler,
 
    const bool debug_enabled = brw_should_print_shader(nir, DEBUG_TES);
 
+   if (brw_should_capture_shader()) {
+      const struct brw_capture capture = {
+         .stage = MESA_SHADER_TESS_EVAL,
+         .devinfo = compiler->devinfo,
+         .key = key,
+         .key_size = sizeof(*key),
+         .prog_data = &prog_data->base.base,
+         .prog_data_size = sizeof(*prog_data),
+         .vue_map = input_vue_map,
+      };
+      brw_capture_shader(&capture, nir);
+   }
+
    prog_data->base.base.stage = MESA_SHADER_TESS_EVAL;
    prog_data->base.base.ray_queries = nir->info.ray_queries;
 
@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "brw_fs.h"
+#include "brw_fs_builder.h"
+#include "brw_fs_live_variables.h"
+#include "brw_cfg.h"
+
+using namespace brw;
+
+class live_variables_test : public ::testing::Test {
+protected:
+   live_variables_test();
+   ~live_variables_test() override;
+
+   void emit_program();
+   bblock_t *block_of(const fs_inst *inst);
+   void remove(fs_inst *inst);
+   void check_update(analysis_dependency_class dirty);
+
+   struct brw_compiler *compiler;
+   struct brw_compile_params params;
+   struct intel_device_info *devinfo;
+   void *ctx;
+   struct brw_wm_prog_data *prog_data;
+   fs_visitor *v;
+   fs_builder bld;
+
+   fs_reg values[40];
+   fs_reg sum;
+   fs_reg tmp;
+   fs_inst *loop_add;
+   fs_inst *copy;
+   fs_inst *then_add;
+};
+
+live_variables_test::live_variables_test()
+   : bld(NULL, 0)
+{
+   ctx = ralloc_context(NULL);
+   compiler = rzalloc(ctx, struct brw_compiler);
+   devinfo = rzalloc(ctx, struct intel_device_info);
+   compiler->devinfo = devinfo;
+
+   params = {};
+   params.mem_ctx = ctx;
+
+   prog_data = ralloc(ctx, struct brw_wm_prog_data);
+   nir_shader *shader =
+      nir_shader_create(ctx, MESA_SHADER_FRAGMENT, NULL, NULL);
+
+   v = new fs_visitor(compiler, &params, NULL, &prog_data->base, shader,
+                      16, false, false);
+
+   bld = fs_builder(v).at_end();
+
+   devinfo->ver = 9;
+   devinfo->verx10 = devinfo->ver * 10;
+}
+
+live_variables_test::~live_variables_test()
+{
+   delete v;
+   v = NULL;
+
+   ralloc_free(ctx);
+   ctx = NULL;
+}
+
+/**
+ * Emits a loop containing an if, with enough SIMD16 values live across both
+ * that the variables span several bitset words:
+ *
+ *    mov(16) values[i]  src
+ *    mov(16) sum  src
+ *    do
+ *       add(16) sum  sum  values[i]
+ *       (+f0) if(16)
+ *          mov(16) tmp  values[0]
+ *          add(16) sum  sum  tmp
+ *       endif(16)
+ *    (+f0) while(16)
+ *    add(16) sum  sum  src
+ */
+void
+live_variables_test::emit_program()
+{
+   fs_reg src = v->vgrf(glsl_float_type());
+
+   for (unsigned i = 0; i < ARRAY_SIZE(values); i++) {
+      values[i] = v->vgrf(glsl_float_type());
+      bld.MOV(values[i], src);
+   }
+
+   sum = v->vgrf(glsl_float_type());
+   tmp = v->vgrf(glsl_float_type());
+   bld.MOV(sum, src);
+
+   bld.emit(BRW_OPCODE_DO);
+   for (unsigned i = 0; i < ARRAY_SIZE(values); i++) {
+      fs_inst *add = bld.ADD(sum, sum, values[i]);
+      if (i == 3)
+         loop_add = add;
+   }
+
+   set_predicate(BRW_PREDICATE_NORMAL, bld.emit(BRW_OPCODE_IF));
+   copy = bld.MOV(tmp, values[0]);
+   then_add = bld.ADD(sum, sum, tmp);
+   bld.emit(BRW_OPCODE_ENDIF);
+   set_predicate(BRW_PREDICATE_NORMAL, bld.emit(BRW_OPCODE_WHILE));
+
+   bld.ADD(sum, sum, src);
+
+   v->calculate_cfg();
+}
+
+bblock_t *
+live_variables_test::block_of(const fs_inst *inst)
+{
+   foreach_block_and_inst(block, fs_inst, scan, v->cfg) {
+      if (scan == inst)
+         return block;
+   }
+
+   return NULL;
+}
+
+void
+live_variables_test::remove(fs_inst *inst)
+{
+   inst->remove(block_of(inst));
+}
+
+static void
+expect_bitsets_equal(const BITSET_WORD *a, const BITSET_WORD *b,
+                     int num_words)
+{
+   for (int i = 0; i < num_words; i++)
+      EXPECT_EQ(a[i], b[i]) << "word " << i;
+}
+
+/**
+ * Invalidates \p dirty and checks that the updated analysis is the same as
+ * one computed from scratch.
+ */
+void
+live_variables_test::check_update(analysis_dependency_class dirty)
+{
+   v->invalidate_analysis(dirty);
+
+   const fs_live_variables &updated = v->live_analysis.require();
+   const fs_live_variables full(v);
+
+   ASSERT_EQ(updated.num_vgrfs, full.num_vgrfs);
+   ASSERT_EQ(updated.num_vars, full.num_vars);
+
+   for (int i = 0; i < full.num_vars; i++) {
+      EXPECT_EQ(updated.start[i], full.start[i]) << "var " << i;
+      EXPECT_EQ(updated.end[i], full.end[i]) << "var " << i;
+   }
+
+   for (int i = 0; i < full.num_vgrfs; i++) {
+      EXPECT_EQ(updated.vgrf_start[i], full.vgrf_start[i]) << "vgrf " << i;
+      EXPECT_EQ(updated.vgrf_end[i], full.vgrf_end[i]) << "vgrf " << i;
+   }
+
+   for (int b = 0; b < v->cfg->num_blocks; b++) {
+      const struct fs_live_variables::block_data *ubd = &updated.block_data[b];
+      const struct fs_live_variables::block_data *fbd = &full.block_data[b];
+
+      expect_bitsets_equal(ubd->livein, fbd->livein, full.bitset_words);
+      expect_bitsets_equal(ubd->liveout, fbd->liveout, full.bitset_words);
+      expect_bitsets_equal(ubd->defin, fbd->defin, full.bitset_words);
+      expect_bitsets_equal(ubd->defout, fbd->defout, full.bitset_words);
+      EXPECT_EQ(ubd->flag_livein[0], fbd->flag_livein[0]);
+      EXPECT_EQ(ubd->flag_liveout[0], fbd->flag_liveout[0]);
+   }
+}
+
+TEST_F(live_variables_test, remove_instruction)
+{
+   emit_program();
+   v->live_analysis.require();
+
+   /* tmp is no longer read, and sum is no longer written in the if. */
+   remove(then_add);
+   check_update(DEPENDENCY_INSTRUCTIONS);
+
+   /* This empties the then block, which removes the block too. */
+   remove(copy);
+   check_update(DEPENDENCY_INSTRUCTIONS);
+}
+
+TEST_F(live_variables_test, rename_register)
+{
+   emit_program();
+   v->live_analysis.require();
+
+   /* values[3] is now dead after the loop header, and values[35], in a
+    * different bitset word, is read one more time.
+    */
+   loop_add->src[1] = values[35];
+   check_update(DEPENDENCY_INSTRUCTION_DATA_FLOW);
+}
+
+TEST_F(live_variables_test, coalesce)
+{
+   emit_program();
+   v->live_analysis.require();
+
+   /* What register coalescing does with the copy. */
+   then_add->src[1] = values[0];
+   remove(copy);
+   check_update(DEPENDENCY_INSTRUCTIONS);
+}
+
+TEST_F(live_variables_test, new_register)
+{
+   emit_program();
+   v->live_analysis.require();
+
+   /* A VGRF appended by the pass and used within the loop. */
+   const fs_reg added = v->vgrf(glsl_float_type());
+   const fs_builder ibld = fs_builder(v, block_of(then_add), then_add);
+   ibld.MOV(added, values[1]);
+   then_add->src[1] = added;
+   check_update(DEPENDENCY_INSTRUCTIONS | DEPENDENCY_VARIABLES);
+}
+
+TEST_F(live_variables_test, flag_write)
+{
+   emit_program();
+   v->live_analysis.require();
+
+   /* The if and while now read a flag written in the loop. */
+   const fs_builder ibld = fs_builder(v, block_of(loop_add), loop_add);
+   ibld.CMP(bld.null_reg_f(), values[2], brw_imm_f(0.0f),
+            BRW_CONDITIONAL_L);
+   check_update(DEPENDENCY_INSTRUCTIONS);
+}
+
+TEST_F(live_variables_test, unchanged)
+{
+   emit_program();
+   v->live_analysis.require();
+
+   /* Only the instruction numbering changes. */
+   const fs_builder ibld = fs_builder(v, block_of(loop_add), loop_add);
+   ibld.emit(BRW_OPCODE_NOP);
+   check_update(DEPENDENCY_INSTRUCTIONS);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <gtest/gtest.h>
+#include "brw_fs.h"
+#include "brw_fs_builder.h"
+#include "brw_cfg.h"
+
+using namespace brw;
+
+class pre_ra_viable_test : public ::testing::Test {
+protected:
+   pre_ra_viable_test();
+   ~pre_ra_viable_test() override;
+
+   void emit_live_across_if(unsigned num_values);
+
+   struct brw_compiler *compiler;
+   struct brw_compile_params params;
+   struct intel_device_info *devinfo;
+   void *ctx;
+   struct brw_wm_prog_data *prog_data;
+   fs_visitor *v;
+   fs_builder bld;
+};
+
+pre_ra_viable_test::pre_ra_viable_test()
+   : bld(NULL, 0)
+{
+   ctx = ralloc_context(NULL);
+   compiler = rzalloc(ctx, struct brw_compiler);
+   devinfo = rzalloc(ctx, struct intel_device_info);
+   compiler->devinfo = devinfo;
+
+   params = {};
+   params.mem_ctx = ctx;
+
+   prog_data = ralloc(ctx, struct brw_wm_prog_data);
+   nir_shader *shader =
+      nir_shader_create(ctx, MESA_SHADER_FRAGMENT, NULL, NULL);
+
+   v = new fs_visitor(compiler, &params, NULL, &prog_data->base, shader,
+                      16, false, false);
+
+   bld = fs_builder(v).at_end();
+
+   devinfo->ver = 9;
+   devinfo->verx10 = devinfo->ver * 10;
+}
+
+pre_ra_viable_test::~pre_ra_viable_test()
+{
+   delete v;
+   v = NULL;
+
+   ralloc_free(ctx);
+   ctx = NULL;
+}
+
+/**
+ * Emits \p num_values SIMD16 values, each two registers, which are defined
+ * before an if and only read after it:
+ *
+ *    mov(16) vgrf[i]  src
+ *    (+f0) if(16)
+ *    add(16) tmp  src  src
+ *    endif(16)
+ *    add(16) sum  sum  vgrf[i]
+ */
+void
+pre_ra_viable_test::emit_live_across_if(unsigned num_values)
+{
+   fs_reg src = v->vgrf(glsl_float_type());
+   fs_reg *values = new fs_reg[num_values];
+
+   for (unsigned i = 0; i < num_values; i++) {
+      values[i] = v->vgrf(glsl_float_type());
+      bld.MOV(values[i], src);
+   }
+
+   set_predicate(BRW_PREDICATE_NORMAL, bld.emit(BRW_OPCODE_IF));
+   bld.ADD(v->vgrf(glsl_float_type()), src, src);
+   bld.emit(BRW_OPCODE_ENDIF);
+
+   fs_reg sum = v->vgrf(glsl_float_type());
+   bld.MOV(sum, src);
+   for (unsigned i = 0; i < num_values; i++)
+      bld.ADD(sum, sum, values[i]);
+
+   delete[] values;
+
+   v->calculate_cfg();
+}
+
+TEST_F(pre_ra_viable_test, fits)
+{
+   /* 2 * 60 registers live across the if. */
+   emit_live_across_if(60);
+
+   EXPECT_TRUE(v->pre_ra_viable());
+   EXPECT_FALSE(v->failed);
+}
+
+TEST_F(pre_ra_viable_test, cannot_fit)
+{
+   /* 2 * 70 registers live across the if, more than the 128 there are. */
+   emit_live_across_if(70);
+
+   EXPECT_FALSE(v->pre_ra_viable());
+   EXPECT_TRUE(v->failed);
+}
+
+TEST_F(pre_ra_viable_test, high_pressure_within_block)
+{
+   /* The same values with the if removed are never live across a block, so
+    * the scheduler may still bring the pressure down.
+    */
+   fs_reg src = v->vgrf(glsl_float_type());
+   fs_reg sum = v->vgrf(glsl_float_type());
+   fs_reg values[70];
+
+   for (unsigned i = 0; i < ARRAY_SIZE(values); i++) {
+      values[i] = v->vgrf(glsl_float_type());
+      bld.MOV(values[i], src);
+   }
+
+   bld.MOV(sum, src);
+   for (unsigned i = 0; i < ARRAY_SIZE(values); i++)
+      bld.ADD(sum, sum, values[i]);
+
+   v->calculate_cfg();
+
+   EXPECT_TRUE(v->pre_ra_viable());
+}
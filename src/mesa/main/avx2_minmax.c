@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* AVX2 variant of sse_minmax.c, built with -mavx2 and only called when the
+ * CPU reports AVX2 support.
+ */
+
+#include "main/sse_minmax.h"
+#include "util/macros.h"
+#include <immintrin.h>
+#include <stdint.h>
+
+#define AVX2_MIN_MAX(name, type, set1, cmpeq, vmin_op, vmax_op)              \
+static void                                                                  \
+name(const type *indices, unsigned count, bool restart,                      \
+     unsigned restart_index, unsigned *min_index, unsigned *max_index)       \
+{                                                                            \
+   const unsigned lanes = sizeof(__m256i) / sizeof(type);                    \
+   const __m256i vrestart = set1((type)restart_index);                       \
+   __m256i vmin = _mm256_set1_epi32(~0);                                     \
+   __m256i vmax = _mm256_setzero_si256();                                    \
+   unsigned min_val = ~0U, max_val = 0, i = 0;                               \
+                                                                             \
+   if (restart) {                                                            \
+      for (; i + lanes <= count; i += lanes) {                               \
+         __m256i v = _mm256_loadu_si256((const __m256i *)&indices[i]);       \
+         __m256i skip = cmpeq(v, vrestart);                                  \
+         vmin = vmin_op(vmin, _mm256_or_si256(v, skip));                     \
+         vmax = vmax_op(vmax, _mm256_andnot_si256(skip, v));                 \
+      }                                                                      \
+   } else {                                                                  \
+      for (; i + lanes <= count; i += lanes) {                               \
+         __m256i v = _mm256_loadu_si256((const __m256i *)&indices[i]);       \
+         vmin = vmin_op(vmin, v);                                            \
+         vmax = vmax_op(vmax, v);                                            \
+      }                                                                      \
+   }                                                                         \
+                                                                             \
+   if (i > 0) {                                                              \
+      type min_arr[sizeof(__m256i) / sizeof(type)];                          \
+      type max_arr[sizeof(__m256i) / sizeof(type)];                          \
+      _mm256_storeu_si256((__m256i *)min_arr, vmin);                         \
+      _mm256_storeu_si256((__m256i *)max_arr, vmax);                         \
+      for (unsigned j = 0; j < lanes; j++) {                                 \
+         min_val = MIN2(min_val, min_arr[j]);                                \
+         max_val = MAX2(max_val, max_arr[j]);                                \
+      }                                                                      \
+   }                                                                         \
+                                                                             \
+   for (; i < count; i++) {                                                  \
+      if (restart && indices[i] == restart_index)                            \
+         continue;                                                           \
+      min_val = MIN2(min_val, indices[i]);                                   \
+      max_val = MAX2(max_val, indices[i]);                                   \
+   }                                                                         \
+                                                                             \
+   *min_index = min_val;                                                     \
+   *max_index = max_val;                                                     \
+}
+
+static inline __m256i
+avx2_set1_u8(uint8_t v)
+{
+   return _mm256_set1_epi8((char)v);
+}
+
+static inline __m256i
+avx2_set1_u16(uint16_t v)
+{
+   return _mm256_set1_epi16((short)v);
+}
+
+static inline __m256i
+avx2_set1_u32(uint32_t v)
+{
+   return _mm256_set1_epi32((int)v);
+}
+
+AVX2_MIN_MAX(min_max_u8, uint8_t, avx2_set1_u8, _mm256_cmpeq_epi8,
+              _mm256_min_epu8, _mm256_max_epu8)
+AVX2_MIN_MAX(min_max_u16, uint16_t, avx2_set1_u16, _mm256_cmpeq_epi16,
+              _mm256_min_epu16, _mm256_max_epu16)
+AVX2_MIN_MAX(min_max_u32, uint32_t, avx2_set1_u32, _mm256_cmpeq_epi32,
+              _mm256_min_epu32, _mm256_max_epu32)
+
+void
+_mesa_index_array_min_max_avx2(const void *indices, unsigned index_size,
+                                unsigned count, bool restart,
+                                unsigned restart_index,
+                                unsigned *min_index, unsigned *max_index)
+{
+   switch (index_size) {
+   case 4:
+      min_max_u32(indices, count, restart, restart_index,
+                  min_index, max_index);
+      break;
+   case 2:
+      min_max_u16(indices, count, restart, restart_index,
+                  min_index, max_index);
+      break;
+   case 1:
+      min_max_u8(indices, count, restart, restart_index,
+                 min_index, max_index);
+      break;
+   default:
+      unreachable("not reached");
+   }
+}
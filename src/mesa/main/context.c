@@ -120,6 +120,7 @@
 #include "remap.h"
 #include "scissor.h"
 #include "shared.h"
+#include "shaderapi.h"
 #include "shaderobj.h"
 #include "shaderimage.h"
 #include "state.h"
@@ -1199,6 +1200,12 @@ _mesa_free_context_data(struct gl_context *ctx, bool destroy_debug_output)
    }
 
    /* Do this after unbinding context to ensure any thread is finished. */
+   _mesa_finish_shader_compiles(ctx);
+   if (util_queue_is_initialized(&ctx->shader_compile_queue))
+      util_queue_destroy(&ctx->shader_compile_queue);
+   if (util_queue_is_initialized(&ctx->texstore_queue))
+      util_queue_destroy(&ctx->texstore_queue);
+
    if (ctx->shader_builtin_ref) {
       _mesa_glsl_builtin_functions_decref();
       ctx->shader_builtin_ref = false;
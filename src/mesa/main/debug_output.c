@@ -31,6 +31,7 @@
 
 #include "hash.h"
 #include "mtypes.h"
+#include "shaderapi.h"
 #include "version.h"
 #include "util/hash_table.h"
 #include "util/list.h"
@@ -1224,6 +1225,10 @@ void GLAPIENTRY
 _mesa_DebugMessageCallback(GLDEBUGPROC callback, const void *userParam)
 {
    GET_CURRENT_CONTEXT(ctx);
+
+   /* Offloaded compiles may report messages to the old callback. */
+   _mesa_finish_shader_compiles(ctx);
+
    struct gl_debug_state *debug = _mesa_lock_debug_state(ctx);
    if (debug) {
       debug->Callback = callback;
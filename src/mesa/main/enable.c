@@ -40,6 +40,7 @@
 #include "light.h"
 #include "mtypes.h"
 #include "enums.h"
+#include "shaderapi.h"
 #include "state.h"
 #include "texstate.h"
 #include "varray.h"
@@ -513,6 +514,10 @@ _mesa_set_enable(struct gl_context *ctx, GLenum cap, GLboolean state)
          break;
       case GL_DEBUG_OUTPUT:
       case GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB:
+         /* Offloaded compiles must not report messages past this point
+          * with the old settings.
+          */
+         _mesa_finish_shader_compiles(ctx);
          _mesa_set_debug_state_int(ctx, cap, state);
          _mesa_update_debug_callback(ctx);
          break;
@@ -191,6 +191,12 @@ struct glthread_state
    GLenum16 ListMode; /**< Zero if not inside display list, else list mode. */
    unsigned ListBase;
    unsigned ListCallDepth;
+   /**
+    * Whether a display list compiled by this context may contain calls that
+    * glthread tracks. Until then, glCallList doesn't need to replay lists
+    * in the application thread and doesn't have to wait for glEndList.
+    */
+   bool ListsAffectGLThread;
 
    /** For L3 cache pinning. */
    unsigned pin_thread_counter;
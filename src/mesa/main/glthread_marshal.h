@@ -452,10 +452,24 @@ _mesa_get_matrix_index(struct gl_context *ctx, GLenum mode)
    return M_DUMMY;
 }
 
+/* Return whether a call that glthread tracks is only compiled into a display
+ * list and must not be tracked now. Such a call in any display list means
+ * that glCallList has to replay lists in this thread from now on.
+ */
+static inline bool
+_mesa_glthread_list_compile_only(struct gl_context *ctx)
+{
+   if (likely(!ctx->GLThread.ListMode))
+      return false;
+
+   ctx->GLThread.ListsAffectGLThread = true;
+   return ctx->GLThread.ListMode == GL_COMPILE;
+}
+
 static inline void
 _mesa_glthread_Enable(struct gl_context *ctx, GLenum cap)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    switch (cap) {
@@ -500,7 +514,7 @@ _mesa_glthread_Enable(struct gl_context *ctx, GLenum cap)
 static inline void
 _mesa_glthread_Disable(struct gl_context *ctx, GLenum cap)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    switch (cap) {
@@ -579,7 +593,7 @@ _mesa_glthread_IsEnabled(struct gl_context *ctx, GLenum cap)
 static inline void
 _mesa_glthread_PushAttrib(struct gl_context *ctx, GLbitfield mask)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    if (ctx->GLThread.AttribStackDepth >= MAX_ATTRIB_STACK_DEPTH)
@@ -614,7 +628,7 @@ _mesa_glthread_PushAttrib(struct gl_context *ctx, GLbitfield mask)
 static inline void
 _mesa_glthread_PopAttrib(struct gl_context *ctx)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    if (ctx->GLThread.AttribStackDepth == 0)
@@ -671,7 +685,7 @@ is_matrix_stack_full(struct gl_context *ctx, gl_matrix_index idx)
 static inline void
 _mesa_glthread_MatrixPushEXT(struct gl_context *ctx, GLenum matrixMode)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    if (is_matrix_stack_full(ctx, _mesa_get_matrix_index(ctx, matrixMode)))
@@ -683,7 +697,7 @@ _mesa_glthread_MatrixPushEXT(struct gl_context *ctx, GLenum matrixMode)
 static inline void
 _mesa_glthread_MatrixPopEXT(struct gl_context *ctx, GLenum matrixMode)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    if (ctx->GLThread.MatrixStackDepth[_mesa_get_matrix_index(ctx, matrixMode)] == 0)
@@ -695,7 +709,7 @@ _mesa_glthread_MatrixPopEXT(struct gl_context *ctx, GLenum matrixMode)
 static inline void
 _mesa_glthread_ActiveTexture(struct gl_context *ctx, GLenum texture)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    ctx->GLThread.ActiveTexture = texture - GL_TEXTURE0;
@@ -706,7 +720,7 @@ _mesa_glthread_ActiveTexture(struct gl_context *ctx, GLenum texture)
 static inline void
 _mesa_glthread_PushMatrix(struct gl_context *ctx)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    if (is_matrix_stack_full(ctx, ctx->GLThread.MatrixIndex))
@@ -718,7 +732,7 @@ _mesa_glthread_PushMatrix(struct gl_context *ctx)
 static inline void
 _mesa_glthread_PopMatrix(struct gl_context *ctx)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    if (ctx->GLThread.MatrixStackDepth[ctx->GLThread.MatrixIndex] == 0)
@@ -730,7 +744,7 @@ _mesa_glthread_PopMatrix(struct gl_context *ctx)
 static inline void
 _mesa_glthread_MatrixMode(struct gl_context *ctx, GLenum mode)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    ctx->GLThread.MatrixIndex = _mesa_get_matrix_index(ctx, mode);
@@ -740,7 +754,7 @@ _mesa_glthread_MatrixMode(struct gl_context *ctx, GLenum mode)
 static inline void
 _mesa_glthread_ListBase(struct gl_context *ctx, GLuint base)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    ctx->GLThread.ListBase = base;
@@ -782,7 +796,14 @@ _mesa_glthread_wait_for_call(struct gl_context *ctx,
 static inline void
 _mesa_glthread_CallList(struct gl_context *ctx, GLuint list)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
+      return;
+
+   /* Nothing to replay here if no list can change glthread state. This
+    * avoids waiting for the driver thread to finish compiling lists.
+    */
+   if (!ctx->GLThread.ListsAffectGLThread &&
+       !p_atomic_read(&ctx->Shared->DisplayListsAffectGLThread))
       return;
 
    /* Wait for all glEndList and glDeleteLists calls to finish to ensure that
@@ -807,12 +828,16 @@ static inline void
 _mesa_glthread_CallLists(struct gl_context *ctx, GLsizei n, GLenum type,
                          const GLvoid *lists)
 {
-   if (ctx->GLThread.ListMode == GL_COMPILE)
+   if (_mesa_glthread_list_compile_only(ctx))
       return;
 
    if (n <= 0 || !lists)
       return;
 
+   if (!ctx->GLThread.ListsAffectGLThread &&
+       !p_atomic_read(&ctx->Shared->DisplayListsAffectGLThread))
+      return;
+
    /* Wait for all glEndList and glDeleteLists calls to finish to ensure that
     * all display lists are up to date and the driver thread is not
     * modifiying them. We will be executing them in the application thread.
@@ -3636,6 +3636,18 @@ struct gl_context
 
    bool shader_builtin_ref;
 
+   /**
+    * Threads glCompileShader is offloaded to, for
+    * GL_KHR_parallel_shader_compile.  Initialized on first use.
+    */
+   struct util_queue shader_compile_queue;
+
+   /**
+    * Threads that large texture uploads needing format conversion are
+    * split across, see store_texsubimage().  Initialized on first use.
+    */
+   struct util_queue texstore_queue;
+
    struct pipe_draw_start_count_bias *tmp_draws;
    unsigned num_tmp_draws;
 };
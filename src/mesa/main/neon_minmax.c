@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/* NEON variant of sse_minmax.c for AArch64, where NEON is always present. */
+
+#include "main/sse_minmax.h"
+#include "util/macros.h"
+#include <arm_neon.h>
+#include <stdint.h>
+
+#define NEON_MIN_MAX(name, type, vtype, sfx)                                 \
+static void                                                                  \
+name(const type *indices, unsigned count, bool restart,                      \
+     unsigned restart_index, unsigned *min_index, unsigned *max_index)       \
+{                                                                            \
+   const unsigned lanes = 16 / sizeof(type);                                 \
+   const vtype vrestart = vdupq_n_##sfx((type)restart_index);                \
+   vtype vmin = vdupq_n_##sfx((type)~0);                                     \
+   vtype vmax = vdupq_n_##sfx(0);                                            \
+   unsigned min_val = ~0U, max_val = 0, i = 0;                               \
+                                                                             \
+   if (restart) {                                                            \
+      for (; i + lanes <= count; i += lanes) {                               \
+         vtype v = vld1q_##sfx(&indices[i]);                                 \
+         vtype skip = vceqq_##sfx(v, vrestart);                              \
+         vmin = vminq_##sfx(vmin, vorrq_##sfx(v, skip));                     \
+         vmax = vmaxq_##sfx(vmax, vbicq_##sfx(v, skip));                     \
+      }                                                                      \
+   } else {                                                                  \
+      for (; i + lanes <= count; i += lanes) {                               \
+         vtype v = vld1q_##sfx(&indices[i]);                                 \
+         vmin = vminq_##sfx(vmin, v);                                        \
+         vmax = vmaxq_##sfx(vmax, v);                                        \
+      }                                                                      \
+   }                                                                         \
+                                                                             \
+   if (i > 0) {                                                              \
+      min_val = vminvq_##sfx(vmin);                                          \
+      max_val = vmaxvq_##sfx(vmax);                                          \
+   }                                                                         \
+                                                                             \
+   for (; i < count; i++) {                                                  \
+      if (restart && indices[i] == restart_index)                            \
+         continue;                                                           \
+      min_val = MIN2(min_val, indices[i]);                                   \
+      max_val = MAX2(max_val, indices[i]);                                   \
+   }                                                                         \
+                                                                             \
+   *min_index = min_val;                                                     \
+   *max_index = max_val;                                                     \
+}
+
+NEON_MIN_MAX(min_max_u8, uint8_t, uint8x16_t, u8)
+NEON_MIN_MAX(min_max_u16, uint16_t, uint16x8_t, u16)
+NEON_MIN_MAX(min_max_u32, uint32_t, uint32x4_t, u32)
+
+void
+_mesa_index_array_min_max_neon(const void *indices, unsigned index_size,
+                               unsigned count, bool restart,
+                               unsigned restart_index,
+                               unsigned *min_index, unsigned *max_index)
+{
+   switch (index_size) {
+   case 4:
+      min_max_u32(indices, count, restart, restart_index,
+                  min_index, max_index);
+      break;
+   case 2:
+      min_max_u16(indices, count, restart, restart_index,
+                  min_index, max_index);
+      break;
+   case 1:
+      min_max_u8(indices, count, restart, restart_index,
+                 min_index, max_index);
+      break;
+   default:
+      unreachable("not reached");
+   }
+}
@@ -35,6 +35,7 @@
 #include "util/glheader.h"
 #include "main/menums.h"
 #include "util/mesa-sha1.h"
+#include "util/u_queue.h"
 #include "compiler/shader_info.h"
 #include "compiler/glsl/list.h"
 #include "compiler/glsl/ir_uniform.h"
@@ -154,6 +155,13 @@ struct gl_shader
 
    enum gl_compile_status CompileStatus;
 
+   /**
+    * Signalled once a compile deferred to gl_context::shader_compile_queue
+    * has finished.  Use _mesa_wait_shader_compile() before accessing any of
+    * the compile results.
+    */
+   struct util_queue_fence compile_fence;
+
    /** SHA1 of the pre-processed source used by the disk cache. */
    uint8_t disk_cache_sha1[SHA1_DIGEST_LENGTH];
    /** SHA1 of the original source before replacement, set by glShaderSource. */
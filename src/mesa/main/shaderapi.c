@@ -38,6 +38,7 @@
 
 #include "util/glheader.h"
 #include "main/context.h"
+#include "main/debug_output.h"
 #include "draw_validate.h"
 #include "main/enums.h"
 #include "main/glspirv.h"
@@ -64,6 +65,7 @@
 #include "util/os_file.h"
 #include "util/list.h"
 #include "util/perf/cpu_trace.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_process.h"
 #include "util/u_string.h"
 #include "api_exec_decl.h"
@@ -1045,14 +1047,20 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
    switch (pname) {
    case GL_SHADER_TYPE:
       *params = shader->Type;
-      break;
+      return;
    case GL_DELETE_STATUS:
       *params = shader->DeletePending;
-      break;
+      return;
    case GL_COMPLETION_STATUS_ARB:
-      /* _mesa_glsl_compile_shader is not offloaded to other threads. */
-      *params = GL_TRUE;
+      *params = util_queue_fence_is_signalled(&shader->compile_fence);
       return;
+   default:
+      break;
+   }
+
+   _mesa_wait_shader_compile(shader);
+
+   switch (pname) {
    case GL_COMPILE_STATUS:
       *params = shader->CompileStatus ? GL_TRUE : GL_FALSE;
       break;
@@ -1122,6 +1130,8 @@ get_shader_info_log(struct gl_context *ctx, GLuint shader, GLsizei bufSize,
       return;
    }
 
+   _mesa_wait_shader_compile(sh);
+
    _mesa_copy_string(infoLog, bufSize, length, sh->InfoLog);
 }
 
@@ -1158,6 +1168,8 @@ set_shader_source(struct gl_shader *sh, const GLchar *source,
 {
    assert(sh);
 
+   _mesa_wait_shader_compile(sh);
+
    /* The GL_ARB_gl_spirv spec adds the following to the end of the description
     * of ShaderSource:
     *
@@ -1193,15 +1205,108 @@ ensure_builtin_types(struct gl_context *ctx)
    }
 }
 
+struct compile_shader_job {
+   struct gl_context *ctx;
+   struct gl_shader *sh;
+   struct _mesa_glsl_parse_state *state;
+   const char *source;
+   GLbitfield flags;
+};
+
+static void
+compile_shader_job_execute(void *data, UNUSED void *gdata,
+                           UNUSED int thread_index)
+{
+   struct compile_shader_job *job = data;
+
+   _mesa_glsl_compile_preprocessed_shader(job->ctx, job->sh, job->state,
+                                          job->source, false, false, false,
+                                          job->flags);
+}
+
+static void
+compile_shader_job_cleanup(void *data, UNUSED void *gdata,
+                           UNUSED int thread_index)
+{
+   free(data);
+}
+
+/**
+ * Whether glCompileShader may offload compiles to
+ * ctx->shader_compile_queue.
+ *
+ * Only preprocessing looks at state the application can change, so it is
+ * done before the job is queued.  The rest of the GLSL compiler only reads
+ * constant context state, so as long as everything that looks at the
+ * results waits for the compile to finish, this is invisible to the
+ * application except for GL_COMPLETION_STATUS_KHR.
+ */
+static bool
+can_offload_compile(struct gl_context *ctx)
+{
+   /* GL_KHR_parallel_shader_compile: "If <count> is zero, the
+    * implementation may not use additional threads".
+    */
+   if (ctx->Hint.MaxShaderCompilerThreads == 0)
+      return false;
+
+   /* Logging and dumping happen on the calling thread right after the
+    * compile.
+    */
+   if (ctx->_Shader->Flags)
+      return false;
+
+   /* Compiler warnings and errors are also reported through KHR_debug.
+    * Unless the application asked for asynchronous delivery to a callback,
+    * they have to be delivered on the calling thread before glCompileShader
+    * returns.
+    */
+   if (_mesa_get_debug_state_int(ctx, GL_DEBUG_OUTPUT) &&
+       (_mesa_get_debug_state_int(ctx, GL_DEBUG_OUTPUT_SYNCHRONOUS) ||
+        !_mesa_get_debug_state_ptr(ctx, GL_DEBUG_CALLBACK_FUNCTION)))
+      return false;
+
+   if (!util_queue_is_initialized(&ctx->shader_compile_queue)) {
+      unsigned num_threads =
+         MIN2(util_get_cpu_caps()->nr_cpus,
+              ctx->Hint.MaxShaderCompilerThreads);
+
+      if (!util_queue_init(&ctx->shader_compile_queue, "glsl_compile", 64,
+                           MAX2(num_threads, 1),
+                           UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                           UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY, NULL))
+         return false;
+   }
+
+   return true;
+}
+
+/**
+ * Wait for all offloaded compiles issued from this context.  Must be done
+ * before the context goes away or the built-in functions are released.
+ */
+void
+_mesa_finish_shader_compiles(struct gl_context *ctx)
+{
+   if (util_queue_is_initialized(&ctx->shader_compile_queue))
+      util_queue_finish(&ctx->shader_compile_queue);
+}
+
 /**
  * Compile a shader.
+ *
+ * \param allow_offload  Whether the compile may finish on
+ *                       ctx->shader_compile_queue after this returns.
  */
 void
-_mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
+_mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh,
+                     bool allow_offload)
 {
    if (!sh)
       return;
 
+   _mesa_wait_shader_compile(sh);
+
    /* The GL_ARB_gl_spirv spec says:
     *
     *    "Add a new error for the CompileShader command:
@@ -1228,6 +1333,31 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
 
       ensure_builtin_types(ctx);
 
+      if (allow_offload && can_offload_compile(ctx)) {
+         struct compile_shader_job *job =
+            malloc(sizeof(struct compile_shader_job));
+
+         if (job) {
+            /* Copied here, the worker must not look at ctx->_Shader. */
+            job->flags = ctx->_Shader->Flags;
+            job->state = _mesa_glsl_preprocess_shader(ctx, sh, false,
+                                                      job->flags,
+                                                      &job->source);
+            if (!job->state) {
+               /* Found in the shader cache. */
+               free(job);
+               return;
+            }
+
+            job->ctx = ctx;
+            job->sh = sh;
+            util_queue_add_job(&ctx->shader_compile_queue, job,
+                               &sh->compile_fence, compile_shader_job_execute,
+                               compile_shader_job_cleanup, 0);
+            return;
+         }
+      }
+
       /* this call will set the shader->CompileStatus field to indicate if
        * compilation was successful.
        */
@@ -1330,6 +1460,10 @@ link_program(struct gl_context *ctx, struct gl_shader_program *shProg,
          }
       }
 
+   /* Linking needs the results of any offloaded glCompileShader. */
+   for (unsigned i = 0; i < shProg->NumShaders; i++)
+      _mesa_wait_shader_compile(shProg->Shaders[i]);
+
    ensure_builtin_types(ctx);
 
    FLUSH_VERTICES(ctx, 0, 0);
@@ -1632,7 +1766,8 @@ _mesa_CompileShader(GLuint shaderObj)
    if (MESA_VERBOSE & VERBOSE_API)
       _mesa_debug(ctx, "glCompileShader %u\n", shaderObj);
    _mesa_compile_shader(ctx, _mesa_lookup_shader_err(ctx, shaderObj,
-                                                     "glCompileShader"));
+                                                     "glCompileShader"),
+                        true);
 }
 
 
@@ -2344,6 +2479,8 @@ _mesa_ReleaseShaderCompiler(void)
 {
    GET_CURRENT_CONTEXT(ctx);
 
+   _mesa_finish_shader_compiles(ctx);
+
    if (ctx->shader_builtin_ref) {
       _mesa_glsl_builtin_functions_decref();
       ctx->shader_builtin_ref = false;
@@ -2694,7 +2831,7 @@ _mesa_CreateShaderProgramv_impl(struct gl_context *ctx,
       struct gl_shader *sh = _mesa_lookup_shader(ctx, shader);
 
       _mesa_ShaderSource(shader, count, strings, NULL);
-      _mesa_compile_shader(ctx, sh);
+      _mesa_compile_shader(ctx, sh, false);
 
       program = create_shader_program(ctx);
       if (program) {
@@ -3673,7 +3810,8 @@ _mesa_CompileShaderIncludeARB(GLuint shader, GLsizei count,
       goto exit;
    }
 
-   _mesa_compile_shader(ctx, sh);
+   /* The search paths are reset as soon as we return. */
+   _mesa_compile_shader(ctx, sh, false);
 
 exit:
    ctx->Shared->ShaderIncludes->num_include_paths = 0;
@@ -68,7 +68,11 @@ _mesa_active_program(struct gl_context *ctx, struct gl_shader_program *shProg,
 		     const char *caller);
 
 extern void
-_mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh);
+_mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh,
+                     bool allow_offload);
+
+extern void
+_mesa_finish_shader_compiles(struct gl_context *ctx);
 
 extern void
 _mesa_link_program(struct gl_context *ctx, struct gl_shader_program *sh_prog);
@@ -30,66 +30,103 @@
 #include <smmintrin.h>
 #include <stdint.h>
 
-void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
-{
-   unsigned max_ui = 0;
-   unsigned min_ui = ~0U;
-   unsigned i = 0;
-   unsigned aligned_count = count;
-
-   /* handle the first few values without SSE until the pointer is aligned */
-   while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
-
-      aligned_count--;
-      ui_indices++;
-   }
+/* Restart indices are folded into the running minimum as all-ones and into
+ * the running maximum as zero, so they never change the result and the loop
+ * stays branch-free.
+ */
+#define SSE41_MIN_MAX(name, type, set1, cmpeq, vmin_op, vmax_op)             \
+static void                                                                  \
+name(const type *indices, unsigned count, bool restart,                      \
+     unsigned restart_index, unsigned *min_index, unsigned *max_index)       \
+{                                                                            \
+   const unsigned lanes = sizeof(__m128i) / sizeof(type);                    \
+   const __m128i vrestart = set1((type)restart_index);                       \
+   __m128i vmin = _mm_set1_epi32(~0);                                        \
+   __m128i vmax = _mm_setzero_si128();                                       \
+   unsigned min_val = ~0U, max_val = 0, i = 0;                               \
+                                                                             \
+   if (restart) {                                                            \
+      for (; i + lanes <= count; i += lanes) {                               \
+         __m128i v = _mm_loadu_si128((const __m128i *)&indices[i]);          \
+         __m128i skip = cmpeq(v, vrestart);                                  \
+         vmin = vmin_op(vmin, _mm_or_si128(v, skip));                        \
+         vmax = vmax_op(vmax, _mm_andnot_si128(skip, v));                    \
+      }                                                                      \
+   } else {                                                                  \
+      for (; i + lanes <= count; i += lanes) {                               \
+         __m128i v = _mm_loadu_si128((const __m128i *)&indices[i]);          \
+         vmin = vmin_op(vmin, v);                                            \
+         vmax = vmax_op(vmax, v);                                            \
+      }                                                                      \
+   }                                                                         \
+                                                                             \
+   if (i > 0) {                                                              \
+      type min_arr[sizeof(__m128i) / sizeof(type)];                          \
+      type max_arr[sizeof(__m128i) / sizeof(type)];                          \
+      _mm_storeu_si128((__m128i *)min_arr, vmin);                            \
+      _mm_storeu_si128((__m128i *)max_arr, vmax);                            \
+      for (unsigned j = 0; j < lanes; j++) {                                 \
+         min_val = MIN2(min_val, min_arr[j]);                                \
+         max_val = MAX2(max_val, max_arr[j]);                                \
+      }                                                                      \
+   }                                                                         \
+                                                                             \
+   for (; i < count; i++) {                                                  \
+      if (restart && indices[i] == restart_index)                            \
+         continue;                                                           \
+      min_val = MIN2(min_val, indices[i]);                                   \
+      max_val = MAX2(max_val, indices[i]);                                   \
+   }                                                                         \
+                                                                             \
+   *min_index = min_val;                                                     \
+   *max_index = max_val;                                                     \
+}
 
-   /* TODO: The actual threshold for SSE begin useful may be higher than 8.
-    * Some careful microbenchmarks and measurement are required to
-    * find the actual tipping point.
-    */
-   if (aligned_count >= 8) {
-      alignas(16) unsigned max_arr[4];
-      alignas(16) unsigned min_arr[4];
-      unsigned vec_count;
-      __m128i max_ui4 = _mm_setzero_si128();
-      __m128i min_ui4 = _mm_set1_epi32(~0U);
-      __m128i ui_indices4;
-      __m128i *ui_indices_ptr;
+static inline __m128i
+sse_set1_u8(uint8_t v)
+{
+   return _mm_set1_epi8((char)v);
+}
 
-      vec_count = aligned_count & ~0x3;
-      ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
-      }
+static inline __m128i
+sse_set1_u16(uint16_t v)
+{
+   return _mm_set1_epi16((short)v);
+}
 
-      _mm_store_si128((__m128i *)max_arr, max_ui4);
-      _mm_store_si128((__m128i *)min_arr, min_ui4);
+static inline __m128i
+sse_set1_u32(uint32_t v)
+{
+   return _mm_set1_epi32((int)v);
+}
 
-      for (i = 0; i < 4; i++) {
-         if (max_arr[i] > max_ui)
-            max_ui = max_arr[i];
-         if (min_arr[i] < min_ui)
-            min_ui = min_arr[i];
-      }
-      i = vec_count;
-   }
+SSE41_MIN_MAX(min_max_u8, uint8_t, sse_set1_u8, _mm_cmpeq_epi8,
+              _mm_min_epu8, _mm_max_epu8)
+SSE41_MIN_MAX(min_max_u16, uint16_t, sse_set1_u16, _mm_cmpeq_epi16,
+              _mm_min_epu16, _mm_max_epu16)
+SSE41_MIN_MAX(min_max_u32, uint32_t, sse_set1_u32, _mm_cmpeq_epi32,
+              _mm_min_epu32, _mm_max_epu32)
 
-   for (; i < aligned_count; i++) {
-      if (ui_indices[i] > max_ui)
-         max_ui = ui_indices[i];
-      if (ui_indices[i] < min_ui)
-         min_ui = ui_indices[i];
+void
+_mesa_index_array_min_max_sse41(const void *indices, unsigned index_size,
+                                unsigned count, bool restart,
+                                unsigned restart_index,
+                                unsigned *min_index, unsigned *max_index)
+{
+   switch (index_size) {
+   case 4:
+      min_max_u32(indices, count, restart, restart_index,
+                  min_index, max_index);
+      break;
+   case 2:
+      min_max_u16(indices, count, restart, restart_index,
+                  min_index, max_index);
+      break;
+   case 1:
+      min_max_u8(indices, count, restart, restart_index,
+                 min_index, max_index);
+      break;
+   default:
+      unreachable("not reached");
    }
-
-   *min_index = min_ui;
-   *max_index = max_ui;
 }
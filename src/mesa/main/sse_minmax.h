@@ -28,8 +28,39 @@
 #ifndef SSE_MINMAX_H
 #define SSE_MINMAX_H
 
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * SIMD versions of the index buffer min/max scan in vbo_minmax_index.c.
+ *
+ * index_size is 1, 2 or 4 and restart_index must be representable in the
+ * index type when restart is set. If every index is skipped, *min_index is
+ * greater than *max_index.
+ */
 void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count);
+_mesa_index_array_min_max_sse41(const void *indices, unsigned index_size,
+                                unsigned count, bool restart,
+                                unsigned restart_index,
+                                unsigned *min_index, unsigned *max_index);
+
+void
+_mesa_index_array_min_max_avx2(const void *indices, unsigned index_size,
+                               unsigned count, bool restart,
+                               unsigned restart_index,
+                               unsigned *min_index, unsigned *max_index);
+
+void
+_mesa_index_array_min_max_neon(const void *indices, unsigned index_size,
+                               unsigned count, bool restart,
+                               unsigned restart_index,
+                               unsigned *min_index, unsigned *max_index);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* SSE_MINMAX_H */
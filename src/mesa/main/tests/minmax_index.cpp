@@ -0,0 +1,263 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * \name minmax_index.cpp
+ *
+ * Check the SIMD index buffer min/max scan used by vbo, and each SIMD kernel
+ * the CPU supports on its own, against a scalar reference, and time it.  The timing test is disabled by default, run it
+ * with --gtest_also_run_disabled_tests --gtest_filter='*Bench*'.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "main/sse_minmax.h"
+#include "util/detect_arch.h"
+#include "util/os_time.h"
+#include "util/u_cpu_detect.h"
+#include "vbo/vbo.h"
+
+typedef void (*minmax_kernel_func)(const void *indices, unsigned index_size,
+                                   unsigned count, bool restart,
+                                   unsigned restart_index,
+                                   unsigned *min_index, unsigned *max_index);
+
+struct minmax_kernel {
+   const char *name;
+   minmax_kernel_func func;
+};
+
+/* vbo only ever picks the widest kernel, so test the others directly. */
+static std::vector<minmax_kernel>
+supported_kernels()
+{
+   std::vector<minmax_kernel> kernels;
+
+#if defined(USE_SSE41)
+   if (util_get_cpu_caps()->has_sse4_1)
+      kernels.push_back({ "sse41", _mesa_index_array_min_max_sse41 });
+#endif
+#if defined(USE_AVX2)
+   if (util_get_cpu_caps()->has_avx2)
+      kernels.push_back({ "avx2", _mesa_index_array_min_max_avx2 });
+#endif
+#if DETECT_ARCH_AARCH64
+   kernels.push_back({ "neon", _mesa_index_array_min_max_neon });
+#endif
+
+   return kernels;
+}
+
+static void
+reference_min_max(const void *indices, unsigned index_size, unsigned count,
+                  bool restart, unsigned restart_index,
+                  unsigned *min_index, unsigned *max_index)
+{
+   unsigned min_val = ~0U, max_val = 0;
+
+   for (unsigned i = 0; i < count; i++) {
+      unsigned v;
+
+      switch (index_size) {
+      case 1: v = ((const uint8_t *)indices)[i]; break;
+      case 2: v = ((const uint16_t *)indices)[i]; break;
+      default: v = ((const uint32_t *)indices)[i]; break;
+      }
+
+      if (restart && v == restart_index)
+         continue;
+      min_val = MIN2(min_val, v);
+      max_val = MAX2(max_val, v);
+   }
+
+   *min_index = min_val;
+   *max_index = max_val;
+}
+
+class MinMaxIndexTest : public ::testing::TestWithParam<unsigned> {
+protected:
+   /* Deterministic so failures are reproducible. */
+   uint32_t rand_state = 0x12345678;
+
+   uint32_t next_rand()
+   {
+      rand_state = rand_state * 1103515245 + 12345;
+      return rand_state >> 8;
+   }
+
+   /* Fills buf with random indices, about one in restart_one_in of which
+    * is restart_index.
+    */
+   void fill(std::vector<uint8_t> &buf, unsigned index_size,
+             unsigned restart_index, unsigned restart_one_in)
+   {
+      const unsigned count = buf.size() / index_size;
+
+      for (unsigned i = 0; i < count; i++) {
+         uint32_t v = next_rand() % restart_one_in == 0 ?
+                      restart_index : next_rand() ^ (next_rand() << 16);
+
+         switch (index_size) {
+         case 1: buf[i] = v; break;
+         case 2: ((uint16_t *)buf.data())[i] = v; break;
+         default: ((uint32_t *)buf.data())[i] = v; break;
+         }
+      }
+   }
+
+   /* The largest index of the index type, which is what GL uses with
+    * GL_PRIMITIVE_RESTART_FIXED_INDEX.
+    */
+   unsigned fixed_restart_index()
+   {
+      return (unsigned)(~0ULL >> (64 - GetParam() * 8));
+   }
+
+   /* Both ends of the range and two in the middle, on either side of the
+    * sign bit.
+    */
+   std::vector<unsigned> restart_indices()
+   {
+      const unsigned max = fixed_restart_index();
+      return { max, 0, max >> 1, (max >> 1) + 1 };
+   }
+};
+
+TEST_P(MinMaxIndexTest, MatchesReference)
+{
+   const unsigned index_size = GetParam();
+   std::vector<uint8_t> buf(4096 + 16);
+
+   for (unsigned restart_index : restart_indices()) {
+      SCOPED_TRACE(testing::Message() << "restart_index " << restart_index);
+
+      for (unsigned iter = 0; iter < 2000; iter++) {
+         fill(buf, index_size, restart_index, 1 + iter % 8);
+
+         /* Vary alignment and length so both the vector body and the
+          * scalar tail are exercised.
+          */
+         const unsigned offset = (iter % 4) * index_size;
+         const unsigned count = next_rand() % (4096 / index_size);
+         const bool restart = iter & 1;
+         const void *indices = &buf[offset];
+         unsigned ref_min, ref_max, min, max;
+
+         reference_min_max(indices, index_size, count, restart,
+                           restart_index, &ref_min, &ref_max);
+         vbo_get_minmax_index_mapped(count, index_size, restart_index,
+                                     restart, indices, &min, &max);
+
+         ASSERT_EQ(ref_min, min) << "count " << count << " restart " << restart;
+         ASSERT_EQ(ref_max, max) << "count " << count << " restart " << restart;
+      }
+   }
+}
+
+TEST_P(MinMaxIndexTest, KernelsMatchReference)
+{
+   const unsigned index_size = GetParam();
+   const std::vector<minmax_kernel> kernels = supported_kernels();
+   std::vector<uint8_t> buf(4096 + 16);
+
+   if (kernels.empty())
+      GTEST_SKIP() << "no SIMD min/max kernel for this CPU";
+
+   for (const minmax_kernel &kernel : kernels) {
+      SCOPED_TRACE(kernel.name);
+
+      for (unsigned restart_index : restart_indices()) {
+         SCOPED_TRACE(testing::Message() << "restart_index " << restart_index);
+
+         for (unsigned iter = 0; iter < 2000; iter++) {
+            fill(buf, index_size, restart_index, 1 + iter % 8);
+
+            /* Also call the kernels on the short runs, down to no index
+             * at all, that vbo leaves to its scalar loop.
+             */
+            const unsigned offset = (iter % 4) * index_size;
+            const unsigned count =
+               (next_rand() % (4096 / index_size)) >> (iter % 3 * 4);
+            const bool restart = iter & 1;
+            const void *indices = &buf[offset];
+            unsigned ref_min, ref_max, min, max;
+
+            reference_min_max(indices, index_size, count, restart,
+                              restart_index, &ref_min, &ref_max);
+            kernel.func(indices, index_size, count, restart, restart_index,
+                        &min, &max);
+
+            /* Only the order is specified when every index is skipped. */
+            if (ref_min > ref_max) {
+               ASSERT_GT(min, max) << "count " << count;
+               continue;
+            }
+
+            ASSERT_EQ(ref_min, min) << "count " << count
+                                    << " restart " << restart;
+            ASSERT_EQ(ref_max, max) << "count " << count
+                                    << " restart " << restart;
+         }
+      }
+   }
+}
+
+TEST_P(MinMaxIndexTest, AllRestart)
+{
+   const unsigned index_size = GetParam();
+   std::vector<uint8_t> buf(1024 * index_size);
+
+   for (unsigned restart_index : restart_indices()) {
+      SCOPED_TRACE(testing::Message() << "restart_index " << restart_index);
+      unsigned min, max;
+
+      fill(buf, index_size, restart_index, 1);
+      vbo_get_minmax_index_mapped(1024, index_size, restart_index, true,
+                                  buf.data(), &min, &max);
+
+      EXPECT_EQ(~0U, min);
+      EXPECT_EQ(0U, max);
+   }
+}
+
+TEST_P(MinMaxIndexTest, DISABLED_Bench)
+{
+   const unsigned index_size = GetParam();
+   const unsigned count = (1 << 20) / index_size;
+   const unsigned runs = 200;
+   std::vector<uint8_t> buf(count * index_size);
+   unsigned min, max;
+
+   fill(buf, index_size, fixed_restart_index(), 64);
+
+   for (unsigned restart = 0; restart < 2; restart++) {
+      int64_t start = os_time_get_nano();
+      for (unsigned i = 0; i < runs; i++) {
+         reference_min_max(buf.data(), index_size, count, restart,
+                           fixed_restart_index(), &min, &max);
+      }
+      int64_t scalar_ns = os_time_get_nano() - start;
+
+      start = os_time_get_nano();
+      for (unsigned i = 0; i < runs; i++) {
+         vbo_get_minmax_index_mapped(count, index_size,
+                                     fixed_restart_index(), restart,
+                                     buf.data(), &min, &max);
+      }
+      int64_t simd_ns = os_time_get_nano() - start;
+
+      printf("index_size %u restart %u: scalar %.2f GB/s, vbo %.2f GB/s\n",
+             index_size, restart,
+             (double)runs * count * index_size / scalar_ns,
+             (double)runs * count * index_size / simd_ns);
+   }
+}
+
+INSTANTIATE_TEST_SUITE_P(IndexSize, MinMaxIndexTest,
+                         ::testing::Values(1u, 2u, 4u));
@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * \name texcompress_unpack.cpp
+ *
+ * Check that the banded multi-threaded compressed image decoding used by
+ * the compressed format fallback matches decoding on one thread, and time
+ * both.  The timing test is disabled by default, run it with
+ * --gtest_also_run_disabled_tests --gtest_filter='*Bench*'.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "main/formats.h"
+#include "main/mtypes.h"
+#include "main/texcompress.h"
+#include "util/os_time.h"
+#include "util/u_queue.h"
+
+class TexCompressUnpackTest : public ::testing::TestWithParam<mesa_format> {
+protected:
+   struct gl_context *ctx;
+
+   void SetUp() override
+   {
+      /* Only the texstore queue is used from the context. */
+      ctx = (struct gl_context *)calloc(1, sizeof(*ctx));
+   }
+
+   void TearDown() override
+   {
+      if (util_queue_is_initialized(&ctx->texstore_queue))
+         util_queue_destroy(&ctx->texstore_queue);
+      free(ctx);
+   }
+
+   /* Random blocks, deterministic so failures are reproducible. */
+   static std::vector<uint8_t> random_image(mesa_format format,
+                                            unsigned width, unsigned height,
+                                            unsigned *stride)
+   {
+      unsigned bw, bh;
+      _mesa_get_format_block_size(format, &bw, &bh);
+      *stride = DIV_ROUND_UP(width, bw) * _mesa_get_format_bytes(format);
+
+      std::vector<uint8_t> data(*stride * DIV_ROUND_UP(height, bh));
+      uint32_t state = 0x12345678;
+      for (auto &b : data) {
+         state = state * 1103515245 + 12345;
+         b = state >> 16;
+      }
+      return data;
+   }
+};
+
+TEST_P(TexCompressUnpackTest, ThreadedMatchesSingleThreaded)
+{
+   const mesa_format format = GetParam();
+   /* Odd height so the last band has a partial row of blocks. */
+   const unsigned width = 512, height = 509;
+   unsigned src_stride;
+   std::vector<uint8_t> src = random_image(format, width, height, &src_stride);
+   std::vector<uint8_t> single(width * height * 4), threaded(width * height * 4);
+
+   _mesa_unpack_compressed_image(NULL, single.data(), width * 4,
+                                 src.data(), src_stride, width, height,
+                                 format, false);
+   _mesa_unpack_compressed_image(ctx, threaded.data(), width * 4,
+                                 src.data(), src_stride, width, height,
+                                 format, false);
+
+   EXPECT_TRUE(single == threaded) << _mesa_get_format_name(format);
+}
+
+TEST_P(TexCompressUnpackTest, DISABLED_Bench)
+{
+   const mesa_format format = GetParam();
+   const unsigned width = 2048, height = 2048, runs = 4;
+   unsigned src_stride;
+   std::vector<uint8_t> src = random_image(format, width, height, &src_stride);
+   std::vector<uint8_t> dst(width * height * 4);
+
+   for (unsigned threaded = 0; threaded < 2; threaded++) {
+      int64_t start = os_time_get_nano();
+      for (unsigned i = 0; i < runs; i++) {
+         _mesa_unpack_compressed_image(threaded ? ctx : NULL,
+                                       dst.data(), width * 4,
+                                       src.data(), src_stride, width, height,
+                                       format, false);
+      }
+      int64_t ns = os_time_get_nano() - start;
+
+      printf("%s %s: %.1f Mpixels/s\n", _mesa_get_format_name(format),
+             threaded ? "threaded" : "single", 1000.0 * width * height * runs / ns);
+   }
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, TexCompressUnpackTest,
+                         ::testing::Values(MESA_FORMAT_RGBA_DXT1,
+                                           MESA_FORMAT_RGBA_DXT5,
+                                           MESA_FORMAT_BPTC_RGBA_UNORM,
+                                           MESA_FORMAT_ETC2_RGBA8_EAC,
+                                           MESA_FORMAT_RGBA_ASTC_4x4));
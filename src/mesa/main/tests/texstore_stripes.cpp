@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * \name texstore_stripes.cpp
+ *
+ * Check that converting large texture uploads in stripes on the texstore
+ * queue gives the same texels as converting them on one thread, with the
+ * unpack skips and image height walking the source the way
+ * store_texsubimage() does.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "main/formats.h"
+#include "main/mtypes.h"
+#include "main/texstore.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
+
+struct texstore_stripes_case {
+   const char *name;
+   GLenum target;
+   GLint width, height, depth;
+   GLenum format, type;
+   unsigned bytes_per_pixel;
+   GLenum baseInternalFormat;
+   mesa_format dstFormat;
+   GLint skip_pixels, skip_rows, skip_images, image_height, row_length;
+};
+
+/* Every slice is over 1 MiB in the destination format, so it is striped. */
+static const texstore_stripes_case cases[] = {
+   { "2d", GL_TEXTURE_2D, 523, 517, 1,
+     GL_BGRA, GL_UNSIGNED_BYTE, 4, GL_RGBA, MESA_FORMAT_R8G8B8A8_UNORM,
+     3, 7, 2, 0, 531 },
+   { "2d_array", GL_TEXTURE_2D_ARRAY, 517, 521, 3,
+     GL_RGB, GL_FLOAT, 12, GL_RGB, MESA_FORMAT_R8G8B8X8_UNORM,
+     0, 5, 1, 0, 0 },
+   { "2d_array_image_height", GL_TEXTURE_2D_ARRAY, 520, 515, 2,
+     GL_RGBA, GL_UNSIGNED_SHORT, 8, GL_RGBA, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, 3, 2, 530, 0 },
+   { "3d", GL_TEXTURE_3D, 513, 529, 3,
+     GL_RGBA, GL_UNSIGNED_BYTE, 4, GL_RGBA, MESA_FORMAT_B8G8R8A8_UNORM,
+     5, 4, 2, 541, 521 },
+};
+
+static void
+PrintTo(const texstore_stripes_case &c, std::ostream *os)
+{
+   *os << c.name;
+}
+
+class TexstoreStripesTest
+   : public ::testing::TestWithParam<texstore_stripes_case> {
+protected:
+   struct gl_context *ctx;
+
+   void SetUp() override
+   {
+      /* Only the texstore queue and the pixel transfer state are used
+       * from the context, and no transfer ops are enabled.
+       */
+      ctx = (struct gl_context *)calloc(1, sizeof(*ctx));
+   }
+
+   void TearDown() override
+   {
+      if (util_queue_is_initialized(&ctx->texstore_queue))
+         util_queue_destroy(&ctx->texstore_queue);
+      free(ctx);
+   }
+
+   /* Store every slice like store_texsubimage() does, striped or not. */
+   bool store(const texstore_stripes_case &c,
+              const struct gl_pixelstore_attrib *packing,
+              const uint8_t *src, intptr_t src_image_stride,
+              uint8_t *dst, GLint dst_row_stride, bool striped)
+   {
+      const GLuint dims = c.target == GL_TEXTURE_2D ? 2 : 3;
+
+      for (GLint slice = 0; slice < c.depth; slice++) {
+         GLubyte *dst_map = dst + (intptr_t)slice * dst_row_stride * c.height;
+         GLboolean success;
+
+         if (striped) {
+            success = _mesa_texstore_slice(ctx, dims, c.baseInternalFormat,
+                                           c.dstFormat, dst_row_stride,
+                                           dst_map, c.width, c.height,
+                                           c.format, c.type, src, packing);
+         } else {
+            success = _mesa_texstore(ctx, dims, c.baseInternalFormat,
+                                     c.dstFormat, dst_row_stride, &dst_map,
+                                     c.width, c.height, 1,
+                                     c.format, c.type, src, packing);
+         }
+         if (!success)
+            return false;
+
+         src += src_image_stride;
+      }
+
+      return true;
+   }
+};
+
+TEST_P(TexstoreStripesTest, StripedMatchesUnstriped)
+{
+   const texstore_stripes_case &c = GetParam();
+
+   if (util_get_cpu_caps()->nr_cpus < 2)
+      GTEST_SKIP() << "texstore is only striped with several CPUs";
+
+   struct gl_pixelstore_attrib packing;
+   memset(&packing, 0, sizeof(packing));
+   packing.Alignment = 8;
+   packing.RowLength = c.row_length;
+   packing.SkipPixels = c.skip_pixels;
+   packing.SkipRows = c.skip_rows;
+   packing.SkipImages = c.skip_images;
+   packing.ImageHeight = c.image_height;
+
+   /* The source layout, computed independently of image.c, with a spare
+    * row for the skipped pixels.
+    */
+   const GLint row_pixels = c.row_length ? c.row_length : c.width;
+   const intptr_t src_row_stride =
+      ALIGN(row_pixels * c.bytes_per_pixel, packing.Alignment);
+   const intptr_t src_image_stride =
+      src_row_stride * (c.image_height ? c.image_height : c.height);
+   const size_t src_size = c.target == GL_TEXTURE_2D ?
+      src_row_stride * (c.skip_rows + c.height + 1) :
+      src_image_stride * (c.skip_images + c.depth) +
+      src_row_stride * (c.skip_rows + 1);
+
+   std::vector<uint8_t> src(src_size);
+   uint32_t state = 0x12345678;
+   if (c.type == GL_FLOAT) {
+      float *f = (float *)src.data();
+      for (size_t i = 0; i < src_size / sizeof(float); i++) {
+         state = state * 1103515245 + 12345;
+         f[i] = (state >> 8) / (float)(1 << 24);
+      }
+   } else {
+      for (auto &b : src) {
+         state = state * 1103515245 + 12345;
+         b = state >> 16;
+      }
+   }
+
+   /* Pad the destination rows so that stripes have to honor the stride. */
+   const GLint dst_row_stride =
+      _mesa_format_row_stride(c.dstFormat, c.width) + 64;
+   const size_t dst_size = (size_t)dst_row_stride * c.height * c.depth;
+   ASSERT_GE((size_t)_mesa_format_row_stride(c.dstFormat, c.width) * c.height,
+             (size_t)1 << 20);
+
+   std::vector<uint8_t> unstriped(dst_size, 0xcd), striped(dst_size, 0xcd);
+
+   /* 2D uploads are a single slice: only the array and 3D targets step
+    * over whole images, like store_texsubimage().
+    */
+   const intptr_t slice_stride =
+      c.target == GL_TEXTURE_2D ? 0 : src_image_stride;
+
+   ASSERT_TRUE(store(c, &packing, src.data(), slice_stride,
+                     unstriped.data(), dst_row_stride, false));
+   ASSERT_FALSE(util_queue_is_initialized(&ctx->texstore_queue));
+
+   ASSERT_TRUE(store(c, &packing, src.data(), slice_stride,
+                     striped.data(), dst_row_stride, true));
+   ASSERT_TRUE(util_queue_is_initialized(&ctx->texstore_queue))
+      << "the upload was not striped";
+
+   EXPECT_TRUE(unstriped == striped) << c.name;
+}
+
+INSTANTIATE_TEST_SUITE_P(
+   Uploads, TexstoreStripesTest, ::testing::ValuesIn(cases),
+   [](const ::testing::TestParamInfo<texstore_stripes_case> &info) {
+      return std::string(info.param.name);
+   });
@@ -42,6 +42,10 @@
 #include "texcompress_s3tc.h"
 #include "texcompress_etc.h"
 #include "texcompress_bptc.h"
+#include "texcompress_astc.h"
+#include "texstore.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
 
 
 /**
@@ -929,3 +933,130 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
       }
    }
 }
+
+
+/**
+ * Decode the rows of blocks of a compressed image with the bulk decoder for
+ * its format.  The destination format is the one the decoders write: RGBA8
+ * (BGRA8 for sRGB ETC2 if \p bgra), R8/RG8 for RGTC/LATC and RGBA16F for
+ * BPTC float.
+ */
+static void
+unpack_compressed_rows(uint8_t *dst, unsigned dst_stride,
+                       const uint8_t *src, unsigned src_stride,
+                       unsigned width, unsigned height,
+                       mesa_format format, bool bgra)
+{
+   if (format == MESA_FORMAT_ETC1_RGB8) {
+      _mesa_etc1_unpack_rgba8888(dst, dst_stride, src, src_stride,
+                                 width, height);
+   } else if (_mesa_is_format_etc2(format)) {
+      _mesa_unpack_etc2_format(dst, dst_stride, src, src_stride,
+                               width, height, format, bgra);
+   } else if (_mesa_is_format_astc_2d(format)) {
+      _mesa_unpack_astc_2d_ldr(dst, dst_stride, src, src_stride,
+                               width, height, format);
+   } else if (_mesa_is_format_s3tc(format)) {
+      _mesa_unpack_s3tc(dst, dst_stride, src, src_stride,
+                        width, height, format);
+   } else if (_mesa_is_format_rgtc(format) || _mesa_is_format_latc(format)) {
+      _mesa_unpack_rgtc(dst, dst_stride, src, src_stride,
+                        width, height, format);
+   } else if (_mesa_is_format_bptc(format)) {
+      _mesa_unpack_bptc(dst, dst_stride, src, src_stride,
+                        width, height, format);
+   } else {
+      unreachable("unexpected format for compressed image unpacking");
+   }
+}
+
+/** Fewest rows of blocks worth decoding on another thread. */
+#define UNPACK_MIN_BLOCK_ROWS 16
+
+/** A range of block rows decoded on its own. */
+struct unpack_band {
+   struct util_queue_fence fence;
+   uint8_t *dst;
+   unsigned dst_stride;
+   const uint8_t *src;
+   unsigned src_stride;
+   unsigned width, height;
+   mesa_format format;
+   bool bgra;
+};
+
+static void
+unpack_band_execute(void *data, UNUSED void *gdata, UNUSED int thread_index)
+{
+   struct unpack_band *band = (struct unpack_band *)data;
+
+   unpack_compressed_rows(band->dst, band->dst_stride,
+                          band->src, band->src_stride,
+                          band->width, band->height,
+                          band->format, band->bgra);
+}
+
+/**
+ * Decompress a whole image for the compressed format fallback.
+ *
+ * Blocks are independent, so large images are split into bands of block
+ * rows decoded in parallel on the texstore queue, with the calling thread
+ * decoding the first band.  \p ctx may be NULL to decode on the calling
+ * thread only.
+ *
+ * \param src_stride  stride in bytes between rows of blocks
+ */
+void
+_mesa_unpack_compressed_image(struct gl_context *ctx,
+                              uint8_t *dst, unsigned dst_stride,
+                              const uint8_t *src, unsigned src_stride,
+                              unsigned width, unsigned height,
+                              mesa_format format, bool bgra)
+{
+   unsigned bw, bh;
+   _mesa_get_format_block_size(format, &bw, &bh);
+
+   const unsigned block_rows = DIV_ROUND_UP(height, bh);
+   unsigned num_bands = MIN3(block_rows / UNPACK_MIN_BLOCK_ROWS,
+                             util_get_cpu_caps()->nr_cpus,
+                             TEXSTORE_MAX_STRIPES);
+   struct util_queue *queue =
+      ctx && num_bands > 1 ? _mesa_get_texstore_queue(ctx) : NULL;
+
+   if (!queue) {
+      unpack_compressed_rows(dst, dst_stride, src, src_stride,
+                             width, height, format, bgra);
+      return;
+   }
+
+   struct unpack_band bands[TEXSTORE_MAX_STRIPES];
+   const unsigned rows_per_band = DIV_ROUND_UP(block_rows, num_bands);
+   unsigned count = 0;
+
+   for (unsigned row = 0; row < block_rows; row += rows_per_band) {
+      struct unpack_band *band = &bands[count++];
+      const unsigned y = row * bh;
+
+      band->dst = dst + (size_t)y * dst_stride;
+      band->dst_stride = dst_stride;
+      band->src = src + (size_t)row * src_stride;
+      band->src_stride = src_stride;
+      band->width = width;
+      band->height = MIN2(rows_per_band * bh, height - y);
+      band->format = format;
+      band->bgra = bgra;
+   }
+
+   for (unsigned i = 1; i < count; i++) {
+      util_queue_fence_init(&bands[i].fence);
+      util_queue_add_job(queue, &bands[i], &bands[i].fence,
+                         unpack_band_execute, NULL, 0);
+   }
+
+   unpack_band_execute(&bands[0], NULL, 0);
+
+   for (unsigned i = 1; i < count; i++) {
+      util_queue_fence_wait(&bands[i].fence);
+      util_queue_fence_destroy(&bands[i].fence);
+   }
+}
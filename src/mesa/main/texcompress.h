@@ -28,6 +28,10 @@
 #include "formats.h"
 #include "util/glheader.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct gl_context;
 
 extern GLenum
@@ -63,4 +67,15 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest);
 
+extern void
+_mesa_unpack_compressed_image(struct gl_context *ctx,
+                              uint8_t *dst, unsigned dst_stride,
+                              const uint8_t *src, unsigned src_stride,
+                              unsigned width, unsigned height,
+                              mesa_format format, bool bgra);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* TEXCOMPRESS_H */
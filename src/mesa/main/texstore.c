@@ -75,6 +75,8 @@
 #include "pixeltransfer.h"
 #include "util/format_rgb9e5.h"
 #include "util/format_r11g11b10f.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_queue.h"
 
 #include "state_tracker/st_cb_texture.h"
 
@@ -968,6 +970,176 @@ get_read_write_mode(GLenum userFormat, mesa_format texFormat)
 }
 
 
+/**
+ * Return ctx->texstore_queue, creating it on first use, or NULL if there is
+ * only one CPU or the queue can't be created.  Callers split their work in
+ * at most TEXSTORE_MAX_STRIPES pieces and do one of them themselves.
+ */
+struct util_queue *
+_mesa_get_texstore_queue(struct gl_context *ctx)
+{
+   const unsigned nr_cpus = util_get_cpu_caps()->nr_cpus;
+
+   if (nr_cpus < 2)
+      return NULL;
+
+   if (!util_queue_is_initialized(&ctx->texstore_queue) &&
+       !util_queue_init(&ctx->texstore_queue, "texstore",
+                        TEXSTORE_MAX_STRIPES,
+                        MIN2(nr_cpus, TEXSTORE_MAX_STRIPES) - 1,
+                        UTIL_QUEUE_INIT_RESIZE_IF_FULL, NULL))
+      return NULL;
+
+   return &ctx->texstore_queue;
+}
+
+/** Images smaller than this are always converted on the calling thread. */
+#define TEXSTORE_THREAD_MIN_BYTES   (1 << 20)
+/** Smallest amount of destination data worth handing to another thread. */
+#define TEXSTORE_STRIPE_MIN_BYTES   (256 << 10)
+
+/**
+ * A horizontal band of one destination slice, converted by _mesa_texstore()
+ * on its own.
+ */
+struct texstore_stripe {
+   struct util_queue_fence fence;
+   struct gl_context *ctx;
+   GLuint dims;
+   GLenum baseInternalFormat;
+   mesa_format dstFormat;
+   GLint dstRowStride;
+   GLubyte *dstMap;
+   GLint width, height;
+   GLenum format, type;
+   const GLvoid *pixels;
+   /** The caller's packing with SkipRows pointing at the stripe. */
+   struct gl_pixelstore_attrib packing;
+   GLboolean success;
+};
+
+static void
+texstore_stripe_execute(void *data, UNUSED void *gdata,
+                        UNUSED int thread_index)
+{
+   struct texstore_stripe *stripe = (struct texstore_stripe *)data;
+
+   stripe->success = _mesa_texstore(stripe->ctx, stripe->dims,
+                                    stripe->baseInternalFormat,
+                                    stripe->dstFormat,
+                                    stripe->dstRowStride,
+                                    &stripe->dstMap,
+                                    stripe->width, stripe->height, 1,
+                                    stripe->format, stripe->type,
+                                    stripe->pixels, &stripe->packing);
+}
+
+/**
+ * How many stripes to split the conversion of a width x height slice into.
+ *
+ * Only plain color conversions are split: they read nothing but constant
+ * context state, so the calling thread can wait for the workers without
+ * anything else changing underneath them.  Pixel transfer ops, color
+ * index lookups, depth/stencil and compressed destinations stay on the
+ * calling thread.
+ */
+static unsigned
+texstore_num_stripes(struct gl_context *ctx, GLenum baseInternalFormat,
+                     mesa_format dstFormat, GLenum srcFormat,
+                     GLint width, GLint height)
+{
+   const unsigned nr_cpus = util_get_cpu_caps()->nr_cpus;
+
+   if (nr_cpus < 2 || height < 2)
+      return 1;
+
+   if (_mesa_is_depth_or_stencil_format(baseInternalFormat) ||
+       _mesa_is_format_compressed(dstFormat) ||
+       srcFormat == GL_COLOR_INDEX ||
+       _mesa_texstore_needs_transfer_ops(ctx, baseInternalFormat, dstFormat))
+      return 1;
+
+   const uint64_t bytes =
+      (uint64_t)_mesa_format_row_stride(dstFormat, width) * height;
+   if (bytes < TEXSTORE_THREAD_MIN_BYTES)
+      return 1;
+
+   if (!_mesa_get_texstore_queue(ctx))
+      return 1;
+
+   unsigned num_stripes = MIN3(bytes / TEXSTORE_STRIPE_MIN_BYTES, nr_cpus,
+                               TEXSTORE_MAX_STRIPES);
+   return MIN2(num_stripes, (unsigned)height);
+}
+
+/**
+ * _mesa_texstore() of a single mapped slice, split into stripes converted
+ * in parallel on ctx->texstore_queue when the slice is large enough.
+ */
+GLboolean
+_mesa_texstore_slice(struct gl_context *ctx, GLuint dims,
+                     GLenum baseInternalFormat, mesa_format dstFormat,
+                     GLint dstRowStride, GLubyte *dstMap,
+                     GLint width, GLint height,
+                     GLenum format, GLenum type, const GLvoid *pixels,
+                     const struct gl_pixelstore_attrib *packing)
+{
+   const unsigned num_stripes =
+      texstore_num_stripes(ctx, baseInternalFormat, dstFormat,
+                           format, width, height);
+
+   if (num_stripes <= 1) {
+      return _mesa_texstore(ctx, dims, baseInternalFormat, dstFormat,
+                            dstRowStride, &dstMap,
+                            width, height, 1,
+                            format, type, pixels, packing);
+   }
+
+   struct texstore_stripe stripes[TEXSTORE_MAX_STRIPES];
+   const GLint rows_per_stripe = DIV_ROUND_UP(height, num_stripes);
+   unsigned count = 0;
+
+   for (GLint y = 0; y < height; y += rows_per_stripe) {
+      struct texstore_stripe *stripe = &stripes[count++];
+
+      stripe->ctx = ctx;
+      stripe->dims = dims;
+      stripe->baseInternalFormat = baseInternalFormat;
+      stripe->dstFormat = dstFormat;
+      stripe->dstRowStride = dstRowStride;
+      stripe->dstMap = dstMap + (intptr_t)y * dstRowStride;
+      stripe->width = width;
+      stripe->height = MIN2(rows_per_stripe, height - y);
+      stripe->format = format;
+      stripe->type = type;
+      stripe->pixels = pixels;
+      stripe->packing = *packing;
+      stripe->packing.SkipRows += y;
+      /* SKIP_IMAGES must still step over images of the full height. */
+      if (!stripe->packing.ImageHeight)
+         stripe->packing.ImageHeight = height;
+      stripe->success = GL_FALSE;
+   }
+
+   for (unsigned i = 1; i < count; i++) {
+      util_queue_fence_init(&stripes[i].fence);
+      util_queue_add_job(&ctx->texstore_queue, &stripes[i], &stripes[i].fence,
+                         texstore_stripe_execute, NULL, 0);
+   }
+
+   texstore_stripe_execute(&stripes[0], NULL, 0);
+
+   GLboolean success = stripes[0].success;
+   for (unsigned i = 1; i < count; i++) {
+      util_queue_fence_wait(&stripes[i].fence);
+      util_queue_fence_destroy(&stripes[i].fence);
+      success = success && stripes[i].success;
+   }
+
+   return success;
+}
+
+
 /**
  * Helper function for storing 1D, 2D, 3D whole and subimages into texture
  * memory.
@@ -1082,12 +1254,11 @@ store_texsubimage(struct gl_context *ctx,
           * to pass the right 'dims' value so that GL_UNPACK_SKIP_IMAGES is
           * used for 3D images.
           */
-         success = _mesa_texstore(ctx, dims, texImage->_BaseFormat,
-                                  texImage->TexFormat,
-                                  dstRowStride,
-                                  &dstMap,
-                                  width, height, 1,  /* w, h, d */
-                                  format, type, src, packing);
+         success = _mesa_texstore_slice(ctx, dims, texImage->_BaseFormat,
+                                        texImage->TexFormat,
+                                        dstRowStride, dstMap,
+                                        width, height,
+                                        format, type, src, packing);
 
          st_UnmapTextureImage(ctx, texImage, slice + sliceOffset);
       }
@@ -40,6 +40,10 @@
 #include "formats.h"
 #include "util/macros.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct gl_context;
 struct gl_pixelstore_attrib;
 struct gl_texture_image;
@@ -87,6 +91,20 @@ struct gl_texture_image;
 extern GLboolean
 _mesa_texstore(TEXSTORE_PARAMS);
 
+/** Most pieces texture conversions are split into for the texstore queue. */
+#define TEXSTORE_MAX_STRIPES 16
+
+struct util_queue *
+_mesa_get_texstore_queue(struct gl_context *ctx);
+
+extern GLboolean
+_mesa_texstore_slice(struct gl_context *ctx, GLuint dims,
+                     GLenum baseInternalFormat, mesa_format dstFormat,
+                     GLint dstRowStride, GLubyte *dstMap,
+                     GLint width, GLint height,
+                     GLenum format, GLenum type, const GLvoid *pixels,
+                     const struct gl_pixelstore_attrib *packing);
+
 extern GLboolean
 _mesa_texstore_needs_transfer_ops(struct gl_context *ctx,
                                   GLenum baseInternalFormat,
@@ -159,4 +177,8 @@ _mesa_compute_compressed_pixelstore(GLuint dims, mesa_format texFormat,
                                     struct compressed_pixelstore *store);
 
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -27,6 +27,7 @@
  */
 
 #include "util/glheader.h"
+#include "util/detect_arch.h"
 #include "util/u_cpu_detect.h"
 #include "main/context.h"
 #include "main/varray.h"
@@ -234,6 +235,41 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
                             const void *indices,
                             unsigned *min_index, unsigned *max_index)
 {
+   /* A restart index that doesn't fit in the index type never matches. */
+   if (restart && index_size < 4 && restartIndex >> (index_size * 8))
+      restart = false;
+
+   /* The SIMD loops only pay off once they get a few full vectors to chew
+    * on; short draws stay on the scalar path below.
+    */
+   if (count * index_size >= 64) {
+      void (*simd_min_max)(const void *, unsigned, unsigned, bool, unsigned,
+                           unsigned *, unsigned *) = NULL;
+
+#if defined(USE_AVX2)
+      if (util_get_cpu_caps()->has_avx2)
+         simd_min_max = _mesa_index_array_min_max_avx2;
+#endif
+#if defined(USE_SSE41)
+      if (!simd_min_max && util_get_cpu_caps()->has_sse4_1)
+         simd_min_max = _mesa_index_array_min_max_sse41;
+#endif
+#if DETECT_ARCH_AARCH64
+      simd_min_max = _mesa_index_array_min_max_neon;
+#endif
+
+      if (simd_min_max) {
+         simd_min_max(indices, index_size, count, restart, restartIndex,
+                      min_index, max_index);
+         /* Keep the scalar result for draws made only of restart indices. */
+         if (*min_index > *max_index) {
+            *min_index = ~0U;
+            *max_index = 0;
+         }
+         return;
+      }
+   }
+
    switch (index_size) {
    case 4: {
       const GLuint *ui_indices = (const GLuint *)indices;
@@ -248,16 +284,10 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
          }
       }
       else {
-#if defined(USE_SSE41)
-         if (util_get_cpu_caps()->has_sse4_1) {
-            _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count);
+         for (unsigned i = 0; i < count; i++) {
+            if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
+            if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
          }
-         else
-#endif
-            for (unsigned i = 0; i < count; i++) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
       }
       *min_index = min_ui;
       *max_index = max_ui;
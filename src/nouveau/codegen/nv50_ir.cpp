@@ -53,7 +53,8 @@ Modifier Modifier::operator*(const Modifier m) const
    return Modifier(a | c);
 }
 
-ValueRef::ValueRef(Value *v) : value(NULL), insn(NULL)
+ValueRef::ValueRef(Value *v) : value(NULL), insn(NULL),
+                                nextUse(NULL), prevUse(NULL)
 {
    indirect[0] = -1;
    indirect[1] = -1;
@@ -61,7 +62,8 @@ ValueRef::ValueRef(Value *v) : value(NULL), insn(NULL)
    set(v);
 }
 
-ValueRef::ValueRef(const ValueRef& ref) : value(NULL), insn(ref.insn)
+ValueRef::ValueRef(const ValueRef& ref) : value(NULL), insn(ref.insn),
+                                          nextUse(NULL), prevUse(NULL)
 {
    set(ref);
    usedAsPtr = ref.usedAsPtr;
@@ -26,7 +26,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <cstddef>
 #include <deque>
+#include <iterator>
 #include <list>
 #include <unordered_set>
 #include <vector>
@@ -683,6 +685,85 @@ public:
 private:
    Value *value;
    Instruction *insn;
+
+   // links in the use list of value
+   ValueRef *nextUse;
+   ValueRef *prevUse;
+
+   friend class UseList;
+};
+
+// Intrusive list of the references to a value, linked through the ValueRefs
+// themselves so that adding or removing a use never allocates.
+class UseList
+{
+public:
+   // the list only hands out the references, not modifiable slots, so a
+   // single iterator type serves both constant and mutable lists
+   class iterator
+   {
+   public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef ValueRef *value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef ValueRef **pointer;
+      typedef ValueRef *reference;
+
+      iterator(ValueRef *ref = NULL) : ref(ref) { }
+
+      inline ValueRef *operator*() const { return ref; }
+      inline iterator& operator++() { ref = ref->nextUse; return *this; }
+      inline iterator operator++(int)
+      {
+         iterator it = *this;
+         ref = ref->nextUse;
+         return it;
+      }
+      inline bool operator==(const iterator& it) const { return ref == it.ref; }
+      inline bool operator!=(const iterator& it) const { return ref != it.ref; }
+
+   private:
+      ValueRef *ref;
+   };
+
+   typedef iterator const_iterator;
+
+   UseList() : head(NULL), count(0) { }
+
+   UseList(const UseList&) = delete;
+   UseList& operator=(const UseList&) = delete;
+
+   inline iterator begin() const { return iterator(head); }
+   inline iterator end() const { return iterator(); }
+
+   inline bool empty() const { return !head; }
+   inline size_t size() const { return count; }
+
+   inline void insert(ValueRef *ref)
+   {
+      ref->prevUse = NULL;
+      ref->nextUse = head;
+      if (head)
+         head->prevUse = ref;
+      head = ref;
+      ++count;
+   }
+
+   inline void erase(ValueRef *ref)
+   {
+      if (ref->prevUse)
+         ref->prevUse->nextUse = ref->nextUse;
+      else
+         head = ref->nextUse;
+      if (ref->nextUse)
+         ref->nextUse->prevUse = ref->prevUse;
+      ref->nextUse = ref->prevUse = NULL;
+      --count;
+   }
+
+private:
+   ValueRef *head;
+   size_t count;
 };
 
 class ValueDef
@@ -751,10 +832,10 @@ public:
 
    static inline Value *get(Iterator&);
 
-   std::unordered_set<ValueRef *> uses;
+   UseList uses;
    std::list<ValueDef *> defs;
-   typedef std::unordered_set<ValueRef *>::iterator UseIterator;
-   typedef std::unordered_set<ValueRef *>::const_iterator UseCIterator;
+   typedef UseList::iterator UseIterator;
+   typedef UseList::const_iterator UseCIterator;
    typedef std::list<ValueDef *>::iterator DefIterator;
    typedef std::list<ValueDef *>::const_iterator DefCIterator;
 
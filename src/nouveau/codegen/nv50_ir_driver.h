@@ -99,6 +99,8 @@ struct nv50_ir_prog_info
                       * which does not work well with NVK */
    uint8_t dbgFlags;
    bool omitLineNum; /* only used for printing the prog when dbgFlags is set */
+   bool fastRA; /* use linear scan instead of graph colouring for register
+                 * allocation, cheaper but may spill more */
 
    struct {
       uint32_t smemSize;  /* required shared memory per block */
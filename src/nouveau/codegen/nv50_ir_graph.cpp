@@ -28,17 +28,44 @@
 
 namespace nv50_ir {
 
-Graph::Graph()
+Graph::Graph(bool pooledEdges)
 {
    root = NULL;
    size = 0;
    sequence = 0;
+   edgePool = pooledEdges ? new MemoryPool(sizeof(Edge), 8) : NULL;
 }
 
 Graph::~Graph()
 {
    for (IteratorRef it = safeIteratorDFS(); !it->end(); it->next())
       reinterpret_cast<Node *>(it->get())->cut();
+
+   delete edgePool;
+}
+
+Graph::Edge *
+Graph::createEdge(Node *org, Node *tgt, Edge::Type kind)
+{
+   if (!edgePool)
+      return new Edge(org, tgt, kind);
+
+   void *mem = edgePool->allocate();
+   assert(mem);
+   return new (mem) Edge(org, tgt, kind);
+}
+
+void
+Graph::destroyEdge(Edge *edge)
+{
+   MemoryPool *pool = edge->origin->graph->edgePool;
+
+   if (!pool) {
+      delete edge;
+      return;
+   }
+   edge->~Edge();
+   pool->release(edge);
 }
 
 void Graph::insert(Node *node)
@@ -94,7 +121,7 @@ Graph::Node::Node(void *priv) : data(priv),
 
 void Graph::Node::attach(Node *node, Edge::Type kind)
 {
-   Edge *edge = new Edge(this, node, kind);
+   Edge *edge = (graph ? graph : node->graph)->createEdge(this, node, kind);
 
    // insert head
    if (this->out) {
@@ -136,7 +163,7 @@ bool Graph::Node::detach(Graph::Node *node)
       ERROR("no such node attached\n");
       return false;
    }
-   delete ei.getEdge();
+   Graph::destroyEdge(ei.getEdge());
    return true;
 }
 
@@ -144,9 +171,9 @@ bool Graph::Node::detach(Graph::Node *node)
 void Graph::Node::cut()
 {
    while (out)
-      delete out;
+      Graph::destroyEdge(out);
    while (in)
-      delete in;
+      Graph::destroyEdge(in);
 
    if (graph) {
       if (graph->root == this)
@@ -145,9 +145,15 @@ public:
    };
 
 public:
-   Graph();
+   // With @pooledEdges, edges are allocated from a pool owned by the graph
+   // instead of the heap. All nodes must then be cut or deleted before the
+   // graph is destroyed.
+   Graph(bool pooledEdges = false);
    virtual ~Graph(); // does *not* free the nodes (make it an option ?)
 
+   Graph(const Graph&) = delete;
+   Graph& operator=(const Graph&) = delete;
+
    inline Node *getRoot() const { return root; }
 
    inline unsigned int getSize() const { return size; }
@@ -171,10 +177,15 @@ public:
 private:
    void classifyDFS(Node *, int&);
 
+   Edge *createEdge(Node *org, Node *tgt, Edge::Type kind);
+   static void destroyEdge(Edge *);
+
 private:
    Node *root;
    unsigned int size;
    int sequence;
+
+   MemoryPool *edgePool;
 };
 
 int Graph::nextSequence()
@@ -620,11 +620,13 @@ RegAlloc::BuildIntervalsPass::visit(BasicBlock *bb)
 class GCRA
 {
 public:
-   GCRA(Function *, SpillCodeInserter&, MergedDefs&);
+   GCRA(Function *, SpillCodeInserter&, MergedDefs&, bool linearScan);
    ~GCRA();
 
    bool allocateRegisters(ArrayList& insns);
 
+   inline bool isLinearScan() const { return linearScan; }
+
    void printNodeInfo() const;
 
 private:
@@ -679,12 +681,15 @@ private:
 private:
    inline RIG_Node *getNode(const LValue *v) const { return &nodes[v->id]; }
 
+   void collectValues(ArrayList&, std::list<RIG_Node *>&);
    void buildRIG(ArrayList&);
    bool coalesce(ArrayList&);
    bool doCoalesce(ArrayList&, unsigned int mask);
    void calculateSpillWeights();
    bool simplify();
    bool selectRegisters();
+   bool scanRegisters(ArrayList&);
+   void setRegisterIds();
    void cleanup(const bool success);
 
    void simplifyEdge(RIG_Node *, RIG_Node *);
@@ -696,6 +701,7 @@ private:
    void makeCompound(Instruction *, bool isSplit);
 
    inline void checkInterference(const RIG_Node *, Graph::EdgeIterator&);
+   void checkInterference(const RIG_Node *, const RIG_Node *);
 
    inline void insertOrderedTail(std::list<RIG_Node *>&, RIG_Node *);
    void checkList(std::list<RIG_Node *>&);
@@ -707,7 +713,7 @@ private:
    RIG_Node lo[2];
    RIG_Node hi;
 
-   Graph RIG;
+   Graph RIG; // edges are pooled, the nodes are deleted in cleanup()
    RIG_Node *nodes;
    unsigned int nodeCount;
 
@@ -740,6 +746,10 @@ private:
    std::list<ValuePair> mustSpill;
 
    MergedDefs &mergedDefs;
+
+   // assign registers by a linear scan over the live intervals instead of
+   // colouring the interference graph, cleared if the scan gets stuck
+   bool linearScan;
 };
 
 const GCRA::RelDegree GCRA::relDegree;
@@ -1096,13 +1106,16 @@ GCRA::RIG_Node::addRegPreference(RIG_Node *node)
    prefRegs.push_back(node);
 }
 
-GCRA::GCRA(Function *fn, SpillCodeInserter& spill, MergedDefs& mergedDefs) :
+GCRA::GCRA(Function *fn, SpillCodeInserter& spill, MergedDefs& mergedDefs,
+           bool linearScan) :
+   RIG(true),
    nodes(NULL),
    nodeCount(0),
    func(fn),
    regs(fn->getProgram()->getTarget()),
    spill(spill),
-   mergedDefs(mergedDefs)
+   mergedDefs(mergedDefs),
+   linearScan(linearScan)
 {
    prog = func->getProgram();
 }
@@ -1144,11 +1157,10 @@ GCRA::insertOrderedTail(std::list<RIG_Node *>& list, RIG_Node *node)
    list.insert(it, node);
 }
 
+// collect the representative values, sorted by the start of their live range
 void
-GCRA::buildRIG(ArrayList& insns)
+GCRA::collectValues(ArrayList& insns, std::list<RIG_Node *>& values)
 {
-   std::list<RIG_Node *> values, active;
-
    for (std::deque<ValueDef>::iterator it = func->ins.begin();
         it != func->ins.end(); ++it)
       insertOrderedTail(values, getNode(it->get()->asLValue()));
@@ -1161,6 +1173,14 @@ GCRA::buildRIG(ArrayList& insns)
             insertOrderedTail(values, getNode(insn->getDef(d)->asLValue()));
    }
    checkList(values);
+}
+
+void
+GCRA::buildRIG(ArrayList& insns)
+{
+   std::list<RIG_Node *> values, active;
+
+   collectValues(insns, values);
 
    while (!values.empty()) {
       RIG_Node *cur = values.front();
@@ -1296,8 +1316,12 @@ GCRA::simplify()
 void
 GCRA::checkInterference(const RIG_Node *node, Graph::EdgeIterator& ei)
 {
-   const RIG_Node *intf = RIG_Node::get(ei);
+   checkInterference(node, RIG_Node::get(ei));
+}
 
+void
+GCRA::checkInterference(const RIG_Node *node, const RIG_Node *intf)
+{
    if (intf->reg < 0)
       return;
    LValue *vA = node->getValue();
@@ -1395,12 +1419,114 @@ GCRA::selectRegisters()
    }
    if (!mustSpill.empty())
       return false;
+   setRegisterIds();
+   return true;
+}
+
+void
+GCRA::setRegisterIds()
+{
    for (unsigned int i = 0; i < nodeCount; ++i) {
       LValue *lval = nodes[i].getValue();
       if (nodes[i].reg >= 0 && nodes[i].colors > 0)
          lval->reg.data.id =
             regs.unitsToId(nodes[i].f, nodes[i].reg, lval->reg.size);
    }
+}
+
+// Assign registers in order of the start of the live intervals, only looking
+// at the values live at that point instead of building the interference
+// graph. This is a lot cheaper than colouring for big shaders, but makes
+// worse spilling decisions.
+bool
+GCRA::scanRegisters(ArrayList& insns)
+{
+   std::list<RIG_Node *> values, active, fixed;
+
+   INFO_DBG(prog->dbgFlags, REG_ALLOC, "\nLINEAR SCAN phase\n");
+
+   collectValues(insns, values);
+
+   // pre-coloured values may start after the ones that would clobber them
+   for (RIG_Node *node : values)
+      if (node->reg >= 0)
+         fixed.push_back(node);
+
+   for (RIG_Node *cur : values) {
+      for (std::list<RIG_Node *>::iterator it = active.begin();
+           it != active.end();) {
+         if ((*it)->livei.end() <= cur->livei.begin())
+            it = active.erase(it);
+         else
+            ++it;
+      }
+      active.push_back(cur);
+
+      if (cur->reg >= 0)
+         continue;
+
+      regs.reset(cur->f);
+
+      for (const RIG_Node *node : active)
+         if (node != cur && node->f == cur->f &&
+             node->livei.overlaps(cur->livei))
+            checkInterference(cur, node);
+      for (const RIG_Node *node : fixed)
+         if (node->f == cur->f && node->livei.overlaps(cur->livei))
+            checkInterference(cur, node);
+
+      for (const RIG_Node *pref : cur->prefRegs) {
+         if (pref->reg >= 0 &&
+             regs.testOccupy(cur->f, pref->reg, cur->colors)) {
+            cur->reg = pref->reg;
+            break;
+         }
+      }
+      if (cur->reg >= 0)
+         continue;
+
+      if (regs.assign(cur->reg, cur->f, cur->colors, cur->maxReg)) {
+         INFO_DBG(prog->dbgFlags, REG_ALLOC, "%%%i: assigned reg %i\n",
+                  cur->getValue()->id, cur->reg);
+         cur->getValue()->compMask = cur->getCompMask();
+         continue;
+      }
+
+      // Spill the current value, or if it can't be spilled, the cheapest
+      // interfering one. Either way another round is needed.
+      RIG_Node *victim = isinf(cur->weight) ? NULL : cur;
+      if (!victim) {
+         for (RIG_Node *node : active) {
+            if (node == cur || node->reg < 0 || isinf(node->weight) ||
+                node->f != cur->f || !node->livei.overlaps(cur->livei))
+               continue;
+            if (!victim || node->weight < victim->weight)
+               victim = node;
+         }
+      }
+      if (!victim) {
+         INFO_DBG(prog->dbgFlags, REG_ALLOC,
+                  "linear scan stuck on %%%i, falling back to colouring\n",
+                  cur->getValue()->id);
+         mustSpill.clear();
+         linearScan = false;
+         return false;
+      }
+
+      LValue *lval = victim->getValue();
+      INFO_DBG(prog->dbgFlags, REG_ALLOC, "must spill: %%%i (size %u)\n",
+               lval->id, lval->reg.size);
+      Symbol *slot = NULL;
+      if (lval->reg.file == FILE_GPR)
+         slot = spill.assignSlot(victim->livei, lval->reg.size);
+      mustSpill.push_back(ValuePair(lval, slot));
+      // don't pick it again
+      victim->weight = std::numeric_limits<float>::infinity();
+   }
+
+   if (!mustSpill.empty())
+      return false;
+   setRegisterIds();
    return true;
 }
 
@@ -1464,13 +1590,21 @@ GCRA::allocateRegisters(ArrayList& insns)
    if (func->getProgram()->dbgFlags & NV50_IR_DEBUG_REG_ALLOC)
       func->printLiveIntervals();
 
-   buildRIG(insns);
-   calculateSpillWeights();
-   ret = simplify();
-   if (!ret)
-      goto out;
+   if (linearScan) {
+      calculateSpillWeights();
+      ret = scanRegisters(insns);
+      // nothing to spill, retry with graph colouring
+      if (!ret && !linearScan)
+         goto out;
+   } else {
+      buildRIG(insns);
+      calculateSpillWeights();
+      ret = simplify();
+      if (!ret)
+         goto out;
 
-   ret = selectRegisters();
+      ret = selectRegisters();
+   }
    if (!ret) {
       INFO_DBG(prog->dbgFlags, REG_ALLOC,
                "selectRegisters failed, inserting spill code ...\n");
@@ -1750,7 +1884,7 @@ RegAlloc::execFunc()
    BuildIntervalsPass buildIntervals;
    SpillCodeInserter insertSpills(func, mergedDefs);
 
-   GCRA gcra(func, insertSpills, mergedDefs);
+   GCRA gcra(func, insertSpills, mergedDefs, prog->driver->fastRA);
 
    unsigned int i, retries;
    bool ret;
@@ -1794,9 +1928,13 @@ RegAlloc::execFunc()
       ret = buildIntervals.run(func);
       if (!ret)
          break;
+      const bool linearScan = gcra.isLinearScan();
       ret = gcra.allocateRegisters(insns);
       if (ret)
          break; // success
+      // giving up on the linear scan doesn't insert any spill code
+      if (linearScan && !gcra.isLinearScan())
+         --retries;
    }
    INFO_DBG(prog->dbgFlags, REG_ALLOC, "RegAlloc done: %i\n", ret);
 
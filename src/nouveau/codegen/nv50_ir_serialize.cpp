@@ -26,6 +26,7 @@ nv50_ir_prog_info_serialize(struct blob *blob, struct nv50_ir_prog_info *info)
    blob_write_uint8(blob, info->optLevel);
    blob_write_uint8(blob, info->dbgFlags);
    blob_write_uint8(blob, info->omitLineNum);
+   blob_write_uint8(blob, info->fastRA);
 
    nir_serialize(blob, info->bin.nir, true);
 
@@ -0,0 +1,232 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * AVX2 pack/unpack for the 32-bit RGBA8 UNORM family of formats, which is
+ * what ReadPixels, texstore and the software rasterizer transfers spend
+ * most of their time converting between.
+ *
+ * Every format here is one byte per channel in some order, so converting
+ * to or from RGBA8 is a single in-lane byte shuffle per eight pixels.
+ * Leftover pixels go through the generic code.
+ */
+
+#include "util/detect_arch.h"
+#include "util/format/u_format.h"
+
+#if defined(USE_AVX2) && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64)
+
+#include <immintrin.h>
+#include "u_format_pack.h"
+#include "util/u_cpu_detect.h"
+
+/* Shuffle index meaning "write zero". */
+#define Z 0x80
+
+/**
+ * Build a shuffle mask taking byte c0..c3 of each pixel to bytes 0..3 of
+ * the same pixel.
+ */
+static inline __m256i
+pixel_shuffle(unsigned c0, unsigned c1, unsigned c2, unsigned c3)
+{
+   const __m256i pixel = _mm256_set1_epi32(c0 | c1 << 8 | c2 << 16 | c3 << 24);
+   const __m256i offset = _mm256_setr_epi32(0x00000000, 0x04040404,
+                                            0x08080808, 0x0c0c0c0c,
+                                            0x00000000, 0x04040404,
+                                            0x08080808, 0x0c0c0c0c);
+
+   /* Z + offset still has the top bit set, so zeroes stay zeroes. */
+   return _mm256_add_epi8(pixel, offset);
+}
+
+static inline __m256i
+swizzle_8(const uint8_t *src, __m256i shuffle, __m256i or_mask)
+{
+   __m256i v = _mm256_loadu_si256((const __m256i *)src);
+   return _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), or_mask);
+}
+
+/**
+ * Unpack eight pixels to RGBA float.  ubyte_to_float() is a multiply by
+ * 1/255, so this is bit-exact with the generic code.
+ */
+static inline void
+rgba8_to_float_8(float *dst, __m256i rgba)
+{
+   const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+   const __m128i lo = _mm256_castsi256_si128(rgba);
+   const __m128i hi = _mm256_extracti128_si256(rgba, 1);
+   const __m128i halves[4] = {
+      lo, _mm_srli_si128(lo, 8), hi, _mm_srli_si128(hi, 8),
+   };
+
+   for (unsigned i = 0; i < 4; i++) {
+      __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(halves[i]));
+      _mm256_storeu_ps(dst + 8 * i, _mm256_mul_ps(f, scale));
+   }
+}
+
+/**
+ * Generate unpack_rgba_8unorm and unpack_rgba (float) for one format.
+ * r, g, b, a are the byte of the packed pixel each RGBA channel is stored
+ * in, or Z for an X channel.
+ */
+#define RGBA8_UNPACK(fmt, r, g, b, a)                                         \
+static void                                                                   \
+util_format_##fmt##_unpack_rgba_8unorm_avx2(uint8_t *restrict dst,            \
+                                            const uint8_t *restrict src,      \
+                                            unsigned width)                   \
+{                                                                             \
+   const __m256i shuffle = pixel_shuffle(r, g, b, a);                         \
+   const __m256i or_mask = _mm256_set1_epi32((a) == Z ? 0xff000000 : 0);      \
+                                                                              \
+   while (width >= 8) {                                                       \
+      _mm256_storeu_si256((__m256i *)dst, swizzle_8(src, shuffle, or_mask));  \
+      width -= 8;                                                             \
+      dst += 8 * 4;                                                           \
+      src += 8 * 4;                                                           \
+   }                                                                          \
+   if (width)                                                                 \
+      util_format_##fmt##_unpack_rgba_8unorm(dst, src, width);                \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+util_format_##fmt##_unpack_rgba_float_avx2(void *restrict dst_row,            \
+                                           const uint8_t *restrict src,       \
+                                           unsigned width)                    \
+{                                                                             \
+   const __m256i shuffle = pixel_shuffle(r, g, b, a);                         \
+   const __m256i or_mask = _mm256_set1_epi32((a) == Z ? 0xff000000 : 0);      \
+   float *dst = dst_row;                                                      \
+                                                                              \
+   while (width >= 8) {                                                       \
+      rgba8_to_float_8(dst, swizzle_8(src, shuffle, or_mask));                \
+      width -= 8;                                                             \
+      dst += 8 * 4;                                                           \
+      src += 8 * 4;                                                           \
+   }                                                                          \
+   if (width)                                                                 \
+      util_format_##fmt##_unpack_rgba_float(dst, src, width);                 \
+}
+
+/**
+ * Generate pack_rgba_8unorm for one format.  p0..p3 are the RGBA channel
+ * each byte of the packed pixel comes from, or Z for an X byte.
+ */
+#define RGBA8_PACK(fmt, p0, p1, p2, p3)                                       \
+static void                                                                   \
+util_format_##fmt##_pack_rgba_8unorm_avx2(uint8_t *restrict dst_row,          \
+                                          unsigned dst_stride,                \
+                                          const uint8_t *restrict src_row,    \
+                                          unsigned src_stride,                \
+                                          unsigned width, unsigned height)    \
+{                                                                             \
+   const __m256i shuffle = pixel_shuffle(p0, p1, p2, p3);                     \
+   const __m256i zero = _mm256_setzero_si256();                               \
+                                                                              \
+   for (unsigned y = 0; y < height; y++) {                                    \
+      const uint8_t *src = src_row;                                           \
+      uint8_t *dst = dst_row;                                                 \
+      unsigned x = 0;                                                         \
+                                                                              \
+      for (; x + 8 <= width; x += 8) {                                        \
+         _mm256_storeu_si256((__m256i *)dst, swizzle_8(src, shuffle, zero));  \
+         dst += 8 * 4;                                                        \
+         src += 8 * 4;                                                        \
+      }                                                                       \
+      if (x < width) {                                                        \
+         util_format_##fmt##_pack_rgba_8unorm(dst, 0, src, 0, width - x, 1);  \
+      }                                                                       \
+                                                                              \
+      dst_row += dst_stride;                                                  \
+      src_row += src_stride;                                                  \
+   }                                                                          \
+}
+
+RGBA8_UNPACK(r8g8b8a8_unorm, 0, 1, 2, 3)
+RGBA8_UNPACK(b8g8r8a8_unorm, 2, 1, 0, 3)
+RGBA8_UNPACK(a8r8g8b8_unorm, 1, 2, 3, 0)
+RGBA8_UNPACK(a8b8g8r8_unorm, 3, 2, 1, 0)
+RGBA8_UNPACK(r8g8b8x8_unorm, 0, 1, 2, Z)
+RGBA8_UNPACK(b8g8r8x8_unorm, 2, 1, 0, Z)
+RGBA8_UNPACK(x8r8g8b8_unorm, 1, 2, 3, Z)
+RGBA8_UNPACK(x8b8g8r8_unorm, 3, 2, 1, Z)
+
+/* R8G8B8A8 packing is a plain copy, which the generic code already does
+ * with memcpy.
+ */
+RGBA8_PACK(b8g8r8a8_unorm, 2, 1, 0, 3)
+RGBA8_PACK(a8r8g8b8_unorm, 3, 0, 1, 2)
+RGBA8_PACK(a8b8g8r8_unorm, 3, 2, 1, 0)
+RGBA8_PACK(r8g8b8x8_unorm, 0, 1, 2, Z)
+RGBA8_PACK(b8g8r8x8_unorm, 2, 1, 0, Z)
+RGBA8_PACK(x8r8g8b8_unorm, Z, 0, 1, 2)
+RGBA8_PACK(x8b8g8r8_unorm, Z, 2, 1, 0)
+
+#define UNPACK_ENTRY(FMT, fmt)                                                \
+   [PIPE_FORMAT_##FMT] = {                                                    \
+      .unpack_rgba_8unorm = &util_format_##fmt##_unpack_rgba_8unorm_avx2,     \
+      .unpack_rgba = &util_format_##fmt##_unpack_rgba_float_avx2,             \
+   }
+
+#define PACK_ENTRY(FMT, fmt)                                                  \
+   [PIPE_FORMAT_##FMT] = {                                                    \
+      .pack_rgba_8unorm = &util_format_##fmt##_pack_rgba_8unorm_avx2,         \
+      .pack_rgba_float = &util_format_##fmt##_pack_rgba_float,                \
+   }
+
+static const struct util_format_unpack_description util_format_unpack_descriptions_avx2[] = {
+   UNPACK_ENTRY(R8G8B8A8_UNORM, r8g8b8a8_unorm),
+   UNPACK_ENTRY(B8G8R8A8_UNORM, b8g8r8a8_unorm),
+   UNPACK_ENTRY(A8R8G8B8_UNORM, a8r8g8b8_unorm),
+   UNPACK_ENTRY(A8B8G8R8_UNORM, a8b8g8r8_unorm),
+   UNPACK_ENTRY(R8G8B8X8_UNORM, r8g8b8x8_unorm),
+   UNPACK_ENTRY(B8G8R8X8_UNORM, b8g8r8x8_unorm),
+   UNPACK_ENTRY(X8R8G8B8_UNORM, x8r8g8b8_unorm),
+   UNPACK_ENTRY(X8B8G8R8_UNORM, x8b8g8r8_unorm),
+};
+
+static const struct util_format_pack_description util_format_pack_descriptions_avx2[] = {
+   PACK_ENTRY(B8G8R8A8_UNORM, b8g8r8a8_unorm),
+   PACK_ENTRY(A8R8G8B8_UNORM, a8r8g8b8_unorm),
+   PACK_ENTRY(A8B8G8R8_UNORM, a8b8g8r8_unorm),
+   PACK_ENTRY(R8G8B8X8_UNORM, r8g8b8x8_unorm),
+   PACK_ENTRY(B8G8R8X8_UNORM, b8g8r8x8_unorm),
+   PACK_ENTRY(X8R8G8B8_UNORM, x8r8g8b8_unorm),
+   PACK_ENTRY(X8B8G8R8_UNORM, x8b8g8r8_unorm),
+};
+
+const struct util_format_unpack_description *
+util_format_unpack_description_avx2(enum pipe_format format)
+{
+   if (!util_get_cpu_caps()->has_avx2)
+      return NULL;
+
+   if (format >= ARRAY_SIZE(util_format_unpack_descriptions_avx2))
+      return NULL;
+
+   if (!util_format_unpack_descriptions_avx2[format].unpack_rgba)
+      return NULL;
+
+   return &util_format_unpack_descriptions_avx2[format];
+}
+
+const struct util_format_pack_description *
+util_format_pack_description_avx2(enum pipe_format format)
+{
+   if (!util_get_cpu_caps()->has_avx2)
+      return NULL;
+
+   if (format >= ARRAY_SIZE(util_format_pack_descriptions_avx2))
+      return NULL;
+
+   if (!util_format_pack_descriptions_avx2[format].pack_rgba_8unorm)
+      return NULL;
+
+   return &util_format_pack_descriptions_avx2[format];
+}
+
+#endif /* USE_AVX2 && (DETECT_ARCH_X86 || DETECT_ARCH_X86_64) */
@@ -34,14 +34,18 @@ util_format_etc1_rgb8_unpack_rgba_float(void *restrict dst_row, unsigned dst_str
    for (y = 0; y < height; y += bh) {
       const uint8_t *src = src_row;
 
+      const unsigned h = MIN2(height - y, bh);
+
       for (x = 0; x < width; x+= bw) {
+         const unsigned w = MIN2(width - x, bw);
+
          etc1_parse_block(&block, src);
 
-         for (j = 0; j < bh; j++) {
+         for (j = 0; j < h; j++) {
             float *dst = (float *)((uint8_t *)dst_row + (y + j) * dst_stride + x * comps * 4);
             uint8_t tmp[3];
 
-            for (i = 0; i < bw; i++) {
+            for (i = 0; i < w; i++) {
                etc1_fetch_texel(&block, i, j, tmp);
                dst[0] = ubyte_to_float(tmp[0]);
                dst[1] = ubyte_to_float(tmp[1]);
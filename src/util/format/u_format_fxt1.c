@@ -1555,9 +1555,11 @@ util_format_fxtn_rgb_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst_
    unsigned x, y, i, j;
    for (y = 0; y < height; y += bh) {
       const uint8_t *src = src_row;
+      const unsigned h = MIN2(height - y, bh);
       for (x = 0; x < width; x += bw) {
-         for (j = 0; j < bh; ++j) {
-            for (i = 0; i < bw; ++i) {
+         const unsigned w = MIN2(width - x, bw);
+         for (j = 0; j < h; ++j) {
+            for (i = 0; i < w; ++i) {
                uint8_t *dst = dst_row + (y + j) * dst_stride / sizeof(*dst_row) + (x + i) * comps;
                fxt1_decode_1(src, 0, i, j, dst);
                if (!rgba)
@@ -1600,11 +1602,13 @@ util_format_fxtn_rgb_unpack_rgba_float(float *dst_row, unsigned dst_stride,
 {
    const unsigned bw = 8, bh = 4, comps = 4;
    unsigned x, y, i, j;
-   for (y = 0; y < height; y += 4) {
+   for (y = 0; y < height; y += bh) {
       const uint8_t *src = src_row;
-      for (x = 0; x < width; x += 8) {
-         for (j = 0; j < bh; ++j) {
-            for (i = 0; i < bw; ++i) {
+      const unsigned h = MIN2(height - y, bh);
+      for (x = 0; x < width; x += bw) {
+         const unsigned w = MIN2(width - x, bw);
+         for (j = 0; j < h; ++j) {
+            for (i = 0; i < w; ++i) {
                float *dst = dst_row + (y + j)*dst_stride/sizeof(*dst_row) + (x + i) * comps;
                uint8_t tmp[4];
                fxt1_decode_1(src, 0, i, j, tmp);
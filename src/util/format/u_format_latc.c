@@ -63,9 +63,11 @@ util_format_latc1_unorm_unpack_rgba_float(void *restrict dst_row, unsigned dst_s
 
    for(y = 0; y < height; y += 4) {
       const uint8_t *src = src_row;
+      const unsigned h = MIN2(height - y, 4);
       for(x = 0; x < width; x += 4) {
-         for(j = 0; j < 4; ++j) {
-            for(i = 0; i < 4; ++i) {
+         const unsigned w = MIN2(width - x, 4);
+         for(j = 0; j < h; ++j) {
+            for(i = 0; i < w; ++i) {
                float *dst = (float *)((uint8_t *)dst_row + (y + j)*dst_stride + (x + i)*16);
                uint8_t tmp_r;
                util_format_unsigned_fetch_texel_rgtc(0, src, i, j, &tmp_r, 1);
@@ -137,9 +139,11 @@ util_format_latc1_snorm_unpack_rgba_float(void *restrict dst_row, unsigned dst_s
 
    for(y = 0; y < height; y += 4) {
       const int8_t *src = (int8_t *)src_row;
+      const unsigned h = MIN2(height - y, 4);
       for(x = 0; x < width; x += 4) {
-         for(j = 0; j < 4; ++j) {
-            for(i = 0; i < 4; ++i) {
+         const unsigned w = MIN2(width - x, 4);
+         for(j = 0; j < h; ++j) {
+            for(i = 0; i < w; ++i) {
                float *dst = (float *)((uint8_t *)dst_row + (y + j)*dst_stride + (x + i)*16);
                int8_t tmp_r;
                util_format_signed_fetch_texel_rgtc(0, src, i, j, &tmp_r, 1);
@@ -204,9 +208,11 @@ util_format_latc2_unorm_unpack_rgba_float(void *restrict dst_row, unsigned dst_s
 
    for(y = 0; y < height; y += 4) {
       const uint8_t *src = src_row;
+      const unsigned h = MIN2(height - y, 4);
       for(x = 0; x < width; x += 4) {
-         for(j = 0; j < 4; ++j) {
-            for(i = 0; i < 4; ++i) {
+         const unsigned w = MIN2(width - x, 4);
+         for(j = 0; j < h; ++j) {
+            for(i = 0; i < w; ++i) {
                float *dst = (float *)((uint8_t *)dst_row + (y + j)*dst_stride + (x + i)*16);
                uint8_t tmp_r, tmp_g;
                util_format_unsigned_fetch_texel_rgtc(0, src, i, j, &tmp_r, 2);
@@ -269,10 +275,12 @@ util_format_latc2_snorm_unpack_rgba_float(void *restrict dst_row, unsigned dst_s
 
    for(y = 0; y < height; y += 4) {
       const int8_t *src = (int8_t *)src_row;
+      const unsigned h = MIN2(height - y, 4);
       for(x = 0; x < width; x += 4) {
-         for(j = 0; j < 4; ++j) {
-            for(i = 0; i < 4; ++i) {
-               float *dst = (float *)(uint8_t *)dst_row + (y + j)*dst_stride + (x + i)*16;
+         const unsigned w = MIN2(width - x, 4);
+         for(j = 0; j < h; ++j) {
+            for(i = 0; i < w; ++i) {
+               float *dst = (float *)((uint8_t *)dst_row + (y + j)*dst_stride + (x + i)*16);
                int8_t tmp_r, tmp_g;
                util_format_signed_fetch_texel_rgtc(0, src, i, j, &tmp_r, 2);
                util_format_signed_fetch_texel_rgtc(0, src + 8, i, j, &tmp_g, 2);
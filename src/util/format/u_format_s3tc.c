@@ -205,12 +205,15 @@ util_format_dxtn_rgb_unpack_rgba_float(float *restrict dst_row, unsigned dst_str
                                        util_format_dxtn_fetch_t fetch,
                                        unsigned block_size, bool srgb)
 {
+   const unsigned bw = 4, bh = 4;
    unsigned x, y, i, j;
-   for(y = 0; y < height; y += 4) {
+   for(y = 0; y < height; y += bh) {
       const uint8_t *src = src_row;
-      for(x = 0; x < width; x += 4) {
-         for(j = 0; j < 4; ++j) {
-            for(i = 0; i < 4; ++i) {
+      const unsigned h = MIN2(height - y, bh);
+      for(x = 0; x < width; x += bw) {
+         const unsigned w = MIN2(width - x, bw);
+         for(j = 0; j < h; ++j) {
+            for(i = 0; i < w; ++i) {
                float *dst = dst_row + (y + j)*dst_stride/sizeof(*dst_row) + (x + i)*4;
                uint8_t tmp[4];
                fetch(0, src, i, j, tmp);
@@ -512,6 +512,13 @@ void gc_sweep_start(gc_ctx *ctx);
 void gc_mark_live(gc_ctx *ctx, const void *mem);
 void gc_sweep_end(gc_ctx *ctx);
 
+/**
+ * Move all allocations of \p old_ctx to \p new_ctx, leaving \p old_ctx
+ * empty.  This lets allocations be made from a private context, e.g. on
+ * another thread, and merged later.  Must not be called during a sweep.
+ */
+void gc_adopt(gc_ctx *new_ctx, gc_ctx *old_ctx);
+
 /**
  * Declare C++ new and delete operators which use ralloc.
  *
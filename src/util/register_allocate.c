@@ -472,40 +472,60 @@ ra_set_deserialize(void *mem_ctx, struct blob_reader *blob)
    return regs;
 }
 
-static uint64_t
-ra_get_num_adjacency_bits(uint64_t n)
+static unsigned
+ra_get_num_adjacency_tiles(unsigned n)
 {
-   return (n * (n - 1)) / 2;
+   unsigned rows = DIV_ROUND_UP(n, RA_ADJACENCY_TILE_SIZE);
+   return (rows * (rows + 1)) / 2;
 }
 
-static uint64_t
-ra_get_adjacency_bit_index(unsigned n1, unsigned n2)
+/**
+ * Returns the slot of the tile holding the adjacency bit for (n1, n2) and
+ * the index of the bit inside of that tile.
+ */
+static BITSET_WORD **
+ra_get_adjacency_tile(struct ra_graph *g, unsigned n1, unsigned n2,
+                      unsigned *bit)
 {
    assert(n1 != n2);
    unsigned k1 = MAX2(n1, n2);
    unsigned k2 = MIN2(n1, n2);
-   return ra_get_num_adjacency_bits(k1) + k2;
+   unsigned t1 = k1 / RA_ADJACENCY_TILE_SIZE;
+   unsigned t2 = k2 / RA_ADJACENCY_TILE_SIZE;
+
+   *bit = (k1 % RA_ADJACENCY_TILE_SIZE) * RA_ADJACENCY_TILE_SIZE +
+          k2 % RA_ADJACENCY_TILE_SIZE;
+   return &g->adjacency_tiles[(t1 * (t1 + 1)) / 2 + t2];
 }
 
 static bool
 ra_test_adjacency_bit(struct ra_graph *g, unsigned n1, unsigned n2)
 {
-   uint64_t index = ra_get_adjacency_bit_index(n1, n2);
-   return BITSET_TEST(g->adjacency, index);
+   unsigned bit;
+   BITSET_WORD *tile = *ra_get_adjacency_tile(g, n1, n2, &bit);
+   return tile && BITSET_TEST(tile, bit);
 }
 
 static void
 ra_set_adjacency_bit(struct ra_graph *g, unsigned n1, unsigned n2)
 {
-   unsigned index = ra_get_adjacency_bit_index(n1, n2);
-   BITSET_SET(g->adjacency, index);
+   unsigned bit;
+   BITSET_WORD **tile = ra_get_adjacency_tile(g, n1, n2, &bit);
+   if (!*tile) {
+      *tile = rzalloc_array(g, BITSET_WORD,
+                            BITSET_WORDS(RA_ADJACENCY_TILE_SIZE *
+                                         RA_ADJACENCY_TILE_SIZE));
+   }
+   BITSET_SET(*tile, bit);
 }
 
 static void
 ra_clear_adjacency_bit(struct ra_graph *g, unsigned n1, unsigned n2)
 {
-   unsigned index = ra_get_adjacency_bit_index(n1, n2);
-   BITSET_CLEAR(g->adjacency, index);
+   unsigned bit;
+   BITSET_WORD *tile = *ra_get_adjacency_tile(g, n1, n2, &bit);
+   if (tile)
+      BITSET_CLEAR(tile, bit);
 }
 
 static void
@@ -546,9 +566,13 @@ ra_realloc_interference_graph(struct ra_graph *g, unsigned int alloc)
    assert(g->alloc % BITSET_WORDBITS == 0);
    alloc = align(alloc, BITSET_WORDBITS);
    g->nodes = rerzalloc(g, g->nodes, struct ra_node, g->alloc, alloc);
-   g->adjacency = rerzalloc(g, g->adjacency, BITSET_WORD,
-                            BITSET_WORDS(ra_get_num_adjacency_bits(g->alloc)),
-                            BITSET_WORDS(ra_get_num_adjacency_bits(alloc)));
+
+   /* The tile index of a pair of nodes doesn't depend on the size of the
+    * graph, so growing it only needs room for the new tile slots.
+    */
+   g->adjacency_tiles = rerzalloc(g, g->adjacency_tiles, BITSET_WORD *,
+                                  ra_get_num_adjacency_tiles(g->alloc),
+                                  ra_get_num_adjacency_tiles(alloc));
 
    /* Initialize new nodes. */
    for (unsigned i = g->alloc; i < alloc; i++) {
@@ -124,13 +124,26 @@ struct ra_node {
    } tmp;
 };
 
+/**
+ * Width, in nodes, of the square tiles the adjacency matrix is split into.
+ */
+#define RA_ADJACENCY_TILE_SIZE 128
+
 struct ra_graph {
    struct ra_regs *regs;
    /**
     * the variables that need register allocation.
     */
    struct ra_node *nodes;
-   BITSET_WORD *adjacency;
+
+   /**
+    * Lower triangle of the adjacency matrix as RA_ADJACENCY_TILE_SIZE²-bit
+    * tiles, indexed by row tile first.  A tile is only allocated once one
+    * of its bits gets set.  Most interference is between nodes with nearby
+    * indices, so big graphs only use the tiles close to the diagonal
+    * instead of a bit for every pair of nodes.
+    */
+   BITSET_WORD **adjacency_tiles;
    unsigned int count; /**< count of nodes. */
 
    unsigned int alloc; /**< count of nodes allocated. */
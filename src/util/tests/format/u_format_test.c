@@ -28,9 +28,11 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <float.h>
 
 #include "util/half_float.h"
+#include "util/os_time.h"
 #include "util/u_math.h"
 #include "util/format/u_format.h"
 #include "util/format/u_format_tests.h"
@@ -865,11 +867,214 @@ test_all(void)
 }
 
 
+#define OPTIMIZED_TEST_WIDTH  67   /* odd, to cover the scalar tails */
+#define OPTIMIZED_BENCH_WIDTH 4096
+#define OPTIMIZED_BENCH_RUNS  2000
+
+static double
+bench_mbps(int64_t ns)
+{
+   return (double)OPTIMIZED_BENCH_WIDTH * 4 * OPTIMIZED_BENCH_RUNS * 1000.0 /
+          MAX2(ns, 1);
+}
+
+/**
+ * Compare the CPU-specific pack/unpack paths picked by
+ * util_format_(un)pack_description() with the generated code on rows long
+ * enough to go through their vector loops.  With U_FORMAT_TEST_BENCH=1,
+ * also report the throughput of both.
+ */
+static bool
+test_optimized_paths(void)
+{
+   static uint8_t packed[OPTIMIZED_BENCH_WIDTH * 4];
+   static uint8_t rgba8[2][OPTIMIZED_BENCH_WIDTH * 4];
+   static float rgbaf[2][OPTIMIZED_TEST_WIDTH * 4];
+   const bool bench = debug_get_bool_option("U_FORMAT_TEST_BENCH", false);
+   bool success = true;
+
+   for (unsigned i = 0; i < sizeof(packed); i++)
+      packed[i] = rand();
+
+   for (enum pipe_format format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_unpack_description *unpack =
+         util_format_unpack_description(format);
+      const struct util_format_unpack_description *unpack_generic =
+         util_format_unpack_description_generic(format);
+      const struct util_format_pack_description *pack =
+         util_format_pack_description(format);
+      const struct util_format_pack_description *pack_generic =
+         util_format_pack_description_generic(format);
+      const char *name = util_format_short_name(format);
+
+      if (unpack != unpack_generic && unpack->unpack_rgba_8unorm) {
+         unpack->unpack_rgba_8unorm(rgba8[0], packed, OPTIMIZED_TEST_WIDTH);
+         unpack_generic->unpack_rgba_8unorm(rgba8[1], packed,
+                                            OPTIMIZED_TEST_WIDTH);
+         unpack->unpack_rgba(rgbaf[0], packed, OPTIMIZED_TEST_WIDTH);
+         unpack_generic->unpack_rgba(rgbaf[1], packed, OPTIMIZED_TEST_WIDTH);
+
+         if (memcmp(rgba8[0], rgba8[1], OPTIMIZED_TEST_WIDTH * 4) ||
+             memcmp(rgbaf[0], rgbaf[1], sizeof(rgbaf[0]))) {
+            fprintf(stderr, "util_format_%s optimized unpack differs from "
+                    "generic\n", name);
+            success = false;
+         }
+
+         if (bench) {
+            int64_t start = os_time_get_nano();
+            for (unsigned i = 0; i < OPTIMIZED_BENCH_RUNS; i++)
+               unpack_generic->unpack_rgba_8unorm(rgba8[1], packed,
+                                                  OPTIMIZED_BENCH_WIDTH);
+            int64_t generic_ns = os_time_get_nano() - start;
+
+            start = os_time_get_nano();
+            for (unsigned i = 0; i < OPTIMIZED_BENCH_RUNS; i++)
+               unpack->unpack_rgba_8unorm(rgba8[0], packed,
+                                          OPTIMIZED_BENCH_WIDTH);
+            int64_t optimized_ns = os_time_get_nano() - start;
+
+            printf("util_format_%s_unpack_rgba_8unorm: generic %.0f MB/s, "
+                   "optimized %.0f MB/s\n", name,
+                   bench_mbps(generic_ns), bench_mbps(optimized_ns));
+         }
+      }
+
+      if (pack != pack_generic && pack->pack_rgba_8unorm) {
+         uint8_t out[2][OPTIMIZED_TEST_WIDTH * 4];
+
+         pack->pack_rgba_8unorm(out[0], 0, packed, 0,
+                                OPTIMIZED_TEST_WIDTH, 1);
+         pack_generic->pack_rgba_8unorm(out[1], 0, packed, 0,
+                                        OPTIMIZED_TEST_WIDTH, 1);
+
+         if (memcmp(out[0], out[1], sizeof(out[0]))) {
+            fprintf(stderr, "util_format_%s optimized pack differs from "
+                    "generic\n", name);
+            success = false;
+         }
+
+         if (bench) {
+            int64_t start = os_time_get_nano();
+            for (unsigned i = 0; i < OPTIMIZED_BENCH_RUNS; i++)
+               pack_generic->pack_rgba_8unorm(rgba8[1], 0, packed, 0,
+                                              OPTIMIZED_BENCH_WIDTH, 1);
+            int64_t generic_ns = os_time_get_nano() - start;
+
+            start = os_time_get_nano();
+            for (unsigned i = 0; i < OPTIMIZED_BENCH_RUNS; i++)
+               pack->pack_rgba_8unorm(rgba8[0], 0, packed, 0,
+                                      OPTIMIZED_BENCH_WIDTH, 1);
+            int64_t optimized_ns = os_time_get_nano() - start;
+
+            printf("util_format_%s_pack_rgba_8unorm: generic %.0f MB/s, "
+                   "optimized %.0f MB/s\n", name,
+                   bench_mbps(generic_ns), bench_mbps(optimized_ns));
+         }
+      }
+   }
+
+   return success;
+}
+
+
+#define ROWS_TEST_WIDTH  37   /* not a multiple of any block width */
+#define ROWS_TEST_HEIGHT 29   /* nor of any block height */
+
+/**
+ * Check that unpacking an image one band of block rows at a time, in
+ * reverse order, gives the same result as unpacking it all at once.  The
+ * last band is partial, so this covers the decoders' clipping of blocks
+ * at the bottom edge.
+ */
+static bool
+test_unpack_bands(void)
+{
+   static uint8_t packed[ROWS_TEST_HEIGHT * ROWS_TEST_WIDTH *
+                         UTIL_FORMAT_MAX_PACKED_BYTES];
+   static float rgba[2][ROWS_TEST_HEIGHT][ROWS_TEST_WIDTH * 4];
+   static uint8_t rgba8[2][ROWS_TEST_HEIGHT][ROWS_TEST_WIDTH * 4];
+   bool success = true;
+
+   for (unsigned i = 0; i < sizeof(packed); i++)
+      packed[i] = rand();
+
+   for (enum pipe_format format = 1; format < PIPE_FORMAT_COUNT; ++format) {
+      const struct util_format_unpack_description *unpack =
+         util_format_unpack_description(format);
+      const unsigned bh = util_format_get_blockheight(format);
+      const unsigned src_stride =
+         util_format_get_stride(format, ROWS_TEST_WIDTH);
+
+      if (!unpack || bh > ROWS_TEST_HEIGHT)
+         continue;
+
+      assert(src_stride * util_format_get_nblocksy(format, ROWS_TEST_HEIGHT) <=
+             sizeof(packed));
+
+      for (unsigned band_rows = 1; band_rows <= 2; band_rows++) {
+         const unsigned band = band_rows * bh;
+         const unsigned last = (ROWS_TEST_HEIGHT - 1) / band * band;
+
+         if (unpack->unpack_rgba || unpack->unpack_rgba_rect) {
+            memset(rgba, 0, sizeof(rgba));
+            util_format_unpack_rgba_rect(format, rgba[0], sizeof(rgba[0][0]),
+                                         packed, src_stride,
+                                         ROWS_TEST_WIDTH, ROWS_TEST_HEIGHT);
+            for (int y = last; y >= 0; y -= band) {
+               util_format_unpack_rgba_rect(format, rgba[1][y],
+                                            sizeof(rgba[1][0]),
+                                            packed + (y / bh) * src_stride,
+                                            src_stride, ROWS_TEST_WIDTH,
+                                            MIN2(band, ROWS_TEST_HEIGHT - y));
+            }
+
+            if (memcmp(rgba[0], rgba[1], sizeof(rgba[0]))) {
+               fprintf(stderr, "util_format_%s unpack_rgba_rect in bands of %u "
+                       "block rows differs from a single call\n",
+                       util_format_short_name(format), band_rows);
+               success = false;
+            }
+         }
+
+         if (unpack->unpack_rgba_8unorm || unpack->unpack_rgba_8unorm_rect) {
+            memset(rgba8, 0, sizeof(rgba8));
+            util_format_unpack_rgba_8unorm_rect(format, rgba8[0],
+                                                sizeof(rgba8[0][0]),
+                                                packed, src_stride,
+                                                ROWS_TEST_WIDTH,
+                                                ROWS_TEST_HEIGHT);
+            for (int y = last; y >= 0; y -= band) {
+               util_format_unpack_rgba_8unorm_rect(format, rgba8[1][y],
+                                                   sizeof(rgba8[1][0]),
+                                                   packed +
+                                                   (y / bh) * src_stride,
+                                                   src_stride, ROWS_TEST_WIDTH,
+                                                   MIN2(band,
+                                                        ROWS_TEST_HEIGHT - y));
+            }
+
+            if (memcmp(rgba8[0], rgba8[1], sizeof(rgba8[0]))) {
+               fprintf(stderr, "util_format_%s unpack_rgba_8unorm_rect in "
+                       "bands of %u block rows differs from a single call\n",
+                       util_format_short_name(format), band_rows);
+               success = false;
+            }
+         }
+      }
+   }
+
+   return success;
+}
+
+
 int main(int argc, char **argv)
 {
    bool success;
 
    success = test_all();
+   success = test_optimized_paths() && success;
+   success = test_unpack_bands() && success;
 
    return success ? 0 : 1;
 }
@@ -46,3 +46,52 @@ TEST(gc_alloc, align)
       }
    }
 }
+
+TEST(gc_alloc, adopt)
+{
+   gc_ctx *ctx = gc_context(NULL);
+   gc_ctx *other = gc_context(NULL);
+
+   /* Put the contexts in different generations. */
+   gc_sweep_start(ctx);
+   gc_sweep_end(ctx);
+
+   uint32_t *small[64], *large[4];
+   for (unsigned i = 0; i < ARRAY_SIZE(small); i++) {
+      small[i] = (uint32_t *)gc_alloc_size(other, 4 * (i % 8 + 1), 4);
+      *small[i] = i;
+   }
+   for (unsigned i = 0; i < ARRAY_SIZE(large); i++) {
+      large[i] = (uint32_t *)gc_alloc_size(other, 8192, 4);
+      *large[i] = i;
+   }
+
+   gc_adopt(ctx, other);
+   ralloc_free(other);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(small); i++)
+      EXPECT_EQ(gc_get_context(small[i]), ctx);
+   for (unsigned i = 0; i < ARRAY_SIZE(large); i++)
+      EXPECT_EQ(gc_get_context(large[i]), ctx);
+
+   /* Adopted objects must survive a sweep exactly when marked live. */
+   gc_sweep_start(ctx);
+   for (unsigned i = 0; i < ARRAY_SIZE(small); i += 2)
+      gc_mark_live(ctx, small[i]);
+   for (unsigned i = 0; i < ARRAY_SIZE(large); i += 2)
+      gc_mark_live(ctx, large[i]);
+   gc_sweep_end(ctx);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(small); i += 2)
+      EXPECT_EQ(*small[i], i);
+   for (unsigned i = 0; i < ARRAY_SIZE(large); i += 2)
+      EXPECT_EQ(*large[i], i);
+
+   /* The adopted slabs are usable for new allocations and frees. */
+   for (unsigned i = 0; i < ARRAY_SIZE(small); i += 2)
+      gc_free(small[i]);
+   for (unsigned i = 0; i < ARRAY_SIZE(small); i++)
+      EXPECT_NE(gc_alloc_size(ctx, 4 * (i % 8 + 1), 4), nullptr);
+
+   ralloc_free(ctx);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2024 Mesa contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * Times building and coloring interference graphs with register_allocate.
+ *
+ * Usage: ra_bench [graph-file...]
+ *
+ * A graph file is a text dump with the node count on the first line and one
+ * "n1 n2" interference per following line.  Without arguments, synthetic
+ * graphs made of random live ranges are used, which have the same "mostly
+ * neighbours interfere" shape as the ones real backends build.
+ *
+ * Run it on both sides of a change to register_allocate.c to compare them.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "util/register_allocate.h"
+#include "util/u_dynarray.h"
+
+#define REG_COUNT 128
+
+struct edge {
+   unsigned n1, n2;
+};
+
+struct graph_desc {
+   unsigned count;
+   struct util_dynarray edges;
+};
+
+static bool
+load_graph(void *mem_ctx, const char *path, struct graph_desc *desc)
+{
+   FILE *f = fopen(path, "r");
+   if (!f)
+      return false;
+
+   util_dynarray_init(&desc->edges, mem_ctx);
+
+   bool ok = fscanf(f, "%u", &desc->count) == 1;
+   struct edge e;
+   while (ok && fscanf(f, "%u %u", &e.n1, &e.n2) == 2) {
+      if (e.n1 >= desc->count || e.n2 >= desc->count) {
+         ok = false;
+         break;
+      }
+      util_dynarray_append(&desc->edges, struct edge, e);
+   }
+
+   fclose(f);
+   return ok;
+}
+
+static void
+make_graph(void *mem_ctx, unsigned count, unsigned max_len,
+           struct graph_desc *desc)
+{
+   desc->count = count;
+   util_dynarray_init(&desc->edges, mem_ctx);
+
+   /* Nodes are defined in order, and live for a random number of "ips".
+    * Two nodes interfere when their live ranges overlap.
+    */
+   unsigned *end = ralloc_array(mem_ctx, unsigned, count);
+   for (unsigned n = 0; n < count; n++) {
+      end[n] = n + 1 + rand() % max_len;
+      for (unsigned m = n > max_len ? n - max_len : 0; m < n; m++) {
+         if (end[m] > n) {
+            struct edge e = { m, n };
+            util_dynarray_append(&desc->edges, struct edge, e);
+         }
+      }
+   }
+}
+
+static void
+run(struct ra_regs *regs, struct ra_class *c, const char *name,
+    const struct graph_desc *desc)
+{
+   int64_t start = os_time_get_nano();
+
+   struct ra_graph *g = ra_alloc_interference_graph(regs, desc->count);
+   for (unsigned n = 0; n < desc->count; n++)
+      ra_set_node_class(g, n, c);
+   util_dynarray_foreach(&desc->edges, struct edge, e)
+      ra_add_node_interference(g, e->n1, e->n2);
+
+   int64_t built = os_time_get_nano();
+   bool allocated = ra_allocate(g);
+   int64_t done = os_time_get_nano();
+
+   printf("%-24s %8u nodes %10u edges  build %8.3f ms  allocate %8.3f ms%s\n",
+          name, desc->count,
+          (unsigned) util_dynarray_num_elements(&desc->edges, struct edge),
+          (built - start) / 1000000.0, (done - built) / 1000000.0,
+          allocated ? "" : "  (failed)");
+
+   ralloc_free(g);
+}
+
+int
+main(int argc, char **argv)
+{
+   void *mem_ctx = ralloc_context(NULL);
+
+   struct ra_regs *regs = ra_alloc_reg_set(mem_ctx, REG_COUNT, true);
+   struct ra_class *c = ra_alloc_contig_reg_class(regs, 1);
+   for (unsigned r = 0; r < REG_COUNT; r++)
+      ra_class_add_reg(c, r);
+   ra_set_finalize(regs, NULL);
+
+   if (argc > 1) {
+      for (int i = 1; i < argc; i++) {
+         struct graph_desc desc;
+         if (!load_graph(mem_ctx, argv[i], &desc)) {
+            fprintf(stderr, "failed to load %s\n", argv[i]);
+            ralloc_free(mem_ctx);
+            return 1;
+         }
+         run(regs, c, argv[i], &desc);
+      }
+   } else {
+      static const unsigned sizes[] = { 1000, 5000, 20000, 50000 };
+
+      srand(0);
+      for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++) {
+         char name[32];
+         struct graph_desc desc;
+
+         make_graph(mem_ctx, sizes[i], 64, &desc);
+         snprintf(name, sizeof(name), "synthetic-%u", sizes[i]);
+         run(regs, c, name, &desc);
+      }
+   }
+
+   ralloc_free(mem_ctx);
+   return 0;
+}
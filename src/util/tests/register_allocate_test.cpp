@@ -279,3 +279,50 @@ TEST_F(ra_test, serialization_roundtrip)
    blob_finish(&blob);
 }
 
+
+TEST_F(ra_test, sparse_interference)
+{
+   struct ra_regs *regs = ra_alloc_reg_set(mem_ctx, 4, true);
+   struct ra_class *c = ra_alloc_contig_reg_class(regs, 1);
+   for (int i = 0; i < 4; i++)
+      ra_class_add_reg(c, i);
+   ra_set_finalize(regs, NULL);
+
+   /* Spread the nodes over many adjacency tiles, and grow the graph while
+    * edges are already in it.
+    */
+   const unsigned count = 5 * RA_ADJACENCY_TILE_SIZE + 7;
+   struct ra_graph *g = ra_alloc_interference_graph(regs, 1);
+   ra_set_node_class(g, 0, c);
+   for (unsigned i = 1; i < count; i++) {
+      ASSERT_EQ(ra_add_node(g, c), i);
+      ra_add_node_interference(g, i - 1, i);
+   }
+
+   /* Far away and duplicated edges. */
+   ra_add_node_interference(g, 0, count - 1);
+   ra_add_node_interference(g, count - 1, 0);
+   ra_add_node_interference(g, 2, 1);
+
+   for (unsigned i = 1; i < count - 1; i++)
+      ASSERT_EQ(g->nodes[i].q_total, 2);
+   ASSERT_EQ(g->nodes[0].q_total, 2);
+   ASSERT_EQ(g->nodes[count - 1].q_total, 2);
+
+   ra_reset_node_interference(g, 0);
+   ASSERT_EQ(g->nodes[1].q_total, 1);
+   ASSERT_EQ(g->nodes[count - 1].q_total, 1);
+
+   /* The edges are gone from the matrix too, so adding them back counts. */
+   ra_add_node_interference(g, 0, 1);
+   ra_add_node_interference(g, 0, count - 1);
+   ASSERT_EQ(g->nodes[1].q_total, 2);
+   ASSERT_EQ(g->nodes[count - 1].q_total, 2);
+
+   ASSERT_TRUE(ra_allocate(g));
+   for (unsigned i = 1; i < count; i++)
+      ASSERT_NE(ra_get_node_reg(g, i - 1), ra_get_node_reg(g, i));
+   ASSERT_NE(ra_get_node_reg(g, 0), ra_get_node_reg(g, count - 1));
+
+   ralloc_free(g);
+}